@@ -0,0 +1,851 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <condition_variable>
+
+#include <nlohmann/json.hpp>
+
+#include <rt/Logger.h>
+
+#include <sdr/SignalBuffer.h>
+#include <sdr/RecordDevice.h>
+#include <sdr/SharedDevice.h>
+#include <sdr/SyntheticDevice.h>
+
+#include <nfc/Nfc.h>
+#include <nfc/NfcFrame.h>
+#include <nfc/NfcDecoder.h>
+#include <nfc/NfcCheckpoint.h>
+
+using json = nlohmann::json;
+
+using namespace rt;
+
+Logger root("main");
+
+// samples decoded on each step, per channel
+#define DECODE_BUFFER_SIZE 65536
+
+// samples converted on each raw file read
+#define RAW_BLOCK_SIZE 4096
+
+enum OutputFormat
+{
+   TextFormat = 0,
+   JsonFormat = 1
+};
+
+enum RawFormat
+{
+   RawNone = 0,
+   RawInt8 = 1,
+   RawInt16 = 2,
+   RawFloat32 = 3
+};
+
+struct Options
+{
+   std::vector<std::string> inputs;
+   std::string output;
+   int format = TextFormat;
+   int jobs = 0;
+   bool carrier = false;
+   bool stats = false;
+   json config = json::object();
+   int rawFormat = RawNone;
+   long sampleRate = 10000000;
+   int channels = 2;
+   double start = 0;
+   double checkpoint = 0;
+};
+
+/*
+ * Decoding job for one input, formatted output is handed to main thread in chunks so inputs are written in order
+ */
+struct Job
+{
+   std::string input;
+
+   // formatted frames pending to write and completion flag, guarded by lock
+   std::string pending;
+   bool done = false;
+
+   // decoding statistics
+   long long samples = 0;
+   long long frames = 0;
+   long sampleRate = 0;
+   double elapsed = 0;
+   std::string error;
+};
+
+// guards job output and completion
+std::mutex jobsLock;
+std::condition_variable jobsChanged;
+
+/*
+ * Sample input, record files (WAV / IQZ), synthetic devices, shared memory rings and raw interleaved sample files
+ */
+struct Input
+{
+   std::shared_ptr<sdr::SignalDevice> device;
+   std::ifstream raw;
+   int rawFormat = RawNone;
+   unsigned int channels = 1;
+   long sampleRate = 0;
+   long long sampleOffset = 0;
+
+   bool open(const std::string &name, const Options &options, std::string &error)
+   {
+      if (name.rfind("synthetic://", 0) == 0)
+      {
+         auto synthetic = std::make_shared<sdr::SyntheticDevice>(name);
+
+         synthetic->setSampleRate(options.sampleRate);
+
+         device = synthetic;
+         channels = 2;
+      }
+      else if (name.rfind("shm://", 0) == 0)
+      {
+         device = std::make_shared<sdr::SharedDevice>(name);
+      }
+      else if ((rawFormat = options.rawFormat != RawNone ? options.rawFormat : rawExtension(name)) != RawNone)
+      {
+         raw.open(name, std::ios::in | std::ios::binary);
+
+         if (!raw.is_open())
+         {
+            error = "unable to open raw file";
+            return false;
+         }
+
+         channels = options.channels;
+         sampleRate = options.sampleRate;
+
+         return true;
+      }
+      else
+      {
+         device = std::make_shared<sdr::RecordDevice>(name);
+      }
+
+      if (!device->open(sdr::SignalDevice::Read))
+      {
+         error = "unable to open input";
+         return false;
+      }
+
+      if (auto record = std::dynamic_pointer_cast<sdr::RecordDevice>(device))
+         channels = record->channelCount();
+
+      if (auto shared = std::dynamic_pointer_cast<sdr::SharedDevice>(device))
+         channels = shared->channelCount();
+
+      sampleRate = device->sampleRate();
+
+      return true;
+   }
+
+   int read(sdr::SignalBuffer &buffer)
+   {
+      switch (rawFormat)
+      {
+         case RawInt8:
+            return readRaw<signed char>(buffer, 128.0f);
+
+         case RawInt16:
+            return readRaw<short>(buffer, 32768.0f);
+
+         case RawFloat32:
+            return readRaw<float>(buffer, 1.0f);
+      }
+
+      return device->read(buffer);
+   }
+
+   template<typename T>
+   int readRaw(sdr::SignalBuffer &buffer, float scale)
+   {
+      T block[RAW_BLOCK_SIZE];
+      float vector[RAW_BLOCK_SIZE];
+
+      buffer.setSampleOffset(sampleOffset);
+
+      while (buffer.available() && raw)
+      {
+         raw.read(reinterpret_cast<char *>(block), std::min(buffer.available(), (unsigned int) RAW_BLOCK_SIZE) * sizeof(T));
+
+         unsigned int samples = raw.gcount() / sizeof(T);
+
+         for (unsigned int i = 0; i < samples; i++)
+            vector[i] = float(block[i]) / scale;
+
+         buffer.put(vector, samples);
+      }
+
+      // drop incomplete trailing sample
+      buffer.flip();
+
+      unsigned int length = buffer.limit() - buffer.limit() % channels;
+
+      buffer.rewind();
+      buffer.pull(length);
+      buffer.flip();
+
+      sampleOffset += length / channels;
+
+      return buffer.limit();
+   }
+
+   static int rawExtension(const std::string &name)
+   {
+      auto ends = [&name](const char *suffix) {
+         size_t length = strlen(suffix);
+         return name.size() > length && name.compare(name.size() - length, length, suffix) == 0;
+      };
+
+      if (ends(".cs8"))
+         return RawInt8;
+
+      if (ends(".cs16"))
+         return RawInt16;
+
+      if (ends(".cf32") || ends(".cfile"))
+         return RawFloat32;
+
+      return RawNone;
+   }
+};
+
+/*
+ * Apply decoder options, same JSON accepted by FrameDecoderTask configuration
+ */
+void configDecoder(nfc::NfcDecoder &decoder, const json &config)
+{
+   // global power level threshold
+   if (config.contains("powerLevelThreshold"))
+      decoder.setPowerLevelThreshold(config["powerLevelThreshold"]);
+
+   // signal envelope kernel, by name or by value
+   if (config.contains("envelopeKernel"))
+   {
+      if (config["envelopeKernel"].is_string())
+         decoder.setEnvelopeKernel(config["envelopeKernel"].get<std::string>());
+      else
+         decoder.setEnvelopeKernel(config["envelopeKernel"].get<int>());
+   }
+
+   auto tech = [&config](const char *name, void (nfc::NfcDecoder::*enable)(bool), void (nfc::NfcDecoder::*threshold)(float, float), nfc::NfcDecoder &target) {
+
+      if (!config.contains(name))
+         return;
+
+      auto params = config[name];
+
+      float min = NAN;
+      float max = NAN;
+
+      if (params.contains("enabled"))
+         (target.*enable)(params["enabled"]);
+
+      if (params.contains("minimumModulationThreshold"))
+         min = params["minimumModulationThreshold"];
+
+      if (params.contains("maximumModulationThreshold"))
+         max = params["maximumModulationThreshold"];
+
+      (target.*threshold)(min, max);
+   };
+
+   tech("nfca", &nfc::NfcDecoder::setEnableNfcA, &nfc::NfcDecoder::setModulationThresholdNfcA, decoder);
+   tech("nfcb", &nfc::NfcDecoder::setEnableNfcB, &nfc::NfcDecoder::setModulationThresholdNfcB, decoder);
+   tech("nfcf", &nfc::NfcDecoder::setEnableNfcF, &nfc::NfcDecoder::setModulationThresholdNfcF, decoder);
+   tech("nfcv", &nfc::NfcDecoder::setEnableNfcV, &nfc::NfcDecoder::setModulationThresholdNfcV, decoder);
+}
+
+/*
+ * Check config keys and value types so misspelled or invalid flags are reported instead of ignored or thrown
+ */
+bool checkConfig(const json &config, std::string &error)
+{
+   auto invalid = [&error](const std::string &name, const char *expected) {
+      error = "invalid value for decoder option " + name + ", " + expected + " expected";
+      return false;
+   };
+
+   if (!config.is_object())
+   {
+      error = "decoder options must be a JSON object";
+      return false;
+   }
+
+   for (const auto &entry : config.items())
+   {
+      const json &value = entry.value();
+
+      if (entry.key() == "powerLevelThreshold")
+      {
+         if (!value.is_number())
+            return invalid(entry.key(), "number");
+
+         continue;
+      }
+
+      if (entry.key() == "envelopeKernel")
+      {
+         bool named = value.is_string() && (value == "exact" || value == "alphaMaxBetaMin");
+         bool numbered = value.is_number_integer() && (value == nfc::NfcDecoder::Exact || value == nfc::NfcDecoder::AlphaMaxBetaMin);
+
+         if (!named && !numbered)
+            return invalid(entry.key(), "exact or alphaMaxBetaMin");
+
+         continue;
+      }
+
+      if (entry.key() == "nfca" || entry.key() == "nfcb" || entry.key() == "nfcf" || entry.key() == "nfcv")
+      {
+         if (entry.value().is_object())
+         {
+            for (const auto &param : entry.value().items())
+            {
+               std::string name = entry.key() + "." + param.key();
+
+               if (param.key() == "enabled")
+               {
+                  if (!param.value().is_boolean())
+                     return invalid(name, "true or false");
+               }
+               else if (param.key() == "minimumModulationThreshold" || param.key() == "maximumModulationThreshold")
+               {
+                  if (!param.value().is_number())
+                     return invalid(name, "number");
+               }
+               else
+               {
+                  error = "unknown decoder option " + name;
+                  return false;
+               }
+            }
+
+            continue;
+         }
+      }
+
+      error = "unknown decoder option " + entry.key();
+      return false;
+   }
+
+   return true;
+}
+
+/*
+ * Compact text line: time start, time end, tech, direction, rate, flags and frame data
+ */
+void formatText(std::string &output, const nfc::NfcFrame &frame)
+{
+   static const char *techs[] = {"--", "A", "B", "F", "V"};
+
+   char buffer[1024];
+
+   int length;
+
+   if (frame.techType() == nfc::TechType::None)
+   {
+      length = snprintf(buffer, sizeof(buffer), "%.6f %.6f %s\n", frame.timeStart(), frame.timeEnd(), frame.isNoCarrier() ? "OFF" : "ON");
+   }
+   else
+   {
+      length = snprintf(buffer, sizeof(buffer), "%.6f %.6f %s %s %u %02x ", frame.timeStart(), frame.timeEnd(), techs[frame.techType() <= nfc::TechType::NfcV ? frame.techType() : 0], frame.isPollFrame() ? "TX" : "RX", (unsigned int) std::round(frame.frameRate() / 1000.0), frame.frameFlags());
+   }
+
+   output.append(buffer, length);
+
+   if (frame.techType() != nfc::TechType::None)
+   {
+      static const char hex[] = "0123456789abcdef";
+
+      for (unsigned int i = 0; i < frame.limit(); i++)
+      {
+         output.push_back(hex[frame[i] >> 4]);
+         output.push_back(hex[frame[i] & 15]);
+      }
+
+      output.push_back('\n');
+   }
+}
+
+/*
+ * One JSON object per line, same fields used by frame storage files
+ */
+void formatJson(std::string &output, const nfc::NfcFrame &frame, const std::string &source)
+{
+   static const char hex[] = "0123456789ABCDEF";
+
+   std::string data;
+
+   for (unsigned int i = 0; i < frame.limit(); i++)
+   {
+      if (i > 0)
+         data.push_back(':');
+
+      data.push_back(hex[frame[i] >> 4]);
+      data.push_back(hex[frame[i] & 15]);
+   }
+
+   json entry({
+                    {"source",      source},
+                    {"techType",    frame.techType()},
+                    {"sampleStart", frame.sampleStart()},
+                    {"sampleEnd",   frame.sampleEnd()},
+                    {"timeStart",   frame.timeStart()},
+                    {"timeEnd",     frame.timeEnd()},
+                    {"frameType",   frame.frameType()},
+                    {"frameRate",   frame.frameRate()},
+                    {"frameFlags",  frame.frameFlags()},
+                    {"framePhase",  frame.framePhase()},
+                    {"frameData",   data}
+              });
+
+   output.append(entry.dump());
+   output.push_back('\n');
+}
+
+/*
+ * Decode one input as fast as possible, formatted frames are published after each buffer
+ */
+void decodeInput(Job &job, const Options &options)
+{
+   Input input;
+   nfc::NfcDecoder decoder;
+
+   configDecoder(decoder, options.config);
+
+   if (!input.open(job.input, options, job.error))
+   {
+      std::lock_guard<std::mutex> guard(jobsLock);
+      job.done = true;
+      jobsChanged.notify_all();
+      return;
+   }
+
+   job.sampleRate = input.sampleRate;
+
+   // decoder status snapshots are stored next to recordings, only seekable record files are supported
+   auto record = std::dynamic_pointer_cast<sdr::RecordDevice>(input.device);
+
+   nfc::NfcCheckpoint checkpoint(job.input + ".ckp");
+
+   // first stream sample reported, frames before it are decoded only to keep decoder in sync
+   long long startSample = std::llround(options.start * input.sampleRate);
+
+   // stream offset for next snapshot, -1 if checkpoints are not written
+   long long checkpointSample = -1;
+   long long checkpointInterval = std::llround(options.checkpoint * input.sampleRate);
+
+   if (record && startSample > 0)
+   {
+      // resume from nearest snapshot before start, or decode from beginning if there is none
+      if (checkpoint.open(nfc::NfcCheckpoint::Read))
+      {
+         long long offset = 0;
+
+         rt::ByteBuffer status = checkpoint.find(startSample, &offset);
+
+         if (status.isValid() && record->seek(offset))
+         {
+            if (decoder.loadStatus(status))
+            {
+               root.info("{}: resume decoding from sample {}", {job.input, offset});
+            }
+            else
+            {
+               record->seek(0);
+
+               decoder = nfc::NfcDecoder();
+
+               configDecoder(decoder, options.config);
+            }
+         }
+
+         checkpoint.close();
+      }
+   }
+   else if (record && checkpointInterval > 0)
+   {
+      // first full decode writes snapshots for later sessions
+      if (checkpoint.open(nfc::NfcCheckpoint::Write))
+         checkpointSample = checkpointInterval;
+      else
+         root.warn("{}: unable to write checkpoints", {job.input});
+   }
+
+   auto start = std::chrono::steady_clock::now();
+
+   std::string output;
+
+   while (true)
+   {
+      sdr::SignalBuffer samples(DECODE_BUFFER_SIZE * input.channels, input.channels, input.sampleRate);
+
+      // null buffer flushes decoder carrier status at end of input
+      bool eof = input.read(samples) <= 0;
+
+      if (eof)
+         samples = {};
+      else
+         job.samples += samples.elements();
+
+      for (const nfc::NfcFrame &frame : decoder.nextFrames(samples))
+      {
+         if (frame.techType() == nfc::TechType::None && !options.carrier)
+            continue;
+
+         if ((long long) frame.sampleStart() < startSample)
+            continue;
+
+         if (options.format == JsonFormat)
+            formatJson(output, frame, job.input);
+         else
+            formatText(output, frame);
+
+         job.frames++;
+      }
+
+      // snapshot decoder status once per checkpoint interval, between nextFrames calls
+      if (checkpointSample >= 0 && !eof && decoder.streamOffset() >= checkpointSample)
+      {
+         checkpoint.write(decoder.streamOffset(), decoder.saveStatus());
+
+         checkpointSample = decoder.streamOffset() + checkpointInterval;
+      }
+
+      if (eof)
+         job.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      if (!output.empty() || eof)
+      {
+         std::lock_guard<std::mutex> guard(jobsLock);
+
+         job.pending.append(output);
+         job.done = eof;
+
+         jobsChanged.notify_all();
+      }
+
+      output.clear();
+
+      if (eof)
+         break;
+   }
+}
+
+void printUsage()
+{
+   fprintf(stderr, "usage: nfc-cli [options] <input>...\n"
+                   "\n"
+                   "inputs are WAV or IQZ recordings, raw sample files, synthetic://<script> devices or shm://<ring>\n"
+                   "shared memory rings, decoded until writer closes the ring\n"
+                   "\n"
+                   "options:\n"
+                   "  -o, --output <file>      write frames to file instead of standard output\n"
+                   "  -f, --format <format>    output format, text (default) or json\n"
+                   "  -j, --jobs <count>       inputs decoded in parallel (default all cores)\n"
+                   "  --carrier                include carrier on / off events\n"
+                   "  --stats                  print decoding throughput to standard error\n"
+                   "  --raw <format>           read inputs as raw interleaved samples, s8, s16 or f32\n"
+                   "                           (.cs8, .cs16, .cf32 and .cfile files are detected by extension)\n"
+                   "  --rate <samples>         raw and synthetic input sample rate (default 10000000)\n"
+                   "  --channels <count>       raw input channels, 2 for IQ or 1 for real samples (default 2)\n"
+                   "  --checkpoint <seconds>   save decoder status to <recording>.ckp at given interval\n"
+                   "  --start <seconds>        report frames from given time, resuming from nearest checkpoint\n"
+                   "  --config <json>          decoder options as JSON, as sent to frame decoder task\n"
+                   "\n"
+                   "decoder options may also be given one by one:\n"
+                   "  --powerLevelThreshold <value>\n"
+                   "  --envelopeKernel <exact|alphaMaxBetaMin>\n"
+                   "  --<nfca|nfcb|nfcf|nfcv>.enabled <true|false>\n"
+                   "  --<nfca|nfcb|nfcf|nfcv>.minimumModulationThreshold <value>\n"
+                   "  --<nfca|nfcb|nfcf|nfcv>.maximumModulationThreshold <value>\n");
+}
+
+bool parseOptions(int argc, char *argv[], Options &options)
+{
+   for (int i = 1; i < argc; i++)
+   {
+      std::string arg = argv[i];
+      std::string value;
+
+      // positional inputs
+      if (arg.size() < 2 || arg[0] != '-')
+      {
+         options.inputs.push_back(arg);
+         continue;
+      }
+
+      if (arg == "-h" || arg == "--help")
+         return false;
+
+      if (arg == "--carrier")
+      {
+         options.carrier = true;
+         continue;
+      }
+
+      if (arg == "--stats")
+      {
+         options.stats = true;
+         continue;
+      }
+
+      // options with value, as "--name value" or "--name=value"
+      size_t equal = arg.find('=');
+
+      if (equal != std::string::npos)
+      {
+         value = arg.substr(equal + 1);
+         arg = arg.substr(0, equal);
+      }
+      else if (i + 1 < argc)
+      {
+         value = argv[++i];
+      }
+      else
+      {
+         fprintf(stderr, "missing value for option %s\n", arg.c_str());
+         return false;
+      }
+
+      try
+      {
+         if (arg == "-o" || arg == "--output")
+            options.output = value;
+
+         else if (arg == "-f" || arg == "--format")
+         {
+            if (value == "text")
+               options.format = TextFormat;
+            else if (value == "json")
+               options.format = JsonFormat;
+            else
+            {
+               fprintf(stderr, "invalid format %s\n", value.c_str());
+               return false;
+            }
+         }
+
+         else if (arg == "-j" || arg == "--jobs")
+            options.jobs = std::stoi(value);
+
+         else if (arg == "--rate")
+            options.sampleRate = std::stol(value);
+
+         else if (arg == "--channels")
+            options.channels = std::stoi(value);
+
+         else if (arg == "--start")
+            options.start = std::stod(value);
+
+         else if (arg == "--checkpoint")
+            options.checkpoint = std::stod(value);
+
+         else if (arg == "--raw")
+         {
+            if (value == "s8")
+               options.rawFormat = RawInt8;
+            else if (value == "s16")
+               options.rawFormat = RawInt16;
+            else if (value == "f32")
+               options.rawFormat = RawFloat32;
+            else
+            {
+               fprintf(stderr, "invalid raw format %s\n", value.c_str());
+               return false;
+            }
+         }
+
+         else if (arg == "--config")
+            options.config.merge_patch(json::parse(value));
+
+         // any other long option is a decoder parameter, nested keys separated by dots
+         else if (arg.rfind("--", 0) == 0)
+         {
+            json param = json::accept(value) ? json::parse(value) : json(value);
+
+            std::replace(arg.begin(), arg.end(), '.', '/');
+
+            options.config[json::json_pointer("/" + arg.substr(2))] = param;
+         }
+
+         else
+         {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return false;
+         }
+      }
+      catch (const std::exception &e)
+      {
+         fprintf(stderr, "invalid value for option %s: %s\n", arg.c_str(), value.c_str());
+         return false;
+      }
+   }
+
+   std::string error;
+
+   if (!checkConfig(options.config, error))
+   {
+      fprintf(stderr, "%s\n", error.c_str());
+      return false;
+   }
+
+   if (options.channels < 1 || options.channels > 2 || options.sampleRate <= 0)
+   {
+      fprintf(stderr, "invalid raw input parameters\n");
+      return false;
+   }
+
+   if (options.start < 0 || options.checkpoint < 0)
+   {
+      fprintf(stderr, "invalid start time or checkpoint interval\n");
+      return false;
+   }
+
+   return !options.inputs.empty();
+}
+
+int main(int argc, char *argv[])
+{
+   Options options;
+
+   if (!parseOptions(argc, argv, options))
+   {
+      printUsage();
+      return 2;
+   }
+
+   FILE *output = stdout;
+
+   if (!options.output.empty() && !(output = fopen(options.output.c_str(), "wb")))
+   {
+      fprintf(stderr, "unable to open output file %s\n", options.output.c_str());
+      return 2;
+   }
+
+   root.info("decoding {} inputs", {(int) options.inputs.size()});
+
+   std::vector<Job> jobs(options.inputs.size());
+
+   for (unsigned int i = 0; i < jobs.size(); i++)
+      jobs[i].input = options.inputs[i];
+
+   // each worker decodes full inputs, pulled in order
+   unsigned int workers = options.jobs > 0 ? options.jobs : std::max(std::thread::hardware_concurrency(), 1u);
+
+   std::atomic<unsigned int> next {0};
+   std::vector<std::thread> threads;
+
+   for (unsigned int i = 0; i < std::min(workers, (unsigned int) jobs.size()); i++)
+   {
+      threads.emplace_back([&] {
+         for (unsigned int index; (index = next++) < jobs.size();)
+            decodeInput(jobs[index], options);
+      });
+   }
+
+   auto start = std::chrono::steady_clock::now();
+
+   int result = 0;
+
+   // write job output in input order, while following inputs are still decoding
+   for (auto &job : jobs)
+   {
+      bool done = false;
+
+      if (options.format == TextFormat && jobs.size() > 1)
+         fprintf(output, "# %s\n", job.input.c_str());
+
+      while (!done)
+      {
+         std::string chunk;
+
+         {
+            std::unique_lock<std::mutex> guard(jobsLock);
+
+            jobsChanged.wait(guard, [&job] { return !job.pending.empty() || job.done; });
+
+            chunk.swap(job.pending);
+
+            done = job.done;
+         }
+
+         fwrite(chunk.data(), 1, chunk.size(), output);
+      }
+
+      if (!job.error.empty())
+      {
+         fprintf(stderr, "%s: %s\n", job.input.c_str(), job.error.c_str());
+         result = 1;
+      }
+      else if (options.stats)
+      {
+         double duration = job.sampleRate ? double(job.samples) / job.sampleRate : 0;
+
+         fprintf(stderr, "%s: %lld frames, %lld samples (%.3f s) decoded in %.3f s, %.2f Msps, %.1fx real time\n",
+                 job.input.c_str(), job.frames, job.samples, duration, job.elapsed, job.samples / job.elapsed / 1E6, duration / job.elapsed);
+      }
+   }
+
+   for (auto &thread : threads)
+      thread.join();
+
+   if (options.stats && jobs.size() > 1)
+   {
+      long long samples = 0;
+
+      for (auto &job : jobs)
+         samples += job.samples;
+
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      fprintf(stderr, "total: %lld samples decoded in %.3f s, %.2f Msps\n", samples, elapsed, samples / elapsed / 1E6);
+   }
+
+   if (output != stdout)
+      fclose(output);
+   else
+      fflush(output);
+
+   return result;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+# Decode a synthetic frame script with nfc-cli and compare decoded frames with expected output, frame times are not
+# compared so same expected file is valid for any sample rate
+#
+# cmake -DCLI=<nfc-cli> -DSCRIPT=<script> -DEXPECTED=<file> -DRATE=<samples> [-DOPTIONS=<options>] -P SyntheticTest.cmake
+
+separate_arguments(OPTIONS)
+
+execute_process(COMMAND ${CLI} --rate ${RATE} ${OPTIONS} synthetic://${SCRIPT}
+        OUTPUT_VARIABLE output
+        RESULT_VARIABLE result)
+
+if (NOT result EQUAL 0)
+   message(FATAL_ERROR "nfc-cli failed with status ${result}")
+endif ()
+
+# drop time start and time end columns
+string(REGEX REPLACE "(^|\n)[0-9.]+ [0-9.]+ " "\\1" frames "${output}")
+
+file(READ ${EXPECTED} expected)
+
+if (NOT frames STREQUAL expected)
+   message(FATAL_ERROR "decoded frames do not match ${EXPECTED}\nexpected:\n${expected}\ndecoded:\n${frames}")
+endif ()
@@ -343,7 +343,7 @@ struct QtDecoder::Impl
    {
       QString name = event->getString("file");
 
-      if (name.endsWith(".wav"))
+      if (name.endsWith(".wav") || name.endsWith(".iqz"))
       {
          // clear storage queue
          taskStorageClear();
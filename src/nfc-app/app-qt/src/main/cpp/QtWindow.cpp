@@ -787,7 +787,7 @@ void QtWindow::clearView()
 
 void QtWindow::openFile()
 {
-   QString fileName = QFileDialog::getOpenFileName(this, tr("Open capture file"), "", tr("Capture (*.wav *.xml *.json);;All Files (*)"));
+   QString fileName = QFileDialog::getOpenFileName(this, tr("Open capture file"), "", tr("Capture (*.wav *.iqz *.xml *.json);;All Files (*)"));
 
    if (!fileName.isEmpty())
    {
@@ -22,6 +22,10 @@
 
 */
 
+#include <thread>
+
+#include <QSettings>
+
 #include <rt/Logger.h>
 #include <rt/Executor.h>
 #include <rt/Subject.h>
@@ -34,6 +38,7 @@
 #include <nfc/FrameDecoderTask.h>
 #include <nfc/FrameStorageTask.h>
 #include <nfc/FourierProcessTask.h>
+#include <nfc/MetricsMonitorTask.h>
 
 #include <nfc/NfcFrame.h>
 #include <nfc/NfcDecoder.h>
@@ -110,29 +115,46 @@ int startTest(int argc, char *argv[])
    return 0;
 }
 
+// default core for isolated tasks counted from last one, any core when there are not enough to leave system and interface free
+int isolatedCore(int index)
+{
+   int cores = (int) std::thread::hardware_concurrency();
+
+   return cores >= 4 ? cores - 1 - index : Executor::AnyCore;
+}
+
 int startApp(int argc, char *argv[])
 {
    root.info("***********************************************************************");
    root.info("NFC laboratory, 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>");
    root.info("***********************************************************************");
 
-   // create executor service
-   Executor executor(128, 10);
+   // thread placement, cores can be set in configuration, -1 runs in any core
+   QSettings settings("conf/nfc-lab.conf", QSettings::IniFormat);
+
+   int receiverCore = settings.value("executor/receiverCore", isolatedCore(0)).toInt();
+   int decoderCore = settings.value("executor/decoderCore", isolatedCore(1)).toInt();
 
-   // startup signal decoder task
-   executor.submit(nfc::FrameDecoderTask::construct());
+   // create executor service, pool threads only for short jobs, workers run in dedicated threads
+   Executor executor(128, 4);
+
+   // startup signal decoder task, isolated in its own core
+   executor.submit(nfc::FrameDecoderTask::construct(), Executor::Highest, decoderCore);
 
    // startup frame writer task
-   executor.submit(nfc::FrameStorageTask::construct());
+   executor.submit(nfc::FrameStorageTask::construct(), Executor::Low);
 
    // startup signal reader task
-   executor.submit(nfc::SignalRecorderTask::construct());
+   executor.submit(nfc::SignalRecorderTask::construct(), Executor::Normal);
 
-   // startup signal receiver task
-   executor.submit(nfc::SignalReceiverTask::construct());
+   // startup signal receiver task, samples are delivered from device thread so it gets realtime priority and isolated core
+   executor.submit(nfc::SignalReceiverTask::construct(Executor::Realtime, receiverCore), Executor::Normal);
 
    // startup fourier transform task
-   executor.submit(nfc::FourierProcessTask::construct());
+   executor.submit(nfc::FourierProcessTask::construct(), Executor::Lowest);
+
+   // startup pipeline metrics monitor task
+   executor.submit(nfc::MetricsMonitorTask::construct(), Executor::Lowest);
 
    // set logging handler
    qInstallMessageHandler(messageOutput);
@@ -23,6 +23,7 @@
 */
 
 #include <cmath>
+#include <atomic>
 
 #include <QDebug>
 #include <QMutex>
@@ -58,6 +59,9 @@ struct FrequencyWidget::Impl : public gl::Engine
    // last frame time
    float lastFrame;
 
+   // repaint request pending
+   std::atomic<bool> repaintPending {false};
+
    Impl() : lastFrame(0), resources(new QtResources())
    {
    }
@@ -147,6 +151,12 @@ void FrequencyWidget::setSampleRate(long value)
 void FrequencyWidget::refresh(const sdr::SignalBuffer &buffer)
 {
    impl->refresh(buffer);
+
+   // buffers are received from worker threads, request repaint on GUI thread once per frame
+   if (!impl->repaintPending.exchange(true))
+   {
+      QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+   }
 }
 
 void FrequencyWidget::initializeGL()
@@ -169,7 +179,13 @@ void FrequencyWidget::resizeGL(int w, int h)
 
 void FrequencyWidget::paintGL()
 {
+   impl->repaintPending = false;
+
    impl->paint();
 
-   update();
+   // only keep repainting while there are running transforms, otherwise wait for new data
+   if (impl->isAnimated())
+   {
+      update();
+   }
 }
@@ -22,6 +22,8 @@
 
 */
 
+#include <atomic>
+
 #include <QDebug>
 #include <QElapsedTimer>
 #include <QResizeEvent>
@@ -53,6 +55,9 @@ struct QuadratureWidget::Impl : public gl::Engine
    // last frame time
    float lastFrame;
 
+   // repaint request pending
+   std::atomic<bool> repaintPending {false};
+
    Impl() : lastFrame(0), resources(new QtResources())
    {
    }
@@ -116,6 +121,12 @@ QuadratureWidget::QuadratureWidget(QWidget *parent) : QOpenGLWidget(parent), imp
 void QuadratureWidget::refresh(const sdr::SignalBuffer &buffer)
 {
    impl->refresh(buffer);
+
+   // buffers are received from worker threads, request repaint on GUI thread once per frame
+   if (!impl->repaintPending.exchange(true))
+   {
+      QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+   }
 }
 
 void QuadratureWidget::initializeGL()
@@ -148,9 +159,15 @@ void QuadratureWidget::resizeGL(int w, int h)
 
 void QuadratureWidget::paintGL()
 {
+   impl->repaintPending = false;
+
    impl->paint();
 
-   update();
+   // only keep repainting while there are running transforms, otherwise wait for new data
+   if (impl->isAnimated())
+   {
+      update();
+   }
 }
 
 void QuadratureWidget::resizeEvent(QResizeEvent *event)
@@ -35,8 +35,12 @@ struct Buffer::Impl
    unsigned int size;
    unsigned int elements;
    unsigned int stride;
+   unsigned int usage;
 
-   Impl(int target, unsigned int size, const void *data, unsigned int elements, unsigned int stride) : id(0), target(target), size(size), elements(elements), stride(stride)
+   // persistent mapped memory, only for stream buffers
+   void *memory;
+
+   Impl(int target, unsigned int size, const void *data, unsigned int elements, unsigned int stride) : id(0), target(target), size(size), elements(elements), stride(stride), usage(0), memory(nullptr)
    {
       glGenBuffers(1, &this->id);
       glBindBuffer(target, this->id);
@@ -63,8 +67,35 @@ struct Buffer::Impl
       glBindBuffer(target, 0);
    }
 
+   Impl(int target, unsigned int size, unsigned int elements, unsigned int stride) : id(0), target(target), size(size), elements(elements), stride(stride), usage(GL_STREAM_DRAW), memory(nullptr)
+   {
+      glGenBuffers(1, &this->id);
+      glBindBuffer(target, this->id);
+
+      if (GLEW_ARB_buffer_storage)
+      {
+         // immutable storage mapped for whole buffer life, written directly by producers
+         glBufferStorage(target, size, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+         memory = glMapBufferRange(target, 0, size, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+      }
+      else
+      {
+         glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+      }
+
+      glBindBuffer(target, 0);
+   }
+
    ~Impl()
    {
+      if (memory)
+      {
+         glBindBuffer(target, this->id);
+         glUnmapBuffer(target);
+         glBindBuffer(target, 0);
+      }
+
       glDeleteBuffers(1, &id);
    }
 
@@ -78,6 +109,11 @@ struct Buffer::Impl
    void update(const void *data, unsigned int offset, unsigned int size)
    {
       glBindBuffer(this->target, this->id);
+
+      // orphan previous storage so driver does not wait for pending draws
+      if (usage == GL_STREAM_DRAW && !memory && offset == 0)
+         glBufferData(this->target, this->size, nullptr, GL_STREAM_DRAW);
+
       glBufferSubData(this->target, offset, size ? size : this->size, data);
       glBindBuffer(this->target, 0);
    }
@@ -137,6 +173,11 @@ unsigned int Buffer::stride() const
    return self ? self->stride : 0;
 }
 
+void *Buffer::memory() const
+{
+   return self ? self->memory : nullptr;
+}
+
 Buffer Buffer::bind(int index) const
 {
    if (self)
@@ -180,4 +221,9 @@ Buffer Buffer::createUniformBuffer(unsigned int size, const void *data, unsigned
    return Buffer(new Impl(GL_UNIFORM_BUFFER, size, data, elements, stride));
 }
 
+Buffer Buffer::createStreamBuffer(unsigned int size, unsigned int elements, unsigned int stride)
+{
+   return Buffer(new Impl(GL_ARRAY_BUFFER, size, elements, stride));
+}
+
 }
\ No newline at end of file
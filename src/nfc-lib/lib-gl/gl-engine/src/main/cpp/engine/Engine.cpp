@@ -40,6 +40,13 @@ namespace gl {
 struct Engine::Impl
 {
    rt::Logger log {"Engine"};
+
+   // scene generation and tree revision from last compute
+   unsigned int computeChanges = 0;
+   unsigned int computeRevision = 0;
+
+   // force compute on first update
+   bool computeValid = false;
 };
 
 Engine::Engine() : impl(new Impl),
@@ -111,9 +118,16 @@ void Engine::update(float time, float delta)
    objects->update(time, delta);
    widgets->update(time, delta);
 
-   // compute model
-   objects->compute(camera);
-   widgets->compute(screen);
+   // compute model only if any matrix, tree or viewer has been changed
+   if (!impl->computeValid || impl->computeChanges != Model::changes() || impl->computeRevision != Model::revision() || camera->isDirty() || screen->isDirty())
+   {
+      objects->compute(camera);
+      widgets->compute(screen);
+
+      impl->computeChanges = Model::changes();
+      impl->computeRevision = Model::revision();
+      impl->computeValid = true;
+   }
 
    // draw all
    renderer->begin();
@@ -126,6 +140,11 @@ void Engine::update(float time, float delta)
    screen->clearDirty();
 }
 
+bool Engine::isAnimated() const
+{
+   return objects->isAnimated() || widgets->isAnimated();
+}
+
 void Engine::dispose()
 {
    objects->dispose();
@@ -24,12 +24,43 @@
 
 #include <memory>
 #include <cmath>
+#include <cstring>
+
+#if defined(__SSE3__)
+#include <pmmintrin.h>
+#endif
 
 #include <gl/engine/Vector.h>
 #include <gl/engine/Matrix.h>
 
 namespace gl {
 
+#if defined(__SSE3__)
+
+// matrix columns are stored contiguous, so each column maps to one SSE register
+#define SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define SWIZZLE(a, x, y, z, w) _mm_shuffle_ps(a, a, _MM_SHUFFLE(w, z, y, x))
+
+// 2x2 matrix multiply A * B
+inline __m128 mat2Mul(__m128 a, __m128 b)
+{
+   return _mm_add_ps(_mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// 2x2 matrix adjugate multiply adj(A) * B
+inline __m128 mat2AdjMul(__m128 a, __m128 b)
+{
+   return _mm_sub_ps(_mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// 2x2 matrix multiply adjugate A * adj(B)
+inline __m128 mat2MulAdj(__m128 a, __m128 b)
+{
+   return _mm_sub_ps(_mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+#endif
+
 Matrix::Matrix(float *data)
 {
    if (data != nullptr)
@@ -230,6 +261,19 @@ Matrix Matrix::transpose() const
 
 Matrix &Matrix::transposeInPlace()
 {
+#if defined(__SSE3__)
+   __m128 c0 = _mm_loadu_ps(matrix + 0);
+   __m128 c1 = _mm_loadu_ps(matrix + 4);
+   __m128 c2 = _mm_loadu_ps(matrix + 8);
+   __m128 c3 = _mm_loadu_ps(matrix + 12);
+
+   _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+   _mm_storeu_ps(matrix + 0, c0);
+   _mm_storeu_ps(matrix + 4, c1);
+   _mm_storeu_ps(matrix + 8, c2);
+   _mm_storeu_ps(matrix + 12, c3);
+#else
    float temp[16];
 
    for (int i = 0; i < 4; i++)
@@ -241,17 +285,68 @@ Matrix &Matrix::transposeInPlace()
    }
 
    memcpy(matrix, temp, sizeof(matrix));
+#endif
 
    return *this;
 }
 
 Matrix Matrix::invert() const
 {
-   return Matrix();
+   return Matrix(*this).invertInPlace();
 }
 
 Matrix &Matrix::invertInPlace()
 {
+#if defined(__SSE3__)
+   // invert by 2x2 block matrices, inverse of transpose is transpose of inverse so layout does not matter
+   __m128 m0 = _mm_loadu_ps(matrix + 0);
+   __m128 m1 = _mm_loadu_ps(matrix + 4);
+   __m128 m2 = _mm_loadu_ps(matrix + 8);
+   __m128 m3 = _mm_loadu_ps(matrix + 12);
+
+   // sub matrices
+   __m128 a = _mm_movelh_ps(m0, m1);
+   __m128 b = _mm_movehl_ps(m1, m0);
+   __m128 c = _mm_movelh_ps(m2, m3);
+   __m128 d = _mm_movehl_ps(m3, m2);
+
+   // sub matrices determinants |A| |B| |C| |D|
+   __m128 det = _mm_sub_ps(_mm_mul_ps(SHUFFLE(m0, m2, 0, 2, 0, 2), SHUFFLE(m1, m3, 1, 3, 1, 3)), _mm_mul_ps(SHUFFLE(m0, m2, 1, 3, 1, 3), SHUFFLE(m1, m3, 0, 2, 0, 2)));
+
+   __m128 detA = SWIZZLE(det, 0, 0, 0, 0);
+   __m128 detB = SWIZZLE(det, 1, 1, 1, 1);
+   __m128 detC = SWIZZLE(det, 2, 2, 2, 2);
+   __m128 detD = SWIZZLE(det, 3, 3, 3, 3);
+
+   __m128 dc = mat2AdjMul(d, c);
+   __m128 ab = mat2AdjMul(a, b);
+
+   __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2Mul(b, dc));
+   __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2Mul(c, ab));
+   __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2MulAdj(d, ab));
+   __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2MulAdj(a, dc));
+
+   // |M| = |A| |D| + |B| |C| - tr(adj(A) B adj(D) C)
+   __m128 tr = _mm_mul_ps(ab, SWIZZLE(dc, 0, 2, 1, 3));
+
+   tr = _mm_hadd_ps(tr, tr);
+   tr = _mm_hadd_ps(tr, tr);
+
+   __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+   __m128 rdet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+
+   x = _mm_mul_ps(x, rdet);
+   y = _mm_mul_ps(y, rdet);
+   z = _mm_mul_ps(z, rdet);
+   w = _mm_mul_ps(w, rdet);
+
+   // apply adjugate and store
+   _mm_storeu_ps(matrix + 0, SHUFFLE(x, y, 3, 1, 3, 1));
+   _mm_storeu_ps(matrix + 4, SHUFFLE(x, y, 2, 0, 2, 0));
+   _mm_storeu_ps(matrix + 8, SHUFFLE(z, w, 3, 1, 3, 1));
+   _mm_storeu_ps(matrix + 12, SHUFFLE(z, w, 2, 0, 2, 0));
+#else
    // Invert a 4 x 4 matrix using Cramer's Rule
 
    // transpose matrix
@@ -351,6 +446,7 @@ Matrix &Matrix::invertInPlace()
    matrix[3 * 4 + 1] = dst31 * invdet;
    matrix[3 * 4 + 2] = dst32 * invdet;
    matrix[3 * 4 + 3] = dst33 * invdet;
+#endif
 
    return *this;
 }
@@ -363,12 +459,18 @@ Matrix Matrix::scale(float sx, float sy, float sz) const
 
 Matrix &Matrix::scaleInPlace(float sx, float sy, float sz)
 {
+#if defined(__SSE3__)
+   _mm_storeu_ps(matrix + 0, _mm_mul_ps(_mm_loadu_ps(matrix + 0), _mm_set1_ps(sx)));
+   _mm_storeu_ps(matrix + 4, _mm_mul_ps(_mm_loadu_ps(matrix + 4), _mm_set1_ps(sy)));
+   _mm_storeu_ps(matrix + 8, _mm_mul_ps(_mm_loadu_ps(matrix + 8), _mm_set1_ps(sz)));
+#else
    for (int i = 0; i < 4; i++)
    {
       matrix[0 * 4 + i] *= sx;
       matrix[1 * 4 + i] *= sy;
       matrix[2 * 4 + i] *= sz;
    }
+#endif
 
    return *this;
 }
@@ -394,10 +496,16 @@ Matrix Matrix::translate(float dx, float dy, float dz) const
 
 Matrix &Matrix::translateInPlace(float dx, float dy, float dz)
 {
+#if defined(__SSE3__)
+   __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(matrix + 0), _mm_set1_ps(dx)), _mm_mul_ps(_mm_loadu_ps(matrix + 4), _mm_set1_ps(dy))), _mm_mul_ps(_mm_loadu_ps(matrix + 8), _mm_set1_ps(dz)));
+
+   _mm_storeu_ps(matrix + 12, _mm_add_ps(_mm_loadu_ps(matrix + 12), t));
+#else
    for (int i = 0; i < 4; i++)
    {
       matrix[3 * 4 + i] += matrix[0 * 4 + i] * dx + matrix[1 * 4 + i] * dy + matrix[2 * 4 + i] * dz;
    }
+#endif
 
    return *this;
 }
@@ -529,6 +637,15 @@ Matrix &Matrix::multiplyInPlace(const Matrix &other, bool reverse)
 
 Vector Matrix::multiply(Vector v) const
 {
+#if defined(__SSE3__)
+   float r[4];
+
+   __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(matrix + 0), _mm_set1_ps(v.x)), _mm_mul_ps(_mm_loadu_ps(matrix + 4), _mm_set1_ps(v.y))), _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(matrix + 8), _mm_set1_ps(v.z)), _mm_loadu_ps(matrix + 12)));
+
+   _mm_storeu_ps(r, _mm_div_ps(t, SWIZZLE(t, 3, 3, 3, 3)));
+
+   return {r[0], r[1], r[2]};
+#else
    float x = v.x * matrix[0 * 4 + 0] + v.y * matrix[1 * 4 + 0] + v.z * matrix[2 * 4 + 0] + 1.0f * matrix[3 * 4 + 0];
    float y = v.x * matrix[0 * 4 + 1] + v.y * matrix[1 * 4 + 1] + v.z * matrix[2 * 4 + 1] + 1.0f * matrix[3 * 4 + 1];
    float z = v.x * matrix[0 * 4 + 2] + v.y * matrix[1 * 4 + 2] + v.z * matrix[2 * 4 + 2] + 1.0f * matrix[3 * 4 + 2];
@@ -537,10 +654,28 @@ Vector Matrix::multiply(Vector v) const
 //   assert(w != 0);
 
    return {x / w, y / w, z / w};
+#endif
 }
 
 void Matrix::multiply(float *r, const float *a, const float *b)
 {
+#if defined(__SSE3__)
+   __m128 a0 = _mm_loadu_ps(a + 0);
+   __m128 a1 = _mm_loadu_ps(a + 4);
+   __m128 a2 = _mm_loadu_ps(a + 8);
+   __m128 a3 = _mm_loadu_ps(a + 12);
+
+   // each result column is a linear combination of A columns, r may alias a or b
+   __m128 r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[0])), _mm_mul_ps(a1, _mm_set1_ps(b[1]))), _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b[2])), _mm_mul_ps(a3, _mm_set1_ps(b[3]))));
+   __m128 r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[4])), _mm_mul_ps(a1, _mm_set1_ps(b[5]))), _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b[6])), _mm_mul_ps(a3, _mm_set1_ps(b[7]))));
+   __m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[8])), _mm_mul_ps(a1, _mm_set1_ps(b[9]))), _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b[10])), _mm_mul_ps(a3, _mm_set1_ps(b[11]))));
+   __m128 r3 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[12])), _mm_mul_ps(a1, _mm_set1_ps(b[13]))), _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b[14])), _mm_mul_ps(a3, _mm_set1_ps(b[15]))));
+
+   _mm_storeu_ps(r + 0, r0);
+   _mm_storeu_ps(r + 4, r1);
+   _mm_storeu_ps(r + 8, r2);
+   _mm_storeu_ps(r + 12, r3);
+#else
    for (int i = 0; i < 4; i++)
    {
       float ai0 = a[4 * 0 + i];
@@ -553,6 +688,7 @@ void Matrix::multiply(float *r, const float *a, const float *b)
       r[4 * 2 + i] = ai0 * b[2 * 4 + 0] + ai1 * b[2 * 4 + 1] + ai2 * b[2 * 4 + 2] + ai3 * b[2 * 4 + 3];
       r[4 * 3 + i] = ai0 * b[3 * 4 + 0] + ai1 * b[3 * 4 + 1] + ai2 * b[3 * 4 + 2] + ai3 * b[3 * 4 + 3];
    }
+#endif
 }
 
 }
\ No newline at end of file
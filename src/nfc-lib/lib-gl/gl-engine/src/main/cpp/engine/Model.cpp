@@ -31,6 +31,12 @@
 
 namespace gl {
 
+// model tree revision, changes when any model or draw item is added or removed
+static unsigned int treeRevision = 0;
+
+// scene generation, changes when any model matrix or content is modified
+static unsigned int sceneGeneration = 0;
+
 struct Model::Impl
 {
    // visibility flag
@@ -51,16 +57,34 @@ struct Model::Impl
    // proyection matrix, world from camera perspective
    Matrix projMatrix;
 
+   // model generation, changes when matrix or content is modified
+   unsigned int generation = 0;
+
    // matrix update flags
    bool modelDirty = true;
    bool viewDirty = false;
    bool projDirty = false;
 
+   // any descendant model has pending matrix updates
+   bool childDirty = false;
+
    // childs models
    std::vector<Model *> childs;
 
    // model transforms
    std::vector<Transform *> transforms;
+
+   // draw commands for each shader program type
+   std::vector<DrawItem> drawItems;
+
+   void setModelDirty()
+   {
+      modelDirty = true;
+
+      // notify parents so compute pass visits this branch
+      for (Model *model = parent; model && !model->self->childDirty; model = model->self->parent)
+         model->self->childDirty = true;
+   }
 };
 
 Model::Model() : self(new Impl)
@@ -74,6 +98,8 @@ Model::~Model()
 
    for (auto transform : self->transforms)
       delete transform;
+
+   treeRevision++;
 }
 
 bool Model::isVisible() const
@@ -83,7 +109,12 @@ bool Model::isVisible() const
 
 Model *Model::setVisible(bool value)
 {
-   self->visible = value;
+   if (self->visible != value)
+   {
+      self->visible = value;
+
+      touch();
+   }
 
    return this;
 }
@@ -96,20 +127,23 @@ Model *Model::parent()
 Model *Model::reset()
 {
    self->modelMatrix.setIdentity();
-   self->modelDirty = true;
-   return this;
+   self->setModelDirty();
+   return touch();
 }
 
 Model *Model::add(Model *child)
 {
    child->self->parent = this;
+   child->self->setModelDirty();
    self->childs.push_back(child);
+   treeRevision++;
    return this;
 }
 
 Model *Model::remove(Model *child)
 {
    self->childs.erase(std::remove(self->childs.begin(), self->childs.end(), child), self->childs.end());
+   treeRevision++;
    return this;
 }
 
@@ -198,29 +232,29 @@ Model *Model::updateProj(const Matrix &updateMatrix)
 Model *Model::resize(float x, float y, float z)
 {
    self->modelMatrix.resizeInPlace(x, y, z);
-   self->modelDirty = true;
-   return this;
+   self->setModelDirty();
+   return touch();
 }
 
 Model *Model::rotate(float a, float x, float y, float z)
 {
    self->modelMatrix.rotateInPlace(a, x, y, z);
-   self->modelDirty = true;
-   return this;
+   self->setModelDirty();
+   return touch();
 }
 
 Model *Model::scale(float x, float y, float z)
 {
    self->modelMatrix.scaleInPlace(x, y, z);
-   self->modelDirty = true;
-   return this;
+   self->setModelDirty();
+   return touch();
 }
 
 Model *Model::translate(float x, float y, float z)
 {
    self->modelMatrix.translateInPlace(x, y, z);
-   self->modelDirty = true;
-   return this;
+   self->setModelDirty();
+   return touch();
 }
 
 Matrix &Model::worldMatrix() const
@@ -245,6 +279,15 @@ Matrix &Model::projMatrix() const
 
 void Model::draw(Device *device, Program *shader) const
 {
+   if (self->visible)
+   {
+      for (const auto &item : self->drawItems)
+      {
+         if (item.accept(shader))
+            item.draw(device, shader);
+      }
+   }
+
    for (auto child : self->childs)
    {
       child->draw(device, shader);
@@ -257,6 +300,56 @@ void Model::dispose()
       delete child;
 
    self->childs.clear();
+
+   treeRevision++;
+}
+
+const std::vector<DrawItem> &Model::drawItems() const
+{
+   return self->drawItems;
+}
+
+unsigned int Model::revision()
+{
+   return treeRevision;
+}
+
+unsigned int Model::generation() const
+{
+   return self->generation;
+}
+
+unsigned int Model::changes()
+{
+   return sceneGeneration;
+}
+
+bool Model::isAnimated() const
+{
+   if (!self->transforms.empty())
+      return true;
+
+   for (auto child : self->childs)
+   {
+      if (child->isAnimated())
+         return true;
+   }
+
+   return false;
+}
+
+Model *Model::touch()
+{
+   self->generation++;
+   sceneGeneration++;
+   return this;
+}
+
+Model *Model::addDrawItem(const DrawItem &item)
+{
+   self->drawItems.push_back(item);
+   treeRevision++;
+   return this;
 }
 
 bool Model::isDirty() const
@@ -271,6 +364,10 @@ void Model::clearDirty()
 
 void Model::compute(Viewer *viewer, Model *parent)
 {
+   // world matrix is cached, skip whole branch if nothing has been changed
+   if (!viewer->isDirty() && !this->isDirty() && !self->childDirty && !(parent && parent->isDirty()))
+      return;
+
    if (!parent)
    {
       if (viewer->isDirty() || this->isDirty())
@@ -304,6 +401,8 @@ void Model::compute(Viewer *viewer, Model *parent)
 
    // finalmente marcamos modelo como procesado
    this->clearDirty();
+
+   self->childDirty = false;
 }
 
 }
\ No newline at end of file
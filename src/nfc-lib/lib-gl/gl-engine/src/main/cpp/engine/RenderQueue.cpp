@@ -0,0 +1,109 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+#include <gl/engine/Model.h>
+#include <gl/engine/RenderQueue.h>
+
+namespace gl {
+
+struct RenderQueue::Impl
+{
+   // queued draw command
+   struct Entry
+   {
+      const Model *model;
+      const DrawItem *item;
+   };
+
+   // model tree revision when queue was built
+   unsigned int revision = 0;
+
+   // programs used to build queue
+   std::vector<Program *> programs;
+
+   // one bucket for each program, draw items in tree order
+   std::vector<std::vector<Entry>> buckets;
+
+   void append(const Model *model)
+   {
+      for (const auto &item : model->drawItems())
+      {
+         for (unsigned int i = 0; i < programs.size(); i++)
+         {
+            if (item.accept(programs[i]))
+            {
+               buckets[i].push_back({model, &item});
+            }
+         }
+      }
+   }
+};
+
+RenderQueue::RenderQueue() : self(std::make_shared<Impl>())
+{
+}
+
+bool RenderQueue::isValid(const std::vector<Program *> &programs) const
+{
+   return self->revision == Model::revision() && self->programs == programs;
+}
+
+void RenderQueue::build(Model *root, const std::vector<Program *> &programs)
+{
+   self->revision = Model::revision();
+   self->programs = programs;
+   self->buckets.assign(programs.size(), {});
+
+   // root model first, then childs in same order as they are added
+   self->append(root);
+
+   root->walk([this](Model *model) {
+      self->append(model);
+   });
+}
+
+bool RenderQueue::isEmpty(int bucket) const
+{
+   return bucket < 0 || bucket >= (int) self->buckets.size() || self->buckets[bucket].empty();
+}
+
+void RenderQueue::render(Device *device, Program *program, int bucket) const
+{
+   for (const auto &entry : self->buckets[bucket])
+   {
+      if (entry.model->isVisible())
+      {
+         entry.item->draw(device, program);
+      }
+   }
+}
+
+void RenderQueue::clear()
+{
+   self->revision = 0;
+   self->programs.clear();
+   self->buckets.clear();
+}
+
+}
\ No newline at end of file
@@ -22,9 +22,12 @@
 
 */
 
+#include <map>
+
 #include <opengl/GL.h>
 
 #include <gl/engine/Model.h>
+#include <gl/engine/RenderQueue.h>
 #include <gl/engine/Renderer.h>
 
 namespace gl {
@@ -35,6 +38,9 @@ struct Renderer::Impl
 
    std::vector<Program *> shaderList;
 
+   // render queue for each root model, rebuilt only when model tree or shaders change
+   std::map<Model *, RenderQueue> renderQueues;
+
    Impl() : renderState(Renderer::NONE)
    {
    }
@@ -76,11 +82,24 @@ Renderer *Renderer::end()
 
 Renderer *Renderer::draw(Model *model)
 {
-   for (auto shader : self->shaderList)
+   auto &queue = self->renderQueues[model];
+
+   if (!queue.isValid(self->shaderList))
    {
-      shader->useProgram();
-      model->draw(this, shader);
-      shader->endProgram();
+      queue.build(model, self->shaderList);
+   }
+
+   // draw queued items in shader order, skipping programs without items
+   for (unsigned int i = 0; i < self->shaderList.size(); i++)
+   {
+      if (!queue.isEmpty(i))
+      {
+         auto shader = self->shaderList[i];
+
+         shader->useProgram();
+         queue.render(this, shader, i);
+         shader->endProgram();
+      }
    }
 
    return this;
@@ -95,6 +114,8 @@ Renderer *Renderer::dispose()
 
    self->shaderList.clear();
 
+   self->renderQueues.clear();
+
    return this;
 }
 
@@ -0,0 +1,262 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+#include <mutex>
+#include <vector>
+
+#include <opengl/GL.h>
+
+#include <gl/engine/StreamBuffer.h>
+
+namespace gl {
+
+struct StreamBuffer::Impl
+{
+   enum State
+   {
+      Free, Writing, Ready, Front, Retired
+   };
+
+   struct Region
+   {
+      // GPU buffer for this region
+      Buffer buffer;
+
+      // host staging memory, only when persistent mapping is not available
+      std::vector<char> staging;
+
+      // producer write pointer
+      void *memory = nullptr;
+
+      // fence for last draw commands reading this region
+      GLsync sync = nullptr;
+
+      // valid bytes
+      unsigned int length = 0;
+
+      // region state
+      State state = Free;
+   };
+
+   unsigned int size;
+
+   std::vector<Region> regions;
+
+   // protect region states, never held while copying data
+   std::mutex mutex;
+
+   Impl(unsigned int size, unsigned int elements, unsigned int stride, int count) : size(size), regions(count)
+   {
+      for (auto &region : regions)
+      {
+         region.buffer = Buffer::createStreamBuffer(size, elements, stride);
+
+         if (!(region.memory = region.buffer.memory()))
+         {
+            region.staging.resize(size);
+            region.memory = region.staging.data();
+         }
+      }
+   }
+
+   ~Impl()
+   {
+      for (auto &region : regions)
+      {
+         if (region.sync)
+            glDeleteSync(region.sync);
+      }
+   }
+
+   Region *find(State state)
+   {
+      for (auto &region : regions)
+      {
+         if (region.state == state)
+            return &region;
+      }
+
+      return nullptr;
+   }
+
+   void *map()
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      Region *region = find(Free);
+
+      // no free regions, replace pending data not yet consumed by render thread
+      if (!region)
+         region = find(Ready);
+
+      if (!region)
+         return nullptr;
+
+      region->state = Writing;
+
+      return region->memory;
+   }
+
+   void unmap(unsigned int length)
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      // previous pending data is superseded by this one
+      if (auto ready = find(Ready))
+         ready->state = Free;
+
+      if (auto region = find(Writing))
+      {
+         region->length = length < size ? length : size;
+         region->state = Ready;
+      }
+   }
+
+   bool acquire()
+   {
+      Region *front;
+
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+
+         // recycle regions whose draw commands are finished
+         for (auto &region : regions)
+         {
+            if (region.state == Retired && glClientWaitSync(region.sync, 0, 0) != GL_TIMEOUT_EXPIRED)
+            {
+               glDeleteSync(region.sync);
+
+               region.sync = nullptr;
+               region.state = Free;
+            }
+         }
+
+         auto ready = find(Ready);
+
+         if (!ready)
+            return false;
+
+         // release current region, must wait for GPU if it is persistent mapped
+         if ((front = find(Front)))
+            front->state = front->sync ? Retired : Free;
+
+         ready->state = Front;
+
+         front = ready;
+      }
+
+      // staged regions are uploaded by orphaning buffer storage
+      if (!front->staging.empty())
+         front->buffer.update(front->staging.data(), 0, front->length);
+
+      return true;
+   }
+
+   void fence()
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      auto front = find(Front);
+
+      // only persistent mapped regions are written while GPU may be reading
+      if (front && front->staging.empty())
+      {
+         if (front->sync)
+            glDeleteSync(front->sync);
+
+         front->sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      }
+   }
+};
+
+StreamBuffer::StreamBuffer() : self(nullptr)
+{
+}
+
+StreamBuffer::StreamBuffer(struct Impl *impl) : self(impl)
+{
+}
+
+bool StreamBuffer::valid() const
+{
+   return self && !self->regions.empty();
+}
+
+unsigned int StreamBuffer::size() const
+{
+   return self ? self->size : 0;
+}
+
+unsigned int StreamBuffer::length() const
+{
+   if (!self)
+      return 0;
+
+   std::lock_guard<std::mutex> lock(self->mutex);
+
+   auto front = self->find(Impl::Front);
+
+   return front ? front->length : 0;
+}
+
+void *StreamBuffer::map()
+{
+   return self ? self->map() : nullptr;
+}
+
+void StreamBuffer::unmap(unsigned int length)
+{
+   if (self)
+      self->unmap(length);
+}
+
+bool StreamBuffer::acquire()
+{
+   return self && self->acquire();
+}
+
+Buffer StreamBuffer::current() const
+{
+   if (!self)
+      return {};
+
+   std::lock_guard<std::mutex> lock(self->mutex);
+
+   auto front = self->find(Impl::Front);
+
+   return front ? front->buffer : Buffer();
+}
+
+void StreamBuffer::fence()
+{
+   if (self)
+      self->fence();
+}
+
+StreamBuffer StreamBuffer::createArrayBuffer(unsigned int size, unsigned int elements, unsigned int stride, int regions)
+{
+   return StreamBuffer(new Impl(size, elements, stride, regions));
+}
+
+}
\ No newline at end of file
@@ -46,6 +46,8 @@ Widget *Widget::move(int x, int y)
    self->x = x;
    self->y = y;
 
+   touch();
+
    // trigger children layout
    walk([=](Model *model) {
       if (auto widget = dynamic_cast<Widget *>(model))
@@ -61,6 +63,8 @@ Widget *Widget::resize(int width, int height)
    self->height = height;
    self->aspect = (float) width / (float) height;
 
+   touch();
+
    if (width >= height)
    {
       self->pixel = 2.0f / (float) height;
@@ -23,9 +23,13 @@
 */
 
 #include <map>
+#include <cstdio>
+#include <cstring>
 #include <utility>
 #include <vector>
 
+#include <sys/stat.h>
+
 #include <opengl/GL.h>
 
 #include <ft2build.h>
@@ -79,6 +83,40 @@ struct Char
    }
 };
 
+// packed glyph texture and metrics for one font, size and dpi
+struct Atlas
+{
+   int size = 0;
+   int width = 0;
+   int height = 0;
+
+   std::vector<Rgba> texture;
+   std::vector<Quad> quads;
+
+   explicit operator bool() const
+   {
+      return !quads.empty();
+   }
+};
+
+// atlas cache file header, any change in layout must increase version
+struct AtlasHeader
+{
+   char magic[4];
+   unsigned int version;
+   unsigned int quadSize;
+   long long sourceSize;
+   long long sourceTime;
+   int size;
+   int dpi;
+   int width;
+   int height;
+   unsigned int quads;
+} __attribute__((packed));
+
+static const char AtlasMagic[4] = {'N', 'F', 'C', 'A'};
+static const unsigned int AtlasVersion = 1;
+
 struct TextImpl : public Text
 {
    rt::Logger log {"Text"};
@@ -94,10 +132,24 @@ struct TextImpl : public Text
    {
       geometry.vertex = Buffer::createArrayBuffer(256 * sizeof(Vertex) * 4, nullptr, 256 * 4, sizeof(Vertex));
       geometry.index = Buffer::createElementBuffer(256 * sizeof(unsigned int) * 6, nullptr, 256 * 6);
+
+      addDrawItem<TypeFaceShader>([this](Device *device, TypeFaceShader *shader) {
+         if (this->font)
+         {
+            this->font.bind(0);
+            shader->setMatrixBlock(*this);
+            shader->setObjectColor({1.0, 1.0, 1.0, 1.0});
+            shader->drawGeometry(geometry, this->text.length() * 6);
+         }
+      });
    }
 
    Text *setText(const std::string &value) override
    {
+      // avoid geometry upload if text has not been changed
+      if (value == text)
+         return this;
+
       text = value;
 
       layout();
@@ -165,6 +217,8 @@ struct TextImpl : public Text
             // update geometry buffers
             geometry.vertex.update(v, 0, sizeof(v));
             geometry.index.update(i, 0, sizeof(i));
+
+            touch();
          }
          else
          {
@@ -175,20 +229,6 @@ struct TextImpl : public Text
          Widget::resize(width, height);
       }
    }
-
-   void draw(Device *device, Program *shader) const override
-   {
-      if (isVisible() && font)
-      {
-         if (auto typeFaceShader = dynamic_cast<TypeFaceShader *>(shader))
-         {
-            font.bind(0);
-            typeFaceShader->setMatrixBlock(*this);
-            typeFaceShader->setObjectColor({1.0, 1.0, 1.0, 1.0});
-            typeFaceShader->drawGeometry(geometry, text.length() * 6);
-         }
-      }
-   }
 };
 
 struct FreeTypeImpl
@@ -206,13 +246,112 @@ struct FreeTypeImpl
       if (it != fonts.end())
          return it->second;
 
-      if (auto font = loadFont(name, size, dpi))
-         return fonts[key] = font;
+      std::string file = "fonts/" + name + ".ttf";
+      std::string cache = rt::Format::format("fonts/{}-{}-{}.atlas", {name, size, dpi});
 
-      return {};
+      struct stat source {};
+
+      if (stat(file.c_str(), &source) != 0)
+      {
+         log.error("failed to load {}", {file});
+         return {};
+      }
+
+      // reuse glyphs rasterized by previous runs, only if source font has not been changed
+      Atlas atlas = readAtlas(cache, source, size, dpi);
+
+      if (!atlas)
+      {
+         if (!(atlas = renderAtlas(name, size, dpi)))
+            return {};
+
+         writeAtlas(cache, source, dpi, atlas);
+      }
+
+      return fonts[key] = Font(atlas.size, atlas.quads, Texture::createTexture(GL_RGBA, atlas.texture.data(), atlas.texture.size() * sizeof(Rgba), atlas.width, atlas.size));
+   }
+
+   Atlas readAtlas(const std::string &cache, const struct stat &source, int size, int dpi) const
+   {
+      Atlas atlas;
+      AtlasHeader header {};
+
+      if (FILE *fd = fopen(cache.c_str(), "rb"))
+      {
+         if (fread(&header, sizeof(header), 1, fd) == 1 &&
+             memcmp(header.magic, AtlasMagic, sizeof(AtlasMagic)) == 0 &&
+             header.version == AtlasVersion &&
+             header.quadSize == sizeof(Quad) &&
+             header.sourceSize == (long long) source.st_size &&
+             header.sourceTime == (long long) source.st_mtime &&
+             header.size == size &&
+             header.dpi == dpi)
+         {
+            atlas.size = header.size;
+            atlas.width = header.width;
+            atlas.height = header.height;
+            atlas.quads.resize(header.quads);
+            atlas.texture.resize(header.width * header.height);
+
+            if (fread(atlas.quads.data(), sizeof(Quad), atlas.quads.size(), fd) != atlas.quads.size() ||
+                fread(atlas.texture.data(), sizeof(Rgba), atlas.texture.size(), fd) != atlas.texture.size())
+            {
+               log.warn("discard truncated glyph cache {}", {cache});
+
+               atlas = {};
+            }
+            else
+            {
+               log.debug("loaded font atlas from cache {}, {} glyphs", {cache, (int) atlas.quads.size()});
+            }
+         }
+
+         fclose(fd);
+      }
+
+      return atlas;
    }
 
-   Font loadFont(const std::string &name, int size, int dpi) const
+   void writeAtlas(const std::string &cache, const struct stat &source, int dpi, const Atlas &atlas) const
+   {
+      AtlasHeader header {};
+
+      memcpy(header.magic, AtlasMagic, sizeof(AtlasMagic));
+
+      header.version = AtlasVersion;
+      header.quadSize = sizeof(Quad);
+      header.sourceSize = source.st_size;
+      header.sourceTime = source.st_mtime;
+      header.size = atlas.size;
+      header.dpi = dpi;
+      header.width = atlas.width;
+      header.height = atlas.height;
+      header.quads = atlas.quads.size();
+
+      // write to temporary file and rename to avoid partial caches from concurrent launches
+      std::string temp = cache + ".tmp";
+
+      if (FILE *fd = fopen(temp.c_str(), "wb"))
+      {
+         bool done = fwrite(&header, sizeof(header), 1, fd) == 1 &&
+                     fwrite(atlas.quads.data(), sizeof(Quad), atlas.quads.size(), fd) == atlas.quads.size() &&
+                     fwrite(atlas.texture.data(), sizeof(Rgba), atlas.texture.size(), fd) == atlas.texture.size();
+
+         fclose(fd);
+
+         // rename do not replace existing files in windows
+         remove(cache.c_str());
+
+         if (!done || rename(temp.c_str(), cache.c_str()) != 0)
+         {
+            log.warn("unable to write glyph cache {}", {cache});
+
+            remove(temp.c_str());
+         }
+      }
+   }
+
+   Atlas renderAtlas(const std::string &name, int size, int dpi) const
    {
       FT_Library ft;
 
@@ -381,14 +520,18 @@ struct FreeTypeImpl
             FT_Done_Face(face);
             FT_Done_FreeType(ft);
 
-            // font characters
-            std::vector<Quad> quads;
+            // packed font atlas
+            Atlas atlas;
+
+            atlas.size = size;
+            atlas.width = width;
+            atlas.height = height;
 
             // texture buffer
-            Rgba texture[width * height];
+            auto &texture = atlas.texture;
 
             // clear texture buffer
-            memset(texture, 0, sizeof(texture));
+            texture.resize(width * height, Rgba {0, 0, 0, 0});
 
             // texture character position
             int position = 0;
@@ -405,7 +548,7 @@ struct FreeTypeImpl
                }
 
                // add character to quad vector
-               quads.push_back({
+               atlas.quads.push_back({
                                      .ch = character->ch,
 
                                      // texture coordinates
@@ -429,7 +572,7 @@ struct FreeTypeImpl
                position += padding + character->width + character->advance;
             }
 
-            return Font(size, quads, Texture::createTexture(GL_RGBA, texture, sizeof(texture), width, size));
+            return atlas;
          }
          else
          {
@@ -52,6 +52,14 @@ AxisWidget::AxisWidget() : widget(new Impl)
                       {{0,  0,  1},  {c, c, c, 1}}};
 
    widget->vertex = Buffer::createArrayBuffer(sizeof(vertex), vertex, sizeof(vertex) / sizeof(Vertex), sizeof(Vertex));
+
+   addDrawItem<GeometryShader>([this](Device *device, GeometryShader *shader) {
+      shader->setMatrixBlock(*this);
+      shader->setLineThickness(1.0f);
+      shader->setVertexPoints(widget->vertex, offsetof(Vertex, point));
+      shader->setVertexColors(widget->vertex, offsetof(Vertex, color));
+      shader->drawLines(widget->vertex.elements());
+   });
 }
 
 AxisWidget::~AxisWidget()
@@ -59,16 +67,4 @@ AxisWidget::~AxisWidget()
    delete widget;
 }
 
-void AxisWidget::draw(Device *device, Program *shader) const
-{
-   if (auto geometryShader = dynamic_cast<GeometryShader *>(shader))
-   {
-      geometryShader->setMatrixBlock(*this);
-      geometryShader->setLineThickness(1.0f);
-      geometryShader->setVertexPoints(widget->vertex, offsetof(Vertex, point));
-      geometryShader->setVertexColors(widget->vertex, offsetof(Vertex, color));
-      geometryShader->drawLines(widget->vertex.elements());
-   }
-}
-
 }
\ No newline at end of file
@@ -71,6 +71,13 @@ BoxWidget::BoxWidget(Color color) : widget(new Impl)
 
    widget->vertex = Buffer::createArrayBuffer(sizeof(vertex), vertex, sizeof(vertex) / sizeof(Vertex), sizeof(Vertex));
    widget->index = Buffer::createElementBuffer(sizeof(index), index, sizeof(index) / sizeof(unsigned int), sizeof(unsigned int));
+
+   addDrawItem<GeometryShader>([this](Device *device, GeometryShader *shader) {
+      shader->setMatrixBlock(*this);
+      shader->setVertexPoints(widget->vertex, offsetof(Vertex, point));
+      shader->setVertexColors(widget->vertex, offsetof(Vertex, color));
+      shader->drawTriangles(widget->index, widget->index.elements());
+   });
 }
 
 BoxWidget::~BoxWidget()
@@ -78,15 +85,4 @@ BoxWidget::~BoxWidget()
    delete widget;
 }
 
-void BoxWidget::draw(Device *device, Program *shader) const
-{
-   if (auto geometryShader = dynamic_cast<GeometryShader *>(shader))
-   {
-      geometryShader->setMatrixBlock(*this);
-      geometryShader->setVertexPoints(widget->vertex, offsetof(Vertex, point));
-      geometryShader->setVertexColors(widget->vertex, offsetof(Vertex, color));
-      geometryShader->drawTriangles(widget->index, widget->index.elements());
-   }
-}
-
 }
\ No newline at end of file
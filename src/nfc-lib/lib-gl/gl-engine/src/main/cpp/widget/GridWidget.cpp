@@ -114,31 +114,27 @@ GridWidget::GridWidget(float z, float width, float height, int vdiv, int hdiv) :
    widget->borderColors = Buffer::createArrayBuffer(sizeof(colors), colors, sizeof(colors) / (4 * sizeof(float)));
    widget->gridCoords = Buffer::createArrayBuffer(sizeof(gridLines), gridLines, sizeof(gridLines) / (3 * sizeof(float)));
    widget->gridColors = Buffer::createArrayBuffer(sizeof(gridColor), gridColor, sizeof(gridColor) / (4 * sizeof(float)));
-}
 
-GridWidget::~GridWidget()
-{
-   delete widget;
-}
-
-void GridWidget::draw(Device *device, Program *shader) const
-{
-   if (auto geometryShader = dynamic_cast<GeometryShader *>(shader))
-   {
-      geometryShader->setMatrixBlock(*this);
+   addDrawItem<GeometryShader>([this](Device *device, GeometryShader *shader) {
+      shader->setMatrixBlock(*this);
 
       // divisiones
-      geometryShader->setLineThickness(1.0f);
-      geometryShader->setVertexPoints(widget->gridCoords);
-      geometryShader->setVertexColors(widget->gridColors);
-      geometryShader->drawLines(widget->gridCoords.elements());
+      shader->setLineThickness(1.0f);
+      shader->setVertexPoints(widget->gridCoords);
+      shader->setVertexColors(widget->gridColors);
+      shader->drawLines(widget->gridCoords.elements());
 
       // marco
-      geometryShader->setLineThickness(2.0f);
-      geometryShader->setVertexPoints(widget->borderCoords);
-      geometryShader->setVertexColors(widget->borderColors);
-      geometryShader->drawLineLoop(widget->borderCoords.elements());
-   }
+      shader->setLineThickness(2.0f);
+      shader->setVertexPoints(widget->borderCoords);
+      shader->setVertexColors(widget->borderColors);
+      shader->drawLineLoop(widget->borderCoords.elements());
+   });
+}
+
+GridWidget::~GridWidget()
+{
+   delete widget;
 }
 
 }
\ No newline at end of file
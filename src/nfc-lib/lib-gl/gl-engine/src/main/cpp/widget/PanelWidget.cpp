@@ -50,6 +50,13 @@ PanelWidget::PanelWidget(float width, float height, Color color) : widget(new Im
 
    widget->vertex = Buffer::createArrayBuffer(sizeof(vertex), vertex, sizeof(vertex) / sizeof(Vertex), sizeof(Vertex));
    widget->index = Buffer::createElementBuffer(sizeof(index), index, sizeof(index) / sizeof(unsigned int), sizeof(unsigned int));
+
+   addDrawItem<GeometryShader>([this](Device *device, GeometryShader *shader) {
+      shader->setMatrixBlock(*this);
+      shader->setVertexPoints(widget->vertex, offsetof(Vertex, point));
+      shader->setVertexColors(widget->vertex, offsetof(Vertex, color));
+      shader->drawTriangles(widget->index, widget->index.elements());
+   });
 }
 
 PanelWidget::~PanelWidget()
@@ -57,15 +64,4 @@ PanelWidget::~PanelWidget()
    delete widget;
 }
 
-void PanelWidget::draw(Device *device, Program *shader) const
-{
-   if (auto geometryShader = dynamic_cast<GeometryShader *>(shader))
-   {
-      geometryShader->setMatrixBlock(*this);
-      geometryShader->setVertexPoints(widget->vertex, offsetof(Vertex, point));
-      geometryShader->setVertexColors(widget->vertex, offsetof(Vertex, color));
-      geometryShader->drawTriangles(widget->index, widget->index.elements());
-   }
-}
-
 }
\ No newline at end of file
@@ -56,6 +56,16 @@ QuadWidget::QuadWidget(const Texture &texture) : widget(new Impl)
    widget->texture = texture;
    widget->vertex = Buffer::createArrayBuffer(sizeof(vertex), vertex, sizeof(vertex) / sizeof(Vertex), sizeof(Vertex));
    widget->index = Buffer::createElementBuffer(sizeof(index), index, sizeof(index) / sizeof(unsigned int));
+
+   addDrawItem<TextureShader>([this](Device *device, TextureShader *shader) {
+      widget->texture.bind(0);
+
+      shader->setMatrixBlock(*this);
+      shader->setObjectColor({1.0, 1.0, 1.0, 1.0});
+      shader->setVertexPoints(widget->vertex, offsetof(Vertex, point));
+      shader->setVertexTexels(widget->vertex, offsetof(Vertex, texel));
+      shader->drawTriangles(widget->index, widget->index.elements());
+   });
 }
 
 QuadWidget::~QuadWidget()
@@ -63,18 +73,4 @@ QuadWidget::~QuadWidget()
    delete widget;
 }
 
-void QuadWidget::draw(Device *device, Program *shader) const
-{
-   if (auto textureShader = dynamic_cast<TextureShader *>(shader))
-   {
-      widget->texture.bind(0);
-
-      textureShader->setMatrixBlock(*this);
-      textureShader->setObjectColor({1.0, 1.0, 1.0, 1.0});
-      textureShader->setVertexPoints(widget->vertex, offsetof(Vertex, point));
-      textureShader->setVertexTexels(widget->vertex, offsetof(Vertex, texel));
-      textureShader->drawTriangles(widget->index, widget->index.elements());
-   }
-}
-
 }
\ No newline at end of file
@@ -65,6 +65,27 @@ TextWidget::TextWidget(const Font &font, const std::string &text, float scale) :
    widget->scale = scale;
 
    setText(text);
+
+   addDrawItem<FontShader>([this](Device *device, FontShader *shader) {
+      widget->font.bind(0);
+
+      shader->setMatrixBlock(*this);
+
+      shader->setFontColor(widget->fontColor);
+      shader->setFontSmooth(widget->fontSmooth);
+
+      shader->setShadowColor(widget->shadowColor);
+      shader->setShadowOffset(widget->shadowOffset);
+      shader->setShadowSmooth(widget->shadowSmooth);
+
+      shader->setStrokeColor(widget->strokeColor);
+      shader->setStrokeWidth(widget->strokeWidth);
+
+      shader->setVertexPoints(widget->quadVertex);
+      shader->setVertexTexels(widget->quadTexels);
+
+      shader->drawTriangles(widget->quadIndex, widget->quadIndex.elements());
+   });
 }
 
 TextWidget::~TextWidget()
@@ -201,29 +222,4 @@ void TextWidget::setText(const std::string &text)
 //   widget->quadIndex = Buffer::createElementBuffer(sizeof(index), index, sizeof(index) / sizeof(unsigned int));
 }
 
-void TextWidget::draw(Device *device, Program *shader) const
-{
-   if (auto fontShader = dynamic_cast<FontShader *>(shader))
-   {
-      widget->font.bind(0);
-
-      fontShader->setMatrixBlock(*this);
-
-      fontShader->setFontColor(widget->fontColor);
-      fontShader->setFontSmooth(widget->fontSmooth);
-
-      fontShader->setShadowColor(widget->shadowColor);
-      fontShader->setShadowOffset(widget->shadowOffset);
-      fontShader->setShadowSmooth(widget->shadowSmooth);
-
-      fontShader->setStrokeColor(widget->strokeColor);
-      fontShader->setStrokeWidth(widget->strokeWidth);
-
-      fontShader->setVertexPoints(widget->quadVertex);
-      fontShader->setVertexTexels(widget->quadTexels);
-
-      fontShader->drawTriangles(widget->quadIndex, widget->quadIndex.elements());
-   }
-}
-
 }
\ No newline at end of file
@@ -55,6 +55,8 @@ class Buffer
 
       unsigned int stride() const;
 
+      void *memory() const;
+
       Buffer release();
 
       Buffer bind(int index) const;
@@ -69,6 +71,8 @@ class Buffer
 
       static Buffer createUniformBuffer(unsigned int size, const void *data = nullptr, unsigned int elements = 0, unsigned int stride = 0);
 
+      static Buffer createStreamBuffer(unsigned int size, unsigned int elements = 0, unsigned int stride = 0);
+
    private:
 
       explicit Buffer(struct Impl *impl);
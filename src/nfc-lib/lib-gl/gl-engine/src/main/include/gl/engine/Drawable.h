@@ -25,11 +25,25 @@
 #ifndef UI_GL_DRAWABLE_H
 #define UI_GL_DRAWABLE_H
 
+#include <functional>
+
 namespace gl {
 
 class Device;
 class Program;
 
+/*
+ * draw command for one shader program type, registered once and dispatched by render queue
+ */
+struct DrawItem
+{
+   // shader program filter, evaluated only when render queue is rebuilt
+   std::function<bool(const Program *)> accept;
+
+   // draw command, called only with accepted programs
+   std::function<void(Device *, Program *)> draw;
+};
+
 class Drawable
 {
    public:
@@ -71,6 +71,8 @@ class Engine
 
       virtual void update(float time, float delta);
 
+      bool isAnimated() const;
+
       virtual void dispose();
 
    private:
@@ -96,6 +96,29 @@ class Model : public Drawable
 
       void dispose();
 
+      const std::vector<DrawItem> &drawItems() const;
+
+      static unsigned int revision();
+
+      unsigned int generation() const;
+
+      static unsigned int changes();
+
+      bool isAnimated() const;
+
+   protected:
+
+      Model *touch();
+
+      template<typename T>
+      Model *addDrawItem(const std::function<void(Device *, T *)> &handler)
+      {
+         return addDrawItem({[](const Program *shader) { return dynamic_cast<const T *>(shader) != nullptr; },
+                             [handler](Device *device, Program *shader) { handler(device, static_cast<T *>(shader)); }});
+      }
+
+      Model *addDrawItem(const DrawItem &item);
+
    private:
 
       bool isDirty() const;
@@ -0,0 +1,62 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+#ifndef UI_GL_RENDERQUEUE_H
+#define UI_GL_RENDERQUEUE_H
+
+#include <memory>
+#include <vector>
+
+#include <gl/engine/Drawable.h>
+
+namespace gl {
+
+class Model;
+
+class RenderQueue
+{
+      struct Impl;
+
+   public:
+
+      RenderQueue();
+
+      bool isValid(const std::vector<Program *> &programs) const;
+
+      void build(Model *root, const std::vector<Program *> &programs);
+
+      bool isEmpty(int bucket) const;
+
+      void render(Device *device, Program *program, int bucket) const;
+
+      void clear();
+
+   private:
+
+      std::shared_ptr<Impl> self;
+};
+
+}
+
+#endif //UI_GL_RENDERQUEUE_H
\ No newline at end of file
@@ -0,0 +1,75 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+#ifndef UI_GL_STREAMBUFFER_H
+#define UI_GL_STREAMBUFFER_H
+
+#include <memory>
+
+#include <gl/engine/Buffer.h>
+
+namespace gl {
+
+/*
+ * ring of vertex buffers written by one producer thread and consumed by render thread, each region is
+ * persistent mapped when supported, otherwise staged in host memory and uploaded by orphaning
+ */
+class StreamBuffer
+{
+      struct Impl;
+
+   public:
+
+      StreamBuffer();
+
+      bool valid() const;
+
+      unsigned int size() const;
+
+      unsigned int length() const;
+
+      void *map();
+
+      void unmap(unsigned int length);
+
+      bool acquire();
+
+      Buffer current() const;
+
+      void fence();
+
+      static StreamBuffer createArrayBuffer(unsigned int size, unsigned int elements = 0, unsigned int stride = 0, int regions = 3);
+
+   private:
+
+      explicit StreamBuffer(struct Impl *impl);
+
+   private:
+
+      std::shared_ptr<Impl> self;
+};
+
+}
+
+#endif //UI_GL_STREAMBUFFER_H
\ No newline at end of file
@@ -39,8 +39,6 @@ class AxisWidget : public Widget
 
       ~AxisWidget() override;
 
-      void draw(Device *device, Program *shader) const override;
-
    private:
 
       Impl *widget;
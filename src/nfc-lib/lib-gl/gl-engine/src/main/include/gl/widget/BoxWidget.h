@@ -40,8 +40,6 @@ class BoxWidget : public Widget
 
       ~BoxWidget() override;
 
-      void draw(Device *device, Program *shader) const override;
-
    private:
 
       Impl *widget;
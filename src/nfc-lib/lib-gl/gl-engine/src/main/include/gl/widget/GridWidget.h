@@ -39,8 +39,6 @@ class GridWidget : public Widget
 
       ~GridWidget() override;
 
-      void draw(Device *device, Program *shader) const override;
-
    private:
 
       Impl *widget;
@@ -40,8 +40,6 @@ class PanelWidget : public Widget
 
       ~PanelWidget() override;
 
-      void draw(Device *device, Program *shader) const override;
-
    private:
 
       Impl *widget;
@@ -41,8 +41,6 @@ class QuadWidget : public Widget
 
       ~QuadWidget() override;
 
-      void draw(Device *device, Program *shader) const override;
-
    private:
 
       Impl *widget;
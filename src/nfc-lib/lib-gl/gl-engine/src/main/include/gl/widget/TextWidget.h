@@ -57,8 +57,6 @@ class TextWidget : public Widget
 
       void setStrokeWidth(float strokeWidth);
 
-      void draw(Device *device, Program *shader) const override;
-
    private:
 
       Impl *widget;
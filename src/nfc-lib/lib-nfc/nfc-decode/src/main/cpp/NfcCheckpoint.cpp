@@ -0,0 +1,216 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+#include <rt/Logger.h>
+
+#include <nfc/NfcCheckpoint.h>
+
+namespace nfc {
+
+struct EntryHeader
+{
+   long long offset; // stream sample offset
+   unsigned int length; // snapshot length in bytes
+};
+
+struct NfcCheckpoint::Impl
+{
+   rt::Logger log {"NfcCheckpoint"};
+
+   // checkpoint file signature
+   static constexpr char magic[4] = {'N', 'F', 'C', 'K'};
+
+   std::string name;
+
+   std::fstream file;
+
+   // snapshot index, stream offset and file position for each entry
+   std::vector<std::pair<long long, std::streamoff>> index;
+
+   explicit Impl(std::string name) : name(std::move(name))
+   {
+   }
+
+   ~Impl()
+   {
+      close();
+   }
+
+   bool open(OpenMode mode)
+   {
+      close();
+
+      index.clear();
+
+      if (mode == Write)
+      {
+         file.open(name, std::ios::out | std::ios::binary | std::ios::trunc);
+
+         if (file.is_open())
+            file.write(magic, sizeof(magic));
+      }
+      else
+      {
+         file.open(name, std::ios::in | std::ios::binary);
+
+         if (file.is_open() && !readIndex())
+         {
+            log.warn("invalid checkpoint file [{}]", {name});
+
+            file.close();
+         }
+      }
+
+      return file.is_open();
+   }
+
+   void close()
+   {
+      if (file.is_open())
+         file.close();
+   }
+
+   bool readIndex()
+   {
+      char header[sizeof(magic)];
+
+      if (!file.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0)
+         return false;
+
+      // file size to detect truncated entries
+      file.seekg(0, std::ios::end);
+
+      std::streamoff size = file.tellg();
+
+      file.seekg(sizeof(magic));
+
+      EntryHeader entry {};
+
+      while (file.read(reinterpret_cast<char *>(&entry), sizeof(EntryHeader)))
+      {
+         std::streamoff position = file.tellg();
+
+         // discard last entry if recording was interrupted while writing
+         if (position + std::streamoff(entry.length) > size)
+            break;
+
+         index.emplace_back(entry.offset, position);
+
+         file.seekg(entry.length, std::ios::cur);
+      }
+
+      log.info("loaded {} checkpoints from [{}]", {(int) index.size(), name});
+
+      return true;
+   }
+
+   bool write(long long offset, const rt::ByteBuffer &status)
+   {
+      if (!file.is_open())
+         return false;
+
+      EntryHeader entry {offset, status.available()};
+
+      file.write(reinterpret_cast<const char *>(&entry), sizeof(EntryHeader));
+
+      index.emplace_back(offset, file.tellp());
+
+      file.write(reinterpret_cast<const char *>(status.begin()), status.available());
+
+      return file.good();
+   }
+
+   rt::ByteBuffer find(long long offset, long long *found)
+   {
+      // entries are written in stream order, find last one not after requested offset
+      auto it = std::upper_bound(index.begin(), index.end(), offset, [](long long value, const std::pair<long long, std::streamoff> &entry) {
+         return value < entry.first;
+      });
+
+      if (it == index.begin() || !file.is_open())
+         return {};
+
+      --it;
+
+      EntryHeader entry {};
+
+      file.clear();
+      file.seekg(it->second - std::streamoff(sizeof(EntryHeader)));
+
+      if (!file.read(reinterpret_cast<char *>(&entry), sizeof(EntryHeader)))
+         return {};
+
+      rt::ByteBuffer status(entry.length);
+
+      if (!file.read(reinterpret_cast<char *>(status.data()), entry.length))
+         return {};
+
+      if (found)
+         *found = entry.offset;
+
+      return status;
+   }
+};
+
+NfcCheckpoint::NfcCheckpoint(const std::string &name) : impl(std::make_shared<Impl>(name))
+{
+}
+
+bool NfcCheckpoint::open(OpenMode mode)
+{
+   return impl->open(mode);
+}
+
+void NfcCheckpoint::close()
+{
+   impl->close();
+}
+
+bool NfcCheckpoint::isOpen() const
+{
+   return impl->file.is_open();
+}
+
+int NfcCheckpoint::count() const
+{
+   return impl->index.size();
+}
+
+bool NfcCheckpoint::write(long long offset, const rt::ByteBuffer &status)
+{
+   return impl->write(offset, status);
+}
+
+rt::ByteBuffer NfcCheckpoint::find(long long offset, long long *found)
+{
+   return impl->find(offset, found);
+}
+
+}
\ No newline at end of file
@@ -22,6 +22,9 @@
 
 */
 
+#include <array>
+#include <utility>
+
 #include <rt/Logger.h>
 
 #include <nfc/Nfc.h>
@@ -32,6 +35,10 @@
 #include <tech/NfcF.h>
 #include <tech/NfcV.h>
 
+// decoder status snapshot format
+#define STATUS_MAGIC 0x5346434E
+#define STATUS_VERSION 2
+
 namespace nfc {
 
 struct NfcDecoder::Impl
@@ -43,9 +50,15 @@ struct NfcDecoder::Impl
    static constexpr int ENABLED_NFCF = 1 << 2;
    static constexpr int ENABLED_NFCV = 1 << 3;
 
+   // decoder pipeline, one instantiation for each combination of enabled techs
+   typedef void (Impl::*Pipeline)(sdr::SignalBuffer &signal, std::list<NfcFrame> &frames);
+
    // all tech enabled by default
    int enabledTech = ENABLED_NFCA | ENABLED_NFCB | ENABLED_NFCF | ENABLED_NFCV;
 
+   // pipeline for current enabled techs
+   Pipeline pipeline;
+
    // NFC-A Decoder
    struct NfcA nfca;
 
@@ -61,12 +74,39 @@ struct NfcDecoder::Impl
    // global decoder status
    struct DecoderStatus decoder;
 
+   // signal envelope kernel
+   int envelopeKernel = NfcDecoder::Exact;
+
+   // signal magnitude for IQ sample buffers
+   sdr::SignalBuffer magnitude;
+
+   // expected stream index of next sample buffer, -1 if unknown
+   long long streamOffset = -1;
+
    Impl();
 
    inline void configure(long sampleRate);
 
+   inline void resync(long long gap);
+
+   inline rt::ByteBuffer saveStatus() const;
+
+   inline bool loadStatus(const rt::ByteBuffer &status);
+
    inline std::list<NfcFrame> nextFrames(sdr::SignalBuffer &samples);
 
+   inline void enableTech(int tech, bool enabled);
+
+   template<int TECH>
+   inline void decodeSignal(sdr::SignalBuffer &signal, std::list<NfcFrame> &frames);
+
+   template<std::size_t... TECH>
+   static constexpr std::array<Pipeline, sizeof...(TECH)> pipelineTable(std::index_sequence<TECH...>);
+
+   static Pipeline selectPipeline(int enabledTech);
+
+   inline sdr::SignalBuffer &signalMagnitude(const sdr::SignalBuffer &samples);
+
    inline void detectCarrier(std::list<NfcFrame> &frames);
 };
 
@@ -81,34 +121,22 @@ std::list<NfcFrame> NfcDecoder::nextFrames(sdr::SignalBuffer samples)
 
 void NfcDecoder::setEnableNfcA(bool enabled)
 {
-   if (enabled)
-      impl->enabledTech |= Impl::ENABLED_NFCA;
-   else
-      impl->enabledTech &= ~Impl::ENABLED_NFCA;
+   impl->enableTech(Impl::ENABLED_NFCA, enabled);
 }
 
 void NfcDecoder::setEnableNfcB(bool enabled)
 {
-   if (enabled)
-      impl->enabledTech |= Impl::ENABLED_NFCB;
-   else
-      impl->enabledTech &= ~Impl::ENABLED_NFCB;
+   impl->enableTech(Impl::ENABLED_NFCB, enabled);
 }
 
 void NfcDecoder::setEnableNfcF(bool enabled)
 {
-   if (enabled)
-      impl->enabledTech |= Impl::ENABLED_NFCF;
-   else
-      impl->enabledTech &= ~Impl::ENABLED_NFCF;
+   impl->enableTech(Impl::ENABLED_NFCF, enabled);
 }
 
 void NfcDecoder::setEnableNfcV(bool enabled)
 {
-   if (enabled)
-      impl->enabledTech |= Impl::ENABLED_NFCV;
-   else
-      impl->enabledTech &= ~Impl::ENABLED_NFCV;
+   impl->enableTech(Impl::ENABLED_NFCV, enabled);
 }
 
 void NfcDecoder::setSampleRate(long sampleRate)
@@ -121,6 +149,29 @@ void NfcDecoder::setPowerLevelThreshold(float value)
    impl->decoder.powerLevelThreshold = value;
 }
 
+void NfcDecoder::setEnvelopeKernel(int kernel)
+{
+   if (kernel != Exact && kernel != AlphaMaxBetaMin)
+   {
+      impl->log.warn("unsupported envelope kernel {}", {kernel});
+      return;
+   }
+
+   impl->envelopeKernel = kernel;
+}
+
+void NfcDecoder::setEnvelopeKernel(const std::string &name)
+{
+   if (name == "exact")
+      setEnvelopeKernel(Exact);
+
+   else if (name == "alphaMaxBetaMin")
+      setEnvelopeKernel(AlphaMaxBetaMin);
+
+   else
+      impl->log.warn("unsupported envelope kernel {}", {name});
+}
+
 void NfcDecoder::setModulationThresholdNfcA(float min, float max)
 {
    impl->nfca.setModulationThreshold(min, max);
@@ -146,13 +197,62 @@ float NfcDecoder::powerLevelThreshold() const
    return impl->decoder.powerLevelThreshold;
 }
 
+int NfcDecoder::envelopeKernel() const
+{
+   return impl->envelopeKernel;
+}
+
 float NfcDecoder::signalStrength() const
 {
    return impl->decoder.signalStatus.signalAverg;
 }
 
-NfcDecoder::Impl::Impl() : nfca(&decoder), nfcb(&decoder), nfcf(&decoder), nfcv(&decoder)
+long long NfcDecoder::streamOffset() const
+{
+   return impl->streamOffset;
+}
+
+rt::ByteBuffer NfcDecoder::saveStatus() const
+{
+   return impl->saveStatus();
+}
+
+bool NfcDecoder::loadStatus(const rt::ByteBuffer &status)
 {
+   return impl->loadStatus(status);
+}
+
+NfcDecoder::Impl::Impl() : pipeline(selectPipeline(enabledTech)), nfca(&decoder), nfcb(&decoder), nfcf(&decoder), nfcv(&decoder)
+{
+}
+
+/**
+ * Enable or disable one tech and select matching pipeline
+ */
+void NfcDecoder::Impl::enableTech(int tech, bool enabled)
+{
+   if (enabled)
+      enabledTech |= tech;
+   else
+      enabledTech &= ~tech;
+
+   pipeline = selectPipeline(enabledTech);
+}
+
+/**
+ * Build pipeline table indexed by enabled tech mask
+ */
+template<std::size_t... TECH>
+constexpr std::array<NfcDecoder::Impl::Pipeline, sizeof...(TECH)> NfcDecoder::Impl::pipelineTable(std::index_sequence<TECH...>)
+{
+   return {&Impl::decodeSignal<TECH>...};
+}
+
+NfcDecoder::Impl::Pipeline NfcDecoder::Impl::selectPipeline(int enabledTech)
+{
+   static constexpr auto pipelines = pipelineTable(std::make_index_sequence<16>());
+
+   return pipelines[enabledTech & 0xf];
 }
 
 /**
@@ -197,6 +297,9 @@ void NfcDecoder::Impl::configure(long newSampleRate)
       decoder.signalParams.signalEdge1W0 = float(1 - 3E6 / decoder.sampleRate);
       decoder.signalParams.signalEdge1W1 = float(1 - decoder.signalParams.signalEdge1W0);
 
+      // clear shared correlator bank, registered again by each tech
+      decoder.correlator = {};
+
       // configure NFC-A decoder
       if (enabledTech & ENABLED_NFCA)
          nfca.configure(newSampleRate);
@@ -232,79 +335,280 @@ void NfcDecoder::Impl::configure(long newSampleRate)
 
    // starts without modulation
    decoder.modulation = nullptr;
+
+   // starts without stream position
+   streamOffset = -1;
 }
 
 /**
- * Extract next frames
+ * Resynchronize after discontinuity in sample stream, frames in progress are discarded and signal clock is moved over
+ * lost samples so following frames keep their absolute timing
  */
-std::list<NfcFrame> NfcDecoder::Impl::nextFrames(sdr::SignalBuffer &samples)
+void NfcDecoder::Impl::resync(long long gap)
 {
-   // detected frames
-   std::list<NfcFrame> frames;
+   if (gap > 0)
+      log.warn("{} samples lost at clock {}, resynchronizing decoder", {gap, decoder.signalClock});
+   else
+      log.warn("sample stream restarted at clock {}, resynchronizing decoder", {decoder.signalClock});
 
-   // only process valid sample buffer
-   if (samples.isValid())
+   // keep carrier detector status
+   unsigned long long carrierOn = decoder.signalStatus.carrierOn;
+   unsigned long long carrierOff = decoder.signalStatus.carrierOff;
+
+   // signal history is not valid across gap
+   decoder.signalStatus = {0,};
+   decoder.signalStatus.carrierOn = carrierOn;
+   decoder.signalStatus.carrierOff = carrierOff;
+
+   // discard modulation and frames in progress
+   nfca.reset();
+   nfcb.reset();
+   nfcf.reset();
+   nfcv.reset();
+
+   // move master clock over lost samples
+   if (gap > 0)
+      decoder.signalClock += gap;
+}
+
+/**
+ * Store full decoder status, structure sizes are included so snapshots from incompatible builds are rejected
+ */
+rt::ByteBuffer NfcDecoder::Impl::saveStatus() const
+{
+   StatusSnapshot snapshot;
+
+   // snapshot header
+   snapshot.save(STATUS_MAGIC);
+   snapshot.save(STATUS_VERSION);
+   snapshot.save(sizeof(SignalStatus));
+   snapshot.save(sizeof(ModulationStatus));
+
+   // decoder configuration
+   snapshot.save(decoder.sampleRate);
+   snapshot.save(enabledTech);
+   snapshot.save(envelopeKernel);
+   snapshot.save(decoder.powerLevelThreshold);
+
+   // signal processing status
+   snapshot.save(streamOffset);
+   snapshot.save(decoder.signalClock);
+   snapshot.save(decoder.signalStatus);
+   snapshot.save(decoder.correlator.clock);
+
+   // tech status
+   nfca.saveStatus(snapshot);
+   nfcb.saveStatus(snapshot);
+   nfcf.saveStatus(snapshot);
+   nfcv.saveStatus(snapshot);
+
+   return rt::ByteBuffer(snapshot.data.data(), int(snapshot.data.size()));
+}
+
+/**
+ * Restore decoder status, decoder is configured first to rebuild timing parameters and shared correlator bank
+ */
+bool NfcDecoder::Impl::loadStatus(const rt::ByteBuffer &status)
+{
+   StatusSnapshot snapshot;
+
+   int magic = 0;
+   int version = 0;
+   std::size_t signalSize = 0;
+   std::size_t modulationSize = 0;
+   unsigned int sampleRate = 0;
+   int techs = 0;
+   int kernel = 0;
+   float powerLevel = 0;
+
+   snapshot.data.assign(status.begin(), status.end());
+
+   snapshot.load(magic);
+   snapshot.load(version);
+   snapshot.load(signalSize);
+   snapshot.load(modulationSize);
+
+   if (magic != STATUS_MAGIC || version != STATUS_VERSION || signalSize != sizeof(SignalStatus) || modulationSize != sizeof(ModulationStatus))
    {
-      // re-configure decoder parameters on sample rate changes
-      if (decoder.sampleRate != samples.sampleRate())
-      {
-         configure(samples.sampleRate());
-      }
+      log.warn("invalid decoder status snapshot");
+      return false;
+   }
 
-#ifdef DEBUG_SIGNAL
-      decoder.debug->begin(samples.elements());
-#endif
+   snapshot.load(sampleRate);
+   snapshot.load(techs);
+   snapshot.load(kernel);
+   snapshot.load(powerLevel);
+
+   // same kernels accepted by setEnvelopeKernel
+   if (kernel != NfcDecoder::Exact && kernel != NfcDecoder::AlphaMaxBetaMin)
+   {
+      log.warn("invalid envelope kernel {} in decoder status snapshot", {kernel});
+      return false;
+   }
+
+   envelopeKernel = kernel;
+   decoder.powerLevelThreshold = powerLevel;
+
+   // correlator bank ownership depends on enabled techs
+   enabledTech = techs;
+   pipeline = selectPipeline(enabledTech);
+
+   configure(sampleRate);
+
+   snapshot.load(streamOffset);
+   snapshot.load(decoder.signalClock);
+   snapshot.load(decoder.signalStatus);
+   snapshot.load(decoder.correlator.clock);
+
+   // detected modulation is restored by owner tech
+   decoder.pulse = nullptr;
+
+   nfca.loadStatus(snapshot);
+   nfcb.loadStatus(snapshot);
+   nfcf.loadStatus(snapshot);
+   nfcv.loadStatus(snapshot);
+
+   if (!snapshot.valid)
+   {
+      log.warn("truncated decoder status snapshot, decoder reset");
+      configure(sampleRate);
+      return false;
+   }
 
-      do
+   log.info("decoder status restored at clock {}, stream offset {}", {decoder.signalClock, streamOffset});
+
+   return true;
+}
+
+/**
+ * Compute envelope of IQ samples with selected kernel, reusing buffer between calls
+ */
+sdr::SignalBuffer &NfcDecoder::Impl::signalMagnitude(const sdr::SignalBuffer &samples)
+{
+   unsigned int length = samples.available() / samples.stride();
+
+   if (magnitude.capacity() < length || magnitude.sampleRate() != samples.sampleRate())
+   {
+      magnitude = sdr::SignalBuffer(length, 1, samples.sampleRate(), samples.decimation());
+   }
+
+   magnitude.clear();
+
+   samples.magnitude(magnitude.pull(length), envelopeKernel);
+
+   magnitude.flip();
+
+   return magnitude;
+}
+
+/**
+ * Detect and decode frames, disabled techs are removed from per-sample detection loop at compile time
+ */
+template<int TECH>
+void NfcDecoder::Impl::decodeSignal(sdr::SignalBuffer &signal, std::list<NfcFrame> &frames)
+{
+   do
+   {
+      if (!decoder.modulation)
       {
-         if (!decoder.modulation)
+         // clear bitrate
+         decoder.bitrate = nullptr;
+
+         // NFC modulation detector for NFC-A / B / F / V
+         while (decoder.nextSample(signal))
          {
-            // clear bitrate
-            decoder.bitrate = nullptr;
+            // carrier detector
+            detectCarrier(frames);
 
-            // NFC modulation detector for NFC-A / B / F / V
-            while (decoder.nextSample(samples))
+            if constexpr ((TECH & ENABLED_NFCA) != 0)
             {
-               // carrier detector
-               detectCarrier(frames);
-
-               if ((enabledTech & ENABLED_NFCA) && nfca.detect())
+               if (nfca.detect())
                   break;
+            }
 
-               if ((enabledTech & ENABLED_NFCB) && nfcb.detect())
+            if constexpr ((TECH & ENABLED_NFCB) != 0)
+            {
+               if (nfcb.detect())
                   break;
+            }
 
-               if ((enabledTech & ENABLED_NFCF) && nfcf.detect())
+            if constexpr ((TECH & ENABLED_NFCF) != 0)
+            {
+               if (nfcf.detect())
                   break;
+            }
 
-               if ((enabledTech & ENABLED_NFCV) && nfcv.detect())
+            if constexpr ((TECH & ENABLED_NFCV) != 0)
+            {
+               if (nfcv.detect())
                   break;
             }
          }
+      }
 
-         if (decoder.bitrate)
+      // decode dispatch runs once per detected frame, all techs are kept so frames in progress are completed after disable
+      if (decoder.bitrate)
+      {
+         switch (decoder.bitrate->techType)
          {
-            switch (decoder.bitrate->techType)
-            {
-               case TechType::NfcA:
-                  nfca.decode(samples, frames);
-                  break;
+            case TechType::NfcA:
+               nfca.decode(signal, frames);
+               break;
 
-               case TechType::NfcB:
-                  nfcb.decode(samples, frames);
-                  break;
+            case TechType::NfcB:
+               nfcb.decode(signal, frames);
+               break;
 
-               case TechType::NfcF:
-                  nfcf.decode(samples, frames);
-                  break;
+            case TechType::NfcF:
+               nfcf.decode(signal, frames);
+               break;
 
-               case TechType::NfcV:
-                  nfcv.decode(samples, frames);
-                  break;
-            }
+            case TechType::NfcV:
+               nfcv.decode(signal, frames);
+               break;
          }
+      }
+
+   } while (!signal.isEmpty());
+}
+
+/**
+ * Extract next frames
+ */
+std::list<NfcFrame> NfcDecoder::Impl::nextFrames(sdr::SignalBuffer &samples)
+{
+   // detected frames
+   std::list<NfcFrame> frames;
+
+   // only process valid sample buffer
+   if (samples.isValid())
+   {
+      // re-configure decoder parameters on sample rate changes
+      if (decoder.sampleRate != samples.sampleRate())
+      {
+         configure(samples.sampleRate());
+      }
+
+      // detect lost samples from stream index, decoder resynchronizes on gaps instead of shifting following frames
+      if (samples.sampleOffset() >= 0)
+      {
+         if (streamOffset >= 0 && samples.sampleOffset() != streamOffset)
+         {
+            resync(samples.sampleOffset() - streamOffset);
+         }
+
+         streamOffset = samples.sampleOffset() + samples.available() / samples.stride();
+      }
+
+      // IQ samples are reduced to envelope in one vectorized pass before detection
+      sdr::SignalBuffer &signal = samples.isComplex() ? signalMagnitude(samples) : samples;
+
+#ifdef DEBUG_SIGNAL
+      decoder.debug->begin(signal.elements());
+#endif
 
-      } while (!samples.isEmpty());
+      // specialized detection loop for enabled techs
+      (this->*pipeline)(signal, frames);
 
 #ifdef DEBUG_SIGNAL
       decoder.debug->write();
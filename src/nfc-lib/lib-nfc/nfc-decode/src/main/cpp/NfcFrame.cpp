@@ -34,8 +34,8 @@ struct NfcFrame::Impl
    unsigned int frameFlags = 0;
    unsigned int framePhase = 0;
    unsigned int frameRate = 0;
-   unsigned long sampleStart = 0;
-   unsigned long sampleEnd = 0;
+   unsigned long long sampleStart = 0;
+   unsigned long long sampleEnd = 0;
    double timeStart = 0;
    double timeEnd = 0;
 };
@@ -227,22 +227,22 @@ void NfcFrame::setTimeEnd(double end)
    impl->timeEnd = end;
 }
 
-unsigned long NfcFrame::sampleStart() const
+unsigned long long NfcFrame::sampleStart() const
 {
    return impl->sampleStart;
 }
 
-void NfcFrame::setSampleStart(unsigned long start)
+void NfcFrame::setSampleStart(unsigned long long start)
 {
    impl->sampleStart = start;
 }
 
-unsigned long NfcFrame::sampleEnd() const
+unsigned long long NfcFrame::sampleEnd() const
 {
    return impl->sampleEnd;
 }
 
-void NfcFrame::setSampleEnd(unsigned long end)
+void NfcFrame::setSampleEnd(unsigned long long end)
 {
    impl->sampleEnd = end;
 }
@@ -26,6 +26,10 @@
 #define NFC_NFCTECH_H
 
 #include <cmath>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <type_traits>
 
 #include <sdr/RecordDevice.h>
 
@@ -43,7 +47,7 @@
 
 namespace nfc {
 
-// Buffer length for signal integration, must be power of 2^n
+// Buffer capacity for signal integration, must be power of 2^n, rings only use the length needed for current sample rate
 #define BUFFER_SIZE 4096
 
 /*
@@ -52,7 +56,7 @@ namespace nfc {
 struct SignalDebug
 {
    unsigned int channels;
-   unsigned int clock;
+   unsigned long long clock;
 
    sdr::RecordDevice *recorder;
    sdr::SignalBuffer buffer;
@@ -79,7 +83,7 @@ struct SignalDebug
       delete recorder;
    }
 
-   inline void block(unsigned int time)
+   inline void block(unsigned long long time)
    {
       if (clock != time)
       {
@@ -150,6 +154,9 @@ struct SignalParams
 
    // maximum silence
    int silenceThreshold;
+
+   // signal buffers ring mask, covers longest delay of enabled techs
+   unsigned int signalBufferMask;
 };
 
 /*
@@ -209,7 +216,16 @@ struct SignalStatus
    float signalEdge0;
    float signalEdge1;
 
-   // signal data buffer
+   // silence start (no modulation detected)
+   unsigned long long carrierOff;
+
+   // silence end (modulation detected)
+   unsigned long long carrierOn;
+
+   //
+   unsigned int signalPulse;
+
+   // signal data buffer, all signal buffers only use first signalBufferMask + 1 entries
    float signalData[BUFFER_SIZE];
 
    // signal edge detect buffer
@@ -220,15 +236,6 @@ struct SignalStatus
 
    // signal mean deviation buffer
    float signalMdev[BUFFER_SIZE];
-
-   // silence start (no modulation detected)
-   unsigned int carrierOff;
-
-   // silence end (modulation detected)
-   unsigned int carrierOn;
-
-   //
-   unsigned int signalPulse;
 };
 
 /*
@@ -237,18 +244,18 @@ struct SignalStatus
 struct ModulationStatus
 {
    // symbol search status
-   unsigned int searchStage;        // search stage control
-   unsigned int searchStartTime;    // sample start of symbol search window
-   unsigned int searchEndTime;      // sample end of symbol search window
-   unsigned int searchPeakTime;     // sample time for maximum correlation peak
-   unsigned int searchPulseWidth;   // detected signal pulse width
-   float searchDeepValue;           // signal modulation deep during search
-   float searchThreshold;           // signal threshold
+   unsigned int searchStage;              // search stage control
+   unsigned long long searchStartTime;    // sample start of symbol search window
+   unsigned long long searchEndTime;      // sample end of symbol search window
+   unsigned long long searchPeakTime;     // sample time for maximum correlation peak
+   unsigned int searchPulseWidth;         // detected signal pulse width
+   float searchDeepValue;                 // signal modulation deep during search
+   float searchThreshold;                 // signal threshold
 
    // symbol parameters
-   unsigned int symbolStartTime;
-   unsigned int symbolEndTime;
-   unsigned int symbolSyncTime;
+   unsigned long long symbolStartTime;
+   unsigned long long symbolEndTime;
+   unsigned long long symbolSyncTime;
    float symbolCorr0;
    float symbolCorr1;
    float symbolPhase;
@@ -260,12 +267,12 @@ struct ModulationStatus
    float phaseIntegrate;
    float phaseThreshold;
 
-   // integration indexes
-   unsigned int signalIndex;
-   unsigned int delay0Index;
-   unsigned int delay1Index;
-   unsigned int delay2Index;
-   unsigned int delay4Index;
+   // integration indexes, full sample clock as they are also reduced modulo symbol period for correlation points
+   unsigned long long signalIndex;
+   unsigned long long delay0Index;
+   unsigned long long delay1Index;
+   unsigned long long delay2Index;
+   unsigned long long delay4Index;
 
    // correlation indexes
    unsigned int filterPoint1;
@@ -281,9 +288,89 @@ struct ModulationStatus
    // edge detector values
    float detectorPeek;
 
-   // data buffers
-   float integrationData[BUFFER_SIZE];
-   float correlationData[BUFFER_SIZE];
+   // data buffers, owned by tech ModulationBuffer
+   float *integrationData;                // integration ring, integrationMask + 1 entries
+   float *correlationData;                // correlation values for each sample of longest symbol period
+   unsigned int integrationMask;
+};
+
+/*
+ * ring buffers for modulation status of all symbol rates in one tech, kept apart from ModulationStatus so status of all
+ * rates fits in a few cache lines, each ring is sized from symbol period of its rate instead of BUFFER_SIZE
+ */
+struct ModulationBuffer
+{
+   std::vector<float> data;
+
+   // allocate cleared rings for each rate and bind them to modulation status
+   inline void configure(ModulationStatus *modulation, const BitrateParams *bitrate, int rates)
+   {
+      std::size_t length = 0;
+
+      for (int rate = 0; rate < rates; rate++)
+         length += integrationLength(bitrate[rate]) + correlationLength(bitrate[rate]);
+
+      data.assign(length, 0);
+
+      bind(modulation, bitrate, rates);
+   }
+
+   // clear rings and bind them to modulation status, after status has been cleared
+   inline void reset(ModulationStatus *modulation, const BitrateParams *bitrate, int rates)
+   {
+      std::fill(data.begin(), data.end(), 0.0f);
+
+      bind(modulation, bitrate, rates);
+   }
+
+   // bind rings to modulation status, after status has been cleared or restored from snapshot
+   inline void bind(ModulationStatus *modulation, const BitrateParams *bitrate, int rates)
+   {
+      float *next = data.data();
+
+      for (int rate = 0; rate < rates; rate++)
+      {
+         modulation[rate].integrationData = next;
+         modulation[rate].integrationMask = integrationLength(bitrate[rate]) - 1;
+         next += integrationLength(bitrate[rate]);
+
+         modulation[rate].correlationData = next;
+         next += correlationLength(bitrate[rate]);
+      }
+   }
+
+   // integrators span up to one full symbol (two for NFC-V), power of two ring to index with mask
+   inline static unsigned int integrationLength(const BitrateParams &bitrate)
+   {
+      unsigned int length = 1;
+
+      while (length <= correlationLength(bitrate))
+         length <<= 1;
+
+      return length;
+   }
+
+   // correlation points are taken modulo longest symbol period
+   inline static unsigned int correlationLength(const BitrateParams &bitrate)
+   {
+      return std::max(bitrate.period0SymbolSamples, bitrate.period1SymbolSamples);
+   }
+};
+
+/*
+ * shared ASK correlator bank, one half symbol integrator for each symbol rate updated once per sample clock and read by
+ * all detectors with same symbol timing (NFC-A miller and NFC-F manchester), status is owned by first registered tech
+ */
+struct CorrelatorBank
+{
+   // symbol timing for each rate
+   BitrateParams *bitrate[4];
+
+   // integration and correlation status for each rate
+   ModulationStatus *modulation[4];
+
+   // last sample clock computed for each rate
+   unsigned long long clock[4];
 };
 
 /*
@@ -293,8 +380,8 @@ struct SymbolStatus
 {
    unsigned int pattern; // symbol pattern
    unsigned int value; // symbol value (0 / 1)
-   unsigned long start;    // sample clocks for start of last decoded symbol
-   unsigned long end; // sample clocks for end of last decoded symbol
+   unsigned long long start;    // sample clocks for start of last decoded symbol
+   unsigned long long end; // sample clocks for end of last decoded symbol
    unsigned int length; // samples for next symbol synchronization
    unsigned int rate; // symbol rate
 };
@@ -322,10 +409,10 @@ struct FrameStatus
    unsigned int lastCommand; // last received command
    unsigned int frameType; // frame type
    unsigned int symbolRate; // frame bit rate
-   unsigned int frameStart;  // sample clocks for start of last decoded symbol
-   unsigned int frameEnd; // sample clocks for end of last decoded symbol
-   unsigned int guardEnd; // frame guard end time
-   unsigned int waitingEnd; // frame waiting end time
+   unsigned long long frameStart;  // sample clocks for start of last decoded symbol
+   unsigned long long frameEnd; // sample clocks for end of last decoded symbol
+   unsigned long long guardEnd; // frame guard end time
+   unsigned long long waitingEnd; // frame waiting end time
 
    // The frame delay time FDT is defined as the time between two frames transmitted in opposite directions
    unsigned int frameGuardTime;
@@ -361,6 +448,105 @@ struct ProtocolStatus
    unsigned int requestGuardTime;
 };
 
+/*
+ * decoder status snapshot, status structures are plain data so they are stored as raw bytes, pointers are stored as
+ * indexes to owner arrays so snapshot can be restored over a new decoder instance built with same parameters
+ */
+struct StatusSnapshot
+{
+   std::vector<unsigned char> data;
+
+   // read position
+   unsigned int offset = 0;
+
+   // false after read beyond snapshot end
+   bool valid = true;
+
+   template<typename T>
+   inline void save(const T &value)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be trivially copyable");
+
+      auto bytes = reinterpret_cast<const unsigned char *>(&value);
+
+      data.insert(data.end(), bytes, bytes + sizeof(T));
+   }
+
+   template<typename T>
+   inline bool load(T &value)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be trivially copyable");
+
+      if (!valid || offset + sizeof(T) > data.size())
+         return valid = false;
+
+      std::memcpy(&value, data.data() + offset, sizeof(T));
+
+      offset += sizeof(T);
+
+      return true;
+   }
+
+   template<typename T>
+   inline void save(const std::vector<T> &values)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be trivially copyable");
+
+      auto bytes = reinterpret_cast<const unsigned char *>(values.data());
+
+      save(values.size());
+
+      data.insert(data.end(), bytes, bytes + values.size() * sizeof(T));
+   }
+
+   // vector must have same size as stored one, as allocated by configure
+   template<typename T>
+   inline bool load(std::vector<T> &values)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be trivially copyable");
+
+      std::size_t size = 0;
+
+      if (!load(size) || size != values.size() || offset + size * sizeof(T) > data.size())
+         return valid = false;
+
+      std::memcpy(values.data(), data.data() + offset, size * sizeof(T));
+
+      offset += size * sizeof(T);
+
+      return true;
+   }
+
+   template<typename T>
+   inline void saveIndex(const T *pointer, const T *array, int count)
+   {
+      int index = -1;
+
+      for (int i = 0; i < count && index < 0; i++)
+      {
+         if (pointer == array + i)
+            index = i;
+      }
+
+      save(index);
+   }
+
+   // pointer is only updated if stored index refers to given array
+   template<typename T>
+   inline bool loadIndex(T *&pointer, T *array, int count)
+   {
+      int index = -1;
+
+      if (!load(index) || index >= count)
+         return valid = false;
+
+      if (index >= 0)
+         pointer = array + index;
+
+      return true;
+   }
+};
+
 struct DecoderStatus
 {
    // signal parameters
@@ -381,8 +567,11 @@ struct DecoderStatus
    // signal sample rate
    unsigned int sampleRate = 0;
 
-   // signal master clock
-   unsigned int signalClock = 0;
+   // signal master clock, 64 bit sample counter does not wrap on long running sessions
+   unsigned long long signalClock = 0;
+
+   // shared ASK correlator bank
+   CorrelatorBank correlator {};
 
    // minimum signal level
    float powerLevelThreshold = 0.010f;
@@ -390,6 +579,63 @@ struct DecoderStatus
    // signal debugger
    std::shared_ptr<SignalDebug> debug;
 
+   // grow signal buffers ring to cover given delay from current sample, called by each tech on configure
+   inline void reserveSignalBuffer(unsigned int samples)
+   {
+      while (signalParams.signalBufferMask < samples && signalParams.signalBufferMask < BUFFER_SIZE - 1)
+         signalParams.signalBufferMask = (signalParams.signalBufferMask << 1) | 1;
+   }
+
+   // register correlator status for one rate, first registered tech owns it
+   inline void registerCorrelator(int rate, BitrateParams *bitrate, ModulationStatus *modulation)
+   {
+      if (!correlator.modulation[rate])
+      {
+         correlator.bitrate[rate] = bitrate;
+         correlator.modulation[rate] = modulation;
+         correlator.clock[rate] = 0;
+      }
+   }
+
+   // update shared correlator for given rate, integration and correlation is computed only once per sample clock
+   inline ModulationStatus *correlate(int rate)
+   {
+      BitrateParams *bitrate = correlator.bitrate[rate];
+      ModulationStatus *modulation = correlator.modulation[rate];
+
+      if (correlator.clock[rate] != signalClock)
+      {
+         // compute signal pointers
+         modulation->signalIndex = (bitrate->offsetSignalIndex + signalClock);
+         modulation->delay2Index = (bitrate->offsetDelay2Index + signalClock);
+
+         // get signal samples
+         float signalData = signalStatus.signalData[modulation->signalIndex & signalParams.signalBufferMask];
+         float delay2Data = signalStatus.signalData[modulation->delay2Index & signalParams.signalBufferMask];
+
+         // integrate signal data over 1/2 symbol
+         modulation->filterIntegrate += signalData; // add new value
+         modulation->filterIntegrate -= delay2Data; // remove delayed value
+
+         // correlation points
+         modulation->filterPoint1 = (modulation->signalIndex % bitrate->period1SymbolSamples);
+         modulation->filterPoint2 = (modulation->signalIndex + bitrate->period2SymbolSamples) % bitrate->period1SymbolSamples;
+         modulation->filterPoint3 = (modulation->signalIndex + bitrate->period1SymbolSamples - 1) % bitrate->period1SymbolSamples;
+
+         // store integrated signal in correlation buffer
+         modulation->correlationData[modulation->filterPoint1] = modulation->filterIntegrate;
+
+         // compute correlation factors
+         modulation->correlatedS0 = modulation->correlationData[modulation->filterPoint1] - modulation->correlationData[modulation->filterPoint2];
+         modulation->correlatedS1 = modulation->correlationData[modulation->filterPoint2] - modulation->correlationData[modulation->filterPoint3];
+         modulation->correlatedSD = std::fabs(modulation->correlatedS0 - modulation->correlatedS1) / float(bitrate->period2SymbolSamples);
+
+         correlator.clock[rate] = signalClock;
+      }
+
+      return modulation;
+   }
+
    // process next sample from signal buffer
    inline bool nextSample(sdr::SignalBuffer &buffer)
    {
@@ -446,16 +692,16 @@ struct DecoderStatus
       signalStatus.signalEdge1 = signalStatus.signalEdge1 * signalParams.signalEdge1W0 + signalStatus.signalValue * signalParams.signalEdge1W1;
 
       // store next signal value in sample buffer
-      signalStatus.signalData[signalClock & (BUFFER_SIZE - 1)] = signalStatus.signalValue;
+      signalStatus.signalData[signalClock & signalParams.signalBufferMask] = signalStatus.signalValue;
 
       // store next signal value in sample buffer
-      signalStatus.signalMdev[signalClock & (BUFFER_SIZE - 1)] = signalStatus.signalStDev;
+      signalStatus.signalMdev[signalClock & signalParams.signalBufferMask] = signalStatus.signalStDev;
 
       // store next edge value in sample buffer
-      signalStatus.signalEdge[signalClock & (BUFFER_SIZE - 1)] = signalStatus.signalEdge0 - signalStatus.signalEdge1;
+      signalStatus.signalEdge[signalClock & signalParams.signalBufferMask] = signalStatus.signalEdge0 - signalStatus.signalEdge1;
 
       // store next edge value in sample buffer
-      signalStatus.signalDeep[signalClock & (BUFFER_SIZE - 1)] = (signalStatus.signalAverg - signalStatus.signalValue) / signalStatus.signalAverg;
+      signalStatus.signalDeep[signalClock & signalParams.signalBufferMask] = (signalStatus.signalAverg - signalStatus.signalValue) / signalStatus.signalAverg;
 
 #ifdef DEBUG_SIGNAL
       debug->block(signalClock);
@@ -77,11 +77,14 @@ struct NfcA::Impl
    // modulation status for each bitrate
    ModulationStatus modulationStatus[4] {0,};
 
+   // modulation ring buffers for each bitrate
+   ModulationBuffer modulationBuffer;
+
    // minimum modulation threshold to detect valid signal for NFC-A (default 85%)
    float minimumModulationThreshold = 0.850f;
 
    // last detected frame end
-   unsigned int lastFrameEnd = 0;
+   unsigned long long lastFrameEnd = 0;
 
    // chained frame flags
    unsigned int chainedFlags = 0;
@@ -152,10 +155,16 @@ struct NfcA::Impl
          bitrate->offsetDelay4Index = BUFFER_SIZE - bitrate->symbolDelayDetect - bitrate->period4SymbolSamples;
          bitrate->offsetDelay8Index = BUFFER_SIZE - bitrate->symbolDelayDetect - bitrate->period8SymbolSamples;
 
+         // signal buffers must reach oldest sample used by this rate
+         decoder->reserveSignalBuffer(bitrate->symbolDelayDetect + bitrate->period1SymbolSamples);
+
          // exponential symbol average
          bitrate->symbolAverageW0 = float(1 - 5.0 / bitrate->period1SymbolSamples);
          bitrate->symbolAverageW1 = float(1 - bitrate->symbolAverageW0);
 
+         // register as owner of shared correlator for this rate
+         decoder->registerCorrelator(rate, bitrate, modulationStatus + rate);
+
          log.info("{} kpbs parameters:", {round(bitrate->symbolsPerSecond / 1E3)});
          log.info("\tsymbolsPerSecond     {}", {bitrate->symbolsPerSecond});
          log.info("\tperiod1SymbolSamples {} ({} us)", {bitrate->period1SymbolSamples, 1E6 * bitrate->period1SymbolSamples / decoder->sampleRate});
@@ -170,6 +179,9 @@ struct NfcA::Impl
          log.info("\toffsetDelay1Index    {}", {bitrate->offsetDelay1Index});
       }
 
+      // allocate modulation buffers sized for each bitrate
+      modulationBuffer.configure(modulationStatus, bitrateParams, 4);
+
       // initialize default protocol parameters for start decoding
       protocolStatus.maxFrameSize = 256;
       protocolStatus.startUpGuardTime = int(decoder->signalParams.sampleTimeUnit * NFCA_SFGT_DEF);
@@ -205,36 +217,17 @@ struct NfcA::Impl
          BitrateParams *bitrate = bitrateParams + rate;
          ModulationStatus *modulation = modulationStatus + rate;
 
-         // compute signal pointers
-         modulation->signalIndex = (bitrate->offsetSignalIndex + decoder->signalClock);
-         modulation->delay2Index = (bitrate->offsetDelay2Index + decoder->signalClock);
+         // update shared correlator bank, reused by NFC-F detector for 212Kbps and 424Kbps
+         decoder->correlate(rate);
 
          // get signal samples
-         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
-         float delay2Data = decoder->signalStatus.signalData[modulation->delay2Index & (BUFFER_SIZE - 1)];
-
-         // integrate signal data over 1/2 symbol
-         modulation->filterIntegrate += signalData; // add new value
-         modulation->filterIntegrate -= delay2Data; // remove delayed value
-
-         // correlation points
-         modulation->filterPoint1 = (modulation->signalIndex % bitrate->period1SymbolSamples);
-         modulation->filterPoint2 = (modulation->signalIndex + bitrate->period2SymbolSamples) % bitrate->period1SymbolSamples;
-         modulation->filterPoint3 = (modulation->signalIndex + bitrate->period1SymbolSamples - 1) % bitrate->period1SymbolSamples;
-
-         // store integrated signal in correlation buffer
-         modulation->correlationData[modulation->filterPoint1] = modulation->filterIntegrate;
-
-         // compute correlation factors
-         modulation->correlatedS0 = modulation->correlationData[modulation->filterPoint1] - modulation->correlationData[modulation->filterPoint2];
-         modulation->correlatedS1 = modulation->correlationData[modulation->filterPoint2] - modulation->correlationData[modulation->filterPoint3];
-         modulation->correlatedSD = std::fabs(modulation->correlatedS0 - modulation->correlatedS1) / float(bitrate->period2SymbolSamples);
+         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
          // compute symbol average
          modulation->symbolAverage = modulation->symbolAverage * bitrate->symbolAverageW0 + signalData * bitrate->symbolAverageW1;
 
          // signal modulation deep value
-         float deepValue = decoder->signalStatus.signalDeep[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float deepValue = decoder->signalStatus.signalDeep[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
 #ifdef DEBUG_ASK_CORR_CHANNEL
          decoder->debug->set(DEBUG_ASK_CORR_CHANNEL, modulation->correlatedSD);
@@ -710,8 +703,8 @@ struct NfcA::Impl
          modulation->delay2Index = (bitrate->offsetDelay2Index + decoder->signalClock);
 
          // get signal samples
-         float currentData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
-         float delayedData = decoder->signalStatus.signalData[modulation->delay2Index & (BUFFER_SIZE - 1)];
+         float currentData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
+         float delayedData = decoder->signalStatus.signalData[modulation->delay2Index & decoder->signalParams.signalBufferMask];
 
          // integrate signal data over 1/2 symbol
          modulation->filterIntegrate += currentData; // add new value
@@ -844,8 +837,8 @@ struct NfcA::Impl
          modulation->delay2Index = (bitrate->offsetDelay2Index + decoder->signalClock);
 
          // get signal samples
-         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
-         float signalMDev = decoder->signalStatus.signalMdev[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
+         float signalMDev = decoder->signalStatus.signalMdev[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
          // compute symbol average (signal offset)
          modulation->symbolAverage = modulation->symbolAverage * bitrate->symbolAverageW0 + signalData * bitrate->symbolAverageW1;
@@ -854,7 +847,7 @@ struct NfcA::Impl
          signalData -= modulation->symbolAverage;
 
          // store signal square in filter buffer
-         modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)] = signalData * signalData;
+         modulation->integrationData[modulation->signalIndex & modulation->integrationMask] = signalData * signalData;
 
 #ifdef DEBUG_ASK_CORR_CHANNEL
          decoder->debug->set(DEBUG_ASK_CORR_CHANNEL, signalMDev);
@@ -869,8 +862,8 @@ struct NfcA::Impl
          modulation->filterPoint3 = (modulation->signalIndex + bitrate->period1SymbolSamples - 1) % bitrate->period1SymbolSamples;
 
          // integrate symbol (moving average)
-         modulation->filterIntegrate += modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)]; // add new value
-         modulation->filterIntegrate -= modulation->integrationData[modulation->delay2Index & (BUFFER_SIZE - 1)]; // remove delayed value
+         modulation->filterIntegrate += modulation->integrationData[modulation->signalIndex & modulation->integrationMask]; // add new value
+         modulation->filterIntegrate -= modulation->integrationData[modulation->delay2Index & modulation->integrationMask]; // remove delayed value
 
          // store integrated signal in correlation buffer
          modulation->correlationData[modulation->filterPoint1] = modulation->filterIntegrate;
@@ -978,7 +971,7 @@ struct NfcA::Impl
          modulation->delay2Index = (bitrate->offsetDelay2Index + decoder->signalClock);
 
          // get signal samples
-         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
          // compute symbol average (signal offset)
          modulation->symbolAverage = modulation->symbolAverage * bitrate->symbolAverageW0 + signalData * bitrate->symbolAverageW1;
@@ -987,7 +980,7 @@ struct NfcA::Impl
          signalData -= modulation->symbolAverage;
 
          // store signal square in filter buffer
-         modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)] = signalData * signalData;
+         modulation->integrationData[modulation->signalIndex & modulation->integrationMask] = signalData * signalData;
 
          // compute correlation points
          modulation->filterPoint1 = (modulation->signalIndex % bitrate->period1SymbolSamples);
@@ -995,8 +988,8 @@ struct NfcA::Impl
          modulation->filterPoint3 = (modulation->signalIndex + bitrate->period1SymbolSamples - 1) % bitrate->period1SymbolSamples;
 
          // integrate symbol (moving average)
-         modulation->filterIntegrate += modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)]; // add new value
-         modulation->filterIntegrate -= modulation->integrationData[modulation->delay2Index & (BUFFER_SIZE - 1)]; // remove delayed value
+         modulation->filterIntegrate += modulation->integrationData[modulation->signalIndex & modulation->integrationMask]; // add new value
+         modulation->filterIntegrate -= modulation->integrationData[modulation->delay2Index & modulation->integrationMask]; // remove delayed value
 
          // store integrated signal in correlation buffer
          modulation->correlationData[modulation->filterPoint1] = modulation->filterIntegrate;
@@ -1104,9 +1097,9 @@ struct NfcA::Impl
          modulation->delay4Index = (bitrate->offsetDelay4Index + decoder->signalClock);
 
          // get signal samples
-         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
-         float delay1Data = decoder->signalStatus.signalData[modulation->delay1Index & (BUFFER_SIZE - 1)];
-         float signalMDev = decoder->signalStatus.signalMdev[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
+         float delay1Data = decoder->signalStatus.signalData[modulation->delay1Index & decoder->signalParams.signalBufferMask];
+         float signalMDev = decoder->signalStatus.signalMdev[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
          // compute symbol average
          modulation->symbolAverage = modulation->symbolAverage * bitrate->symbolAverageW0 + signalData * bitrate->symbolAverageW1;
@@ -1115,7 +1108,7 @@ struct NfcA::Impl
          float phase = (signalData - modulation->symbolAverage) * (delay1Data - modulation->symbolAverage) * 10;
 
          // store signal phase in filter buffer
-         modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)] = phase;
+         modulation->integrationData[modulation->signalIndex & modulation->integrationMask] = phase;
 
 #ifdef DEBUG_BPSK_PHASE_CHANNEL
          decoder->debug->set(DEBUG_BPSK_PHASE_CHANNEL, signalMDev);
@@ -1126,8 +1119,8 @@ struct NfcA::Impl
             continue;
 
          // compute phase correlate integration
-         modulation->phaseIntegrate += modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)]; // add new value
-         modulation->phaseIntegrate -= modulation->integrationData[modulation->delay4Index & (BUFFER_SIZE - 1)]; // remove delayed value
+         modulation->phaseIntegrate += modulation->integrationData[modulation->signalIndex & modulation->integrationMask]; // add new value
+         modulation->phaseIntegrate -= modulation->integrationData[modulation->delay4Index & modulation->integrationMask]; // remove delayed value
 
          // integrate response from PICC after guard time (TR0)
          if (decoder->signalClock < frameStatus.guardEnd)
@@ -1214,8 +1207,8 @@ struct NfcA::Impl
          modulation->delay4Index = (bitrate->offsetDelay4Index + decoder->signalClock);
 
          // get signal samples
-         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
-         float delay1Data = decoder->signalStatus.signalData[modulation->delay1Index & (BUFFER_SIZE - 1)];
+         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
+         float delay1Data = decoder->signalStatus.signalData[modulation->delay1Index & decoder->signalParams.signalBufferMask];
 
          // compute symbol average
          modulation->symbolAverage = modulation->symbolAverage * bitrate->symbolAverageW0 + signalData * bitrate->symbolAverageW1;
@@ -1224,10 +1217,10 @@ struct NfcA::Impl
          float phase = (signalData - modulation->symbolAverage) * (delay1Data - modulation->symbolAverage);
 
          // store signal phase in filter buffer
-         modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)] = phase * 10;
+         modulation->integrationData[modulation->signalIndex & modulation->integrationMask] = phase * 10;
 
-         modulation->phaseIntegrate += modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)]; // add new value
-         modulation->phaseIntegrate -= modulation->integrationData[modulation->delay4Index & (BUFFER_SIZE - 1)]; // remove delayed value
+         modulation->phaseIntegrate += modulation->integrationData[modulation->signalIndex & modulation->integrationMask]; // add new value
+         modulation->phaseIntegrate -= modulation->integrationData[modulation->delay4Index & modulation->integrationMask]; // remove delayed value
 
 #ifdef DEBUG_BPSK_PHASE_CHANNEL
          decoder->debug->set(DEBUG_BPSK_PHASE_CHANNEL, modulation->phaseIntegrate);
@@ -1322,6 +1315,67 @@ struct NfcA::Impl
       frameStatus.frameStart = 0;
    }
 
+   /*
+    * Reset after signal discontinuity, integrators are cleared and frame in progress is discarded
+    */
+   inline void reset()
+   {
+      // clear modulation integrators and search status
+      for (auto &modulation: modulationStatus)
+         modulation = {0,};
+
+      // clear modulation buffers
+      modulationBuffer.reset(modulationStatus, bitrateParams, 4);
+
+      // clear stream, symbol and frame status
+      resetModulation();
+   }
+
+   /*
+    * Store decoder status in snapshot
+    */
+   inline void saveStatus(StatusSnapshot &snapshot) const
+   {
+      snapshot.save(bitrateParams);
+      snapshot.save(symbolStatus);
+      snapshot.save(streamStatus);
+      snapshot.save(frameStatus);
+      snapshot.save(protocolStatus);
+      snapshot.save(modulationStatus);
+      snapshot.save(modulationBuffer.data);
+      snapshot.save(minimumModulationThreshold);
+      snapshot.save(lastFrameEnd);
+      snapshot.save(chainedFlags);
+
+      // detected modulation is stored only if owned by this tech
+      snapshot.saveIndex(decoder->bitrate, bitrateParams, 4);
+      snapshot.saveIndex(decoder->modulation, modulationStatus, 4);
+   }
+
+   /*
+    * Restore decoder status from snapshot, tech must be configured with same sample rate
+    */
+   inline bool loadStatus(StatusSnapshot &snapshot)
+   {
+      snapshot.load(bitrateParams);
+      snapshot.load(symbolStatus);
+      snapshot.load(streamStatus);
+      snapshot.load(frameStatus);
+      snapshot.load(protocolStatus);
+      snapshot.load(modulationStatus);
+      snapshot.load(modulationBuffer.data);
+      modulationBuffer.bind(modulationStatus, bitrateParams, 4);
+      snapshot.load(minimumModulationThreshold);
+      snapshot.load(lastFrameEnd);
+      snapshot.load(chainedFlags);
+
+      // restore detected modulation if owned by this tech
+      snapshot.loadIndex(decoder->bitrate, bitrateParams, 4);
+      snapshot.loadIndex(decoder->modulation, modulationStatus, 4);
+
+      return snapshot.valid;
+   }
+
    /*
     * Reset modulation status
     */
@@ -1909,6 +1963,21 @@ void NfcA::configure(long sampleRate)
 /*
  * Detect NFC-A modulation
  */
+void NfcA::reset()
+{
+   self->reset();
+}
+
+void NfcA::saveStatus(StatusSnapshot &snapshot) const
+{
+   self->saveStatus(snapshot);
+}
+
+bool NfcA::loadStatus(StatusSnapshot &snapshot)
+{
+   return self->loadStatus(snapshot);
+}
+
 bool NfcA::detect()
 {
    return self->detectModulation();
@@ -69,6 +69,12 @@ struct NfcA
 
    void configure(long sampleRate);
 
+   void reset();
+
+   void saveStatus(StatusSnapshot &snapshot) const;
+
+   bool loadStatus(StatusSnapshot &snapshot);
+
    bool detect();
 
    void decode(sdr::SignalBuffer &samples, std::list<NfcFrame> &frames);
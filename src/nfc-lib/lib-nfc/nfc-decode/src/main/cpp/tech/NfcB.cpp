@@ -73,6 +73,9 @@ struct NfcB::Impl
    // modulation status for each bitrate
    ModulationStatus modulationStatus[4] {0,};
 
+   // modulation ring buffers for each bitrate
+   ModulationBuffer modulationBuffer;
+
    // minimum modulation threshold to detect valid signal for NFC-B (default 10%)
    float minimumModulationThreshold = 0.10f;
 
@@ -80,7 +83,7 @@ struct NfcB::Impl
    float maximumModulationThreshold = 0.75f;
 
    // last detected frame end
-   unsigned int lastFrameEnd = 0;
+   unsigned long long lastFrameEnd = 0;
 
    // chained frame flags
    unsigned int chainedFlags = 0;
@@ -151,6 +154,9 @@ struct NfcB::Impl
          bitrate->offsetDelay4Index = BUFFER_SIZE - bitrate->symbolDelayDetect - bitrate->period4SymbolSamples;
          bitrate->offsetDelay8Index = BUFFER_SIZE - bitrate->symbolDelayDetect - bitrate->period8SymbolSamples;
 
+         // signal buffers must reach oldest sample used by this rate
+         decoder->reserveSignalBuffer(bitrate->symbolDelayDetect + bitrate->period1SymbolSamples);
+
          // exponential symbol average
          bitrate->symbolAverageW0 = float(1 - 5.0 / bitrate->period1SymbolSamples);
          bitrate->symbolAverageW1 = float(1 - bitrate->symbolAverageW0);
@@ -169,6 +175,9 @@ struct NfcB::Impl
          log.info("\toffsetDelay1Index    {}", {bitrate->offsetDelay1Index});
       }
 
+      // allocate modulation buffers sized for each bitrate
+      modulationBuffer.configure(modulationStatus, bitrateParams, 4);
+
       // initialize default protocol parameters for start decoding
       protocolStatus.maxFrameSize = 256;
       protocolStatus.startUpGuardTime = int(decoder->signalParams.sampleTimeUnit * NFCB_SFGT_DEF);
@@ -208,10 +217,10 @@ struct NfcB::Impl
          modulation->signalIndex = (bitrate->offsetSignalIndex + decoder->signalClock);
 
          // signal edge detector value
-         float edgeValue = decoder->signalStatus.signalEdge[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float edgeValue = decoder->signalStatus.signalEdge[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
          // signal modulation deep value
-         float deepValue = decoder->signalStatus.signalDeep[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float deepValue = decoder->signalStatus.signalDeep[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
 #ifdef DEBUG_ASK_EDGE_CHANNEL
          decoder->debug->set(DEBUG_ASK_EDGE_CHANNEL, edgeValue * 10);
@@ -607,10 +616,10 @@ struct NfcB::Impl
          modulation->signalIndex = (bitrate->offsetSignalIndex + decoder->signalClock);
 
          // signal edge detector value
-         float edgeValue = decoder->signalStatus.signalEdge[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float edgeValue = decoder->signalStatus.signalEdge[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
          // signal modulation deep value
-         float deepValue = decoder->signalStatus.signalDeep[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float deepValue = decoder->signalStatus.signalDeep[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
 #ifdef DEBUG_ASK_EDGE_CHANNEL
          decoder->debug->set(DEBUG_ASK_EDGE_CHANNEL, edgeValue * 10);
@@ -700,9 +709,9 @@ struct NfcB::Impl
          modulation->delay4Index = (bitrate->offsetDelay4Index + decoder->signalClock);
 
          // get signal samples
-         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
-         float delay1Data = decoder->signalStatus.signalData[modulation->delay1Index & (BUFFER_SIZE - 1)];
-         float signalMDev = decoder->signalStatus.signalMdev[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
+         float delay1Data = decoder->signalStatus.signalData[modulation->delay1Index & decoder->signalParams.signalBufferMask];
+         float signalMDev = decoder->signalStatus.signalMdev[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
          // compute symbol average
          modulation->symbolAverage = modulation->symbolAverage * bitrate->symbolAverageW0 + signalData * bitrate->symbolAverageW1;
@@ -714,7 +723,7 @@ struct NfcB::Impl
          decoder->debug->set(DEBUG_BPSK_PHASE_CHANNEL - 1, phase);
 #endif
          // store signal phase in filter buffer
-         modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)] = phase;
+         modulation->integrationData[modulation->signalIndex & modulation->integrationMask] = phase;
 
 #ifdef DEBUG_BPSK_PHASE_CHANNEL
          decoder->debug->set(DEBUG_BPSK_PHASE_CHANNEL, signalMDev);
@@ -723,8 +732,8 @@ struct NfcB::Impl
          if (decoder->signalClock < (frameStatus.guardEnd - bitrate->period1SymbolSamples))
             continue;
 
-         modulation->phaseIntegrate += modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)]; // add new value
-         modulation->phaseIntegrate -= modulation->integrationData[modulation->delay4Index & (BUFFER_SIZE - 1)]; // remove delayed value
+         modulation->phaseIntegrate += modulation->integrationData[modulation->signalIndex & modulation->integrationMask]; // add new value
+         modulation->phaseIntegrate -= modulation->integrationData[modulation->delay4Index & modulation->integrationMask]; // remove delayed value
 
          // wait until frame guard time is reached
          if (decoder->signalClock < frameStatus.guardEnd)
@@ -926,8 +935,8 @@ struct NfcB::Impl
          modulation->delay4Index = (bitrate->offsetDelay4Index + decoder->signalClock);
 
          // get signal samples
-         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
-         float delay1Data = decoder->signalStatus.signalData[modulation->delay1Index & (BUFFER_SIZE - 1)];
+         float signalData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
+         float delay1Data = decoder->signalStatus.signalData[modulation->delay1Index & decoder->signalParams.signalBufferMask];
 
          // compute symbol average
          modulation->symbolAverage = modulation->symbolAverage * bitrate->symbolAverageW0 + signalData * bitrate->symbolAverageW1;
@@ -936,10 +945,10 @@ struct NfcB::Impl
          float phase = (signalData - modulation->symbolAverage) * (delay1Data - modulation->symbolAverage) * 10;
 
          // store signal phase in filter buffer
-         modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)] = phase;
+         modulation->integrationData[modulation->signalIndex & modulation->integrationMask] = phase;
 
-         modulation->phaseIntegrate += modulation->integrationData[modulation->signalIndex & (BUFFER_SIZE - 1)]; // add new value
-         modulation->phaseIntegrate -= modulation->integrationData[modulation->delay4Index & (BUFFER_SIZE - 1)]; // remove delayed value
+         modulation->phaseIntegrate += modulation->integrationData[modulation->signalIndex & modulation->integrationMask]; // add new value
+         modulation->phaseIntegrate -= modulation->integrationData[modulation->delay4Index & modulation->integrationMask]; // remove delayed value
 
 #ifdef DEBUG_BPSK_PHASE_CHANNEL
          decoder->debug->set(DEBUG_BPSK_PHASE_CHANNEL, modulation->phaseIntegrate);
@@ -1009,6 +1018,69 @@ struct NfcB::Impl
       return pattern;
    }
 
+   /*
+    * Reset after signal discontinuity, integrators are cleared and frame in progress is discarded
+    */
+   inline void reset()
+   {
+      // clear modulation integrators and search status
+      for (auto &modulation: modulationStatus)
+         modulation = {0,};
+
+      // clear modulation buffers
+      modulationBuffer.reset(modulationStatus, bitrateParams, 4);
+
+      // clear stream, symbol and frame status
+      resetModulation();
+   }
+
+   /*
+    * Store decoder status in snapshot
+    */
+   inline void saveStatus(StatusSnapshot &snapshot) const
+   {
+      snapshot.save(bitrateParams);
+      snapshot.save(symbolStatus);
+      snapshot.save(streamStatus);
+      snapshot.save(frameStatus);
+      snapshot.save(protocolStatus);
+      snapshot.save(modulationStatus);
+      snapshot.save(modulationBuffer.data);
+      snapshot.save(minimumModulationThreshold);
+      snapshot.save(maximumModulationThreshold);
+      snapshot.save(lastFrameEnd);
+      snapshot.save(chainedFlags);
+
+      // detected modulation is stored only if owned by this tech
+      snapshot.saveIndex(decoder->bitrate, bitrateParams, 4);
+      snapshot.saveIndex(decoder->modulation, modulationStatus, 4);
+   }
+
+   /*
+    * Restore decoder status from snapshot, tech must be configured with same sample rate
+    */
+   inline bool loadStatus(StatusSnapshot &snapshot)
+   {
+      snapshot.load(bitrateParams);
+      snapshot.load(symbolStatus);
+      snapshot.load(streamStatus);
+      snapshot.load(frameStatus);
+      snapshot.load(protocolStatus);
+      snapshot.load(modulationStatus);
+      snapshot.load(modulationBuffer.data);
+      modulationBuffer.bind(modulationStatus, bitrateParams, 4);
+      snapshot.load(minimumModulationThreshold);
+      snapshot.load(maximumModulationThreshold);
+      snapshot.load(lastFrameEnd);
+      snapshot.load(chainedFlags);
+
+      // restore detected modulation if owned by this tech
+      snapshot.loadIndex(decoder->bitrate, bitrateParams, 4);
+      snapshot.loadIndex(decoder->modulation, modulationStatus, 4);
+
+      return snapshot.valid;
+   }
+
    /*
     * Reset modulation status
     */
@@ -1283,6 +1355,21 @@ void NfcB::configure(long sampleRate)
    self->configure(sampleRate);
 }
 
+void NfcB::reset()
+{
+   self->reset();
+}
+
+void NfcB::saveStatus(StatusSnapshot &snapshot) const
+{
+   self->saveStatus(snapshot);
+}
+
+bool NfcB::loadStatus(StatusSnapshot &snapshot)
+{
+   return self->loadStatus(snapshot);
+}
+
 bool NfcB::detect()
 {
    return self->detectModulation();
@@ -58,6 +58,12 @@ struct NfcB
 
    void configure(long sampleRate);
 
+   void reset();
+
+   void saveStatus(StatusSnapshot &snapshot) const;
+
+   bool loadStatus(StatusSnapshot &snapshot);
+
    bool detect();
 
    void decode(sdr::SignalBuffer &samples, std::list<NfcFrame> &frames);
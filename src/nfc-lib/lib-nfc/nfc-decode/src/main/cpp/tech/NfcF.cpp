@@ -24,6 +24,15 @@
 
 #include <tech/NfcF.h>
 
+#define PREAMBLE_SEARCH 0
+#define PREAMBLE_TRACK 1
+
+// number of consecutive half bit edges required to detect preamble
+#define PREAMBLE_EDGES 16
+
+// maximum bits after preamble detection to find SYNC code
+#define SYNC_TIMEOUT_BITS 256
+
 namespace nfc {
 
 struct NfcF::Impl
@@ -50,14 +59,32 @@ struct NfcF::Impl
    // modulation status for each bitrate
    ModulationStatus modulationStatus[4] {0,};
 
-   // minimum modulation threshold to detect valid signal for NFC-B (default 10%)
+   // modulation ring buffers for each bitrate
+   ModulationBuffer modulationBuffer;
+
+   // minimum modulation threshold to detect valid signal for NFC-F (default 10%)
    float minimumModulationThreshold = 0.10f;
 
-   // minimum modulation threshold to detect valid signal for NFC-B (default 25%)
+   // maximum modulation threshold to detect valid signal for NFC-F (default 25%)
    float maximumModulationThreshold = 0.25f;
 
+   // half bit slot counter since preamble detection
+   unsigned int slotCount = 0;
+
+   // consecutive half bit slots without manchester edge
+   unsigned int slotMissed = 0;
+
+   // SYNC code search register for each half bit phase
+   unsigned int syncPattern[2] {0,};
+
+   // locked half bit phase for mid-bit edges (-1 until SYNC code is found)
+   int syncPhase = -1;
+
+   // inverted manchester polarity
+   bool syncInverted = false;
+
    // last detected frame end
-   unsigned int lastFrameEnd = 0;
+   unsigned long long lastFrameEnd = 0;
 
    // chained frame flags
    unsigned int chainedFlags = 0;
@@ -74,34 +101,544 @@ struct NfcF::Impl
       log.info("\tsignalSampleRate     {}", {decoder->sampleRate});
       log.info("\tpowerLevelThreshold  {}", {decoder->powerLevelThreshold});
       log.info("\tmodulationThreshold  {} -> {}", {minimumModulationThreshold, maximumModulationThreshold});
+
+      // clear last detected frame end
+      lastFrameEnd = 0;
+
+      // clear chained flags
+      chainedFlags = 0;
+
+      // clear detected symbol status
+      symbolStatus = {0,};
+
+      // clear bit stream status
+      streamStatus = {0,};
+
+      // clear frame processing status
+      frameStatus = {0,};
+
+      // compute symbol parameters, same timing as NFC-A so both can share correlator bank, only 212Kbps and 424Kbps are used
+      for (int rate = r106k; rate <= r424k; rate++)
+      {
+         // clear bitrate parameters
+         bitrateParams[rate] = {0,};
+
+         // clear modulation parameters
+         modulationStatus[rate] = {0,};
+
+         // configure bitrate parametes
+         BitrateParams *bitrate = bitrateParams + rate;
+
+         // set tech type and rate
+         bitrate->techType = TechType::NfcF;
+         bitrate->rateType = rate;
+
+         // symbol timing parameters
+         bitrate->symbolsPerSecond = int(std::round(NFC_FC / float(128 >> rate)));
+
+         // number of samples per symbol
+         bitrate->period1SymbolSamples = int(std::round(decoder->signalParams.sampleTimeUnit * (128 >> rate))); // full symbol samples
+         bitrate->period2SymbolSamples = int(std::round(decoder->signalParams.sampleTimeUnit * (64 >> rate))); // half symbol samples
+         bitrate->period4SymbolSamples = int(std::round(decoder->signalParams.sampleTimeUnit * (32 >> rate))); // quarter of symbol...
+         bitrate->period8SymbolSamples = int(std::round(decoder->signalParams.sampleTimeUnit * (16 >> rate))); // and so on...
+
+         // delay guard for each symbol rate
+         bitrate->symbolDelayDetect = rate == r106k ? int(std::round(decoder->signalParams.sampleTimeUnit * 1024)) : bitrateParams[rate - 1].symbolDelayDetect + bitrateParams[rate - 1].period1SymbolSamples;
+
+         // moving average offsets
+         bitrate->offsetSignalIndex = BUFFER_SIZE - bitrate->symbolDelayDetect;
+         bitrate->offsetDelay1Index = BUFFER_SIZE - bitrate->symbolDelayDetect - bitrate->period1SymbolSamples;
+         bitrate->offsetDelay2Index = BUFFER_SIZE - bitrate->symbolDelayDetect - bitrate->period2SymbolSamples;
+         bitrate->offsetDelay4Index = BUFFER_SIZE - bitrate->symbolDelayDetect - bitrate->period4SymbolSamples;
+         bitrate->offsetDelay8Index = BUFFER_SIZE - bitrate->symbolDelayDetect - bitrate->period8SymbolSamples;
+
+         // signal buffers must reach oldest sample used by this rate
+         decoder->reserveSignalBuffer(bitrate->symbolDelayDetect + bitrate->period1SymbolSamples);
+
+         // reuse NFC-A correlator if enabled, otherwise own it
+         if (rate != r106k)
+         {
+            decoder->registerCorrelator(rate, bitrate, modulationStatus + rate);
+
+            log.info("{} kpbs parameters:", {round(bitrate->symbolsPerSecond / 1E3)});
+            log.info("\tsymbolsPerSecond     {}", {bitrate->symbolsPerSecond});
+            log.info("\tperiod1SymbolSamples {} ({} us)", {bitrate->period1SymbolSamples, 1E6 * bitrate->period1SymbolSamples / decoder->sampleRate});
+            log.info("\tperiod2SymbolSamples {} ({} us)", {bitrate->period2SymbolSamples, 1E6 * bitrate->period2SymbolSamples / decoder->sampleRate});
+            log.info("\tsymbolDelayDetect    {} ({} us)", {bitrate->symbolDelayDetect, 1E6 * bitrate->symbolDelayDetect / decoder->sampleRate});
+            log.info("\tsharedCorrelator     {}", {std::string(decoder->correlator.bitrate[rate]->techType == TechType::NfcA ? "NFC-A" : "NFC-F")});
+         }
+      }
+
+      // allocate modulation buffers sized for each bitrate
+      modulationBuffer.configure(modulationStatus, bitrateParams, 4);
+
+      resetModulation();
    }
 
+   /*
+    * Detect NFC-F manchester preamble from shared correlator bank
+    */
    inline bool detectModulation()
    {
+      // ignore low power signals
+      if (decoder->signalStatus.signalAverg < decoder->powerLevelThreshold)
+         return false;
+
+      for (int rate = r212k; rate <= r424k; rate++)
+      {
+         BitrateParams *bitrate = bitrateParams + rate;
+         ModulationStatus *modulation = modulationStatus + rate;
+
+         // shared correlation values, already computed in this sample clock by NFC-A detector
+         ModulationStatus *correlator = decoder->correlate(rate);
+
+         // tracking window lost while other tech was decoding
+         if (modulation->searchStage == PREAMBLE_TRACK && decoder->signalClock > modulation->searchEndTime)
+            resetSearch(modulation);
+
+         // signal modulation deep value
+         float deepValue = decoder->signalStatus.signalDeep[correlator->signalIndex & decoder->signalParams.signalBufferMask];
+
+         // search manchester edge, free search or inside expected half bit window
+         if (modulation->searchStage == PREAMBLE_SEARCH || decoder->signalClock >= modulation->searchStartTime)
+         {
+            if (correlator->correlatedSD > decoder->signalStatus.signalAverg * minimumModulationThreshold)
+            {
+               if (modulation->searchDeepValue < deepValue)
+                  modulation->searchDeepValue = deepValue;
+
+               // max correlation peak detector
+               if (correlator->correlatedSD > modulation->correlationPeek)
+               {
+                  modulation->searchPeakTime = decoder->signalClock;
+                  modulation->symbolCorr0 = correlator->correlatedS0 - correlator->correlatedS1;
+                  modulation->correlationPeek = correlator->correlatedSD;
+
+                  if (modulation->searchStage == PREAMBLE_SEARCH)
+                     modulation->searchEndTime = decoder->signalClock + bitrate->period8SymbolSamples;
+               }
+            }
+         }
+
+         // wait until search finished
+         if (decoder->signalClock != modulation->searchEndTime)
+            continue;
+
+         // preamble edges must alternate polarity and keep low modulation deep
+         if (!modulation->correlationPeek || modulation->searchDeepValue > maximumModulationThreshold || (modulation->searchStage == PREAMBLE_TRACK && (modulation->symbolCorr0 > 0) == (modulation->symbolCorr1 > 0)))
+         {
+            resetSearch(modulation);
+
+            continue;
+         }
+
+         // first edge found, start tracking
+         if (modulation->searchStage == PREAMBLE_SEARCH)
+         {
+            modulation->searchStage = PREAMBLE_TRACK;
+            modulation->searchPulseWidth = 0;
+            modulation->symbolStartTime = modulation->searchPeakTime;
+         }
+
+         // next edge expected after half bit
+         modulation->searchPulseWidth++;
+         modulation->symbolCorr1 = modulation->symbolCorr0;
+         modulation->symbolSyncTime = modulation->searchPeakTime + bitrate->period2SymbolSamples;
+         modulation->searchStartTime = modulation->symbolSyncTime - bitrate->period8SymbolSamples;
+         modulation->searchEndTime = modulation->symbolSyncTime + bitrate->period8SymbolSamples;
+         modulation->correlationPeek = 0;
+
+         if (modulation->searchPulseWidth < PREAMBLE_EDGES)
+            continue;
+
+         // check minimum modulation deep
+         if (modulation->searchDeepValue < minimumModulationThreshold)
+         {
+            resetSearch(modulation);
+
+            continue;
+         }
+
+         // set lower threshold to follow manchester edges
+         modulation->searchThreshold = decoder->signalStatus.signalAverg * minimumModulationThreshold;
+
+         // setup frame info, direction is known after command code
+         frameStatus.frameType = PollFrame;
+         frameStatus.symbolRate = bitrate->symbolsPerSecond;
+         frameStatus.frameStart = modulation->symbolStartTime - bitrate->period1SymbolSamples - bitrate->symbolDelayDetect;
+         frameStatus.frameEnd = 0;
+
+         // start SYNC search on both half bit phases
+         slotCount = 0;
+         slotMissed = 0;
+         syncPhase = -1;
+         syncInverted = false;
+         syncPattern[0] = 0;
+         syncPattern[1] = 0;
+
+         // modulation detected
+         decoder->bitrate = bitrate;
+         decoder->modulation = modulation;
+
+         return true;
+      }
+
       return false;
    }
 
+   /*
+    * Decode next poll or listen frame, both use same manchester coding
+    */
    inline void decodeFrame(sdr::SignalBuffer &samples, std::list<NfcFrame> &frames)
    {
-      if (frameStatus.frameType == PollFrame)
+      if (frameStatus.frameType == PollFrame || frameStatus.frameType == ListenFrame)
       {
-         decodePollFrame(samples, frames);
+         decodeManchesterFrame(samples, frames);
       }
+   }
 
-      if (frameStatus.frameType == ListenFrame)
+   /*
+    * Decode manchester half bit slots, bit value is taken from mid-bit edge polarity
+    */
+   inline bool decodeManchesterFrame(sdr::SignalBuffer &buffer, std::list<NfcFrame> &frames)
+   {
+      BitrateParams *bitrate = decoder->bitrate;
+      ModulationStatus *modulation = decoder->modulation;
+
+      while (decoder->nextSample(buffer))
       {
-         decodeListenFrame(samples, frames);
+         ModulationStatus *correlator = decoder->correlate(bitrate->rateType);
+
+         float edgeValue = correlator->correlatedS0 - correlator->correlatedS1;
+
+         // keep edge polarity at expected slot time in case no peak is found
+         if (decoder->signalClock == modulation->symbolSyncTime)
+            modulation->symbolCorr1 = edgeValue;
+
+         // max correlation peak detector inside slot window
+         if (decoder->signalClock >= modulation->searchStartTime && correlator->correlatedSD > modulation->searchThreshold && correlator->correlatedSD > modulation->correlationPeek)
+         {
+            modulation->searchPeakTime = decoder->signalClock;
+            modulation->symbolCorr0 = edgeValue;
+            modulation->correlationPeek = correlator->correlatedSD;
+         }
+
+         // wait until slot window finished
+         if (decoder->signalClock != modulation->searchEndTime)
+            continue;
+
+         bool edgeFound = modulation->correlationPeek > 0;
+         float slotValue = edgeFound ? modulation->symbolCorr0 : modulation->symbolCorr1;
+         unsigned long long slotTime = edgeFound ? modulation->searchPeakTime : modulation->symbolSyncTime;
+         unsigned int slotPhase = slotCount++ & 1;
+
+         // resync next slot to detected edge
+         modulation->symbolSyncTime = slotTime + bitrate->period2SymbolSamples;
+         modulation->searchStartTime = modulation->symbolSyncTime - bitrate->period8SymbolSamples;
+         modulation->searchEndTime = modulation->symbolSyncTime + bitrate->period8SymbolSamples;
+         modulation->correlationPeek = 0;
+
+         slotMissed = edgeFound ? 0 : slotMissed + 1;
+
+         // search SYNC code in both phases
+         if (syncPhase < 0)
+         {
+            // manchester always has one edge per bit, two missing slots means modulation end
+            if (slotMissed > 1 || slotCount > SYNC_TIMEOUT_BITS * 2)
+            {
+               resetModulation();
+
+               return false;
+            }
+
+            syncPattern[slotPhase] = ((syncPattern[slotPhase] << 1) | (slotValue > 0 ? 1 : 0)) & 0xffff;
+
+            if (syncPattern[slotPhase] == NFCF_SYNC_CODE || syncPattern[slotPhase] == (~NFCF_SYNC_CODE & 0xffff))
+            {
+               syncPhase = (int) slotPhase;
+               syncInverted = syncPattern[slotPhase] != NFCF_SYNC_CODE;
+            }
+
+            continue;
+         }
+
+         // ignore bit boundary slots
+         if (int(slotPhase) != syncPhase)
+            continue;
+
+         // mid-bit edge lost, frame is truncated
+         if (!edgeFound)
+         {
+            if (streamStatus.bytes > 0)
+            {
+               frameStatus.frameEnd = slotTime - bitrate->symbolDelayDetect;
+
+               return emitFrame(frames, true);
+            }
+
+            resetModulation();
+
+            return false;
+         }
+
+         // decode next bit, MSB first
+         streamStatus.data = (streamStatus.data << 1) | ((slotValue > 0) != syncInverted ? 1 : 0);
+
+         if (++streamStatus.bits < 8)
+            continue;
+
+         // store full byte in stream buffer
+         streamStatus.buffer[streamStatus.bytes++] = streamStatus.data;
+         streamStatus.data = 0;
+         streamStatus.bits = 0;
+
+         // length byte includes itself, followed by CRC
+         if (streamStatus.buffer[0] < 2)
+         {
+            resetModulation();
+
+            return false;
+         }
+
+         if (streamStatus.bytes == streamStatus.buffer[0] + 2u)
+         {
+            frameStatus.frameEnd = slotTime - bitrate->symbolDelayDetect;
+
+            return emitFrame(frames, false);
+         }
       }
+
+      return false;
    }
 
-   inline bool decodePollFrame(sdr::SignalBuffer &buffer, std::list<NfcFrame> &frames)
+   /*
+    * Build frame from stream buffer, odd command codes are responses
+    */
+   inline bool emitFrame(std::list<NfcFrame> &frames, bool truncated)
    {
-      return false;
+      int frameType = streamStatus.bytes > 1 && (streamStatus.buffer[1] & 1) ? ListenFrame : PollFrame;
+
+      NfcFrame frame = NfcFrame(TechType::NfcF, frameType);
+
+      frame.setFrameRate(decoder->bitrate->symbolsPerSecond);
+      frame.setSampleStart(frameStatus.frameStart);
+      frame.setSampleEnd(frameStatus.frameEnd);
+      frame.setTimeStart(double(frameStatus.frameStart) / double(decoder->sampleRate));
+      frame.setTimeEnd(double(frameStatus.frameEnd) / double(decoder->sampleRate));
+
+      if (truncated)
+         frame.setFrameFlags(FrameFlags::Truncated);
+
+      // add bytes to frame and flip to prepare read
+      frame.put(streamStatus.buffer, streamStatus.bytes).flip();
+
+      // process frame
+      process(frame);
+
+      // add to frame list
+      frames.push_back(frame);
+
+      // reset modulation status
+      resetModulation();
+
+      return true;
    }
 
-   inline bool decodeListenFrame(sdr::SignalBuffer &buffer, std::list<NfcFrame> &frames)
+   /*
+    * Reset preamble search for one rate, shared correlator values are not touched
+    */
+   inline static void resetSearch(ModulationStatus *modulation)
    {
-      return false;
+      modulation->searchStage = PREAMBLE_SEARCH;
+      modulation->searchStartTime = 0;
+      modulation->searchEndTime = 0;
+      modulation->searchPeakTime = 0;
+      modulation->searchPulseWidth = 0;
+      modulation->searchDeepValue = 0;
+      modulation->correlationPeek = 0;
+      modulation->symbolCorr0 = 0;
+      modulation->symbolCorr1 = 0;
+   }
+
+   /*
+    * Reset after signal discontinuity, integrators are cleared and frame in progress is discarded
+    */
+   inline void reset()
+   {
+      // clear modulation integrators and search status
+      for (auto &modulation: modulationStatus)
+         modulation = {0,};
+
+      // clear modulation buffers
+      modulationBuffer.reset(modulationStatus, bitrateParams, 4);
+
+      // clear stream, symbol and frame status
+      resetModulation();
+   }
+
+   /*
+    * Store decoder status in snapshot
+    */
+   inline void saveStatus(StatusSnapshot &snapshot) const
+   {
+      snapshot.save(bitrateParams);
+      snapshot.save(symbolStatus);
+      snapshot.save(streamStatus);
+      snapshot.save(frameStatus);
+      snapshot.save(protocolStatus);
+      snapshot.save(modulationStatus);
+      snapshot.save(modulationBuffer.data);
+      snapshot.save(minimumModulationThreshold);
+      snapshot.save(maximumModulationThreshold);
+      snapshot.save(slotCount);
+      snapshot.save(slotMissed);
+      snapshot.save(syncPattern);
+      snapshot.save(syncPhase);
+      snapshot.save(syncInverted);
+      snapshot.save(lastFrameEnd);
+      snapshot.save(chainedFlags);
+
+      // detected modulation is stored only if owned by this tech
+      snapshot.saveIndex(decoder->bitrate, bitrateParams, 4);
+      snapshot.saveIndex(decoder->modulation, modulationStatus, 4);
+   }
+
+   /*
+    * Restore decoder status from snapshot, tech must be configured with same sample rate
+    */
+   inline bool loadStatus(StatusSnapshot &snapshot)
+   {
+      snapshot.load(bitrateParams);
+      snapshot.load(symbolStatus);
+      snapshot.load(streamStatus);
+      snapshot.load(frameStatus);
+      snapshot.load(protocolStatus);
+      snapshot.load(modulationStatus);
+      snapshot.load(modulationBuffer.data);
+      modulationBuffer.bind(modulationStatus, bitrateParams, 4);
+      snapshot.load(minimumModulationThreshold);
+      snapshot.load(maximumModulationThreshold);
+      snapshot.load(slotCount);
+      snapshot.load(slotMissed);
+      snapshot.load(syncPattern);
+      snapshot.load(syncPhase);
+      snapshot.load(syncInverted);
+      snapshot.load(lastFrameEnd);
+      snapshot.load(chainedFlags);
+
+      // restore detected modulation if owned by this tech
+      snapshot.loadIndex(decoder->bitrate, bitrateParams, 4);
+      snapshot.loadIndex(decoder->modulation, modulationStatus, 4);
+
+      return snapshot.valid;
+   }
+
+   /*
+    * Reset modulation status
+    */
+   inline void resetModulation()
+   {
+      // reset modulation detection for all rates
+      for (int rate = r212k; rate <= r424k; rate++)
+      {
+         resetSearch(modulationStatus + rate);
+
+         modulationStatus[rate].symbolSyncTime = 0;
+      }
+
+      // clear stream status
+      streamStatus = {0,};
+
+      // clear stream status
+      symbolStatus = {0,};
+
+      // clear frame status
+      frameStatus.frameType = 0;
+      frameStatus.frameStart = 0;
+      frameStatus.frameEnd = 0;
+
+      // clear sync status
+      slotCount = 0;
+      slotMissed = 0;
+      syncPhase = -1;
+      syncInverted = false;
+
+      // restore bitrate
+      decoder->bitrate = nullptr;
+
+      // restore modulation
+      decoder->modulation = nullptr;
+   }
+
+   /*
+    * Process request or response frame
+    */
+   inline void process(NfcFrame &frame)
+   {
+      do
+      {
+         if (processPolling(frame))
+            break;
+
+         processOther(frame);
+
+      } while (false);
+
+      // set chained flags
+      frame.setFrameFlags(chainedFlags);
+
+      // mark last processed frame
+      lastFrameEnd = frameStatus.frameEnd;
+   }
+
+   /*
+    * Process SENSF_REQ / SENSF_RES frame
+    */
+   inline bool processPolling(NfcFrame &frame)
+   {
+      if (frame.limit() < 2 || (frame[1] != 0x00 && frame[1] != 0x01))
+         return false;
+
+      frame.setFramePhase(FramePhase::SelectionFrame);
+      frame.setFrameFlags(!frame.hasFrameFlags(FrameFlags::Truncated) && !checkCrc(frame) ? FrameFlags::CrcError : 0);
+
+      return true;
+   }
+
+   /*
+    * Process other frames
+    */
+   inline void processOther(NfcFrame &frame)
+   {
+      frame.setFramePhase(FramePhase::ApplicationFrame);
+      frame.setFrameFlags(!frame.hasFrameFlags(FrameFlags::Truncated) && !checkCrc(frame) ? FrameFlags::CrcError : 0);
+   }
+
+   /*
+    * Check NFC-F crc
+    */
+   static inline bool checkCrc(NfcFrame &frame)
+   {
+      unsigned short crc = 0x0000; // NFC-F CRC-CCITT, MSB first
+      unsigned short res = 0;
+
+      int length = frame.limit();
+
+      if (length <= 2)
+         return false;
+
+      for (int i = 0; i < length - 2; i++)
+      {
+         crc ^= ((unsigned int) frame[i] & 0xff) << 8;
+
+         for (int b = 0; b < 8; b++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+      }
+
+      res |= ((unsigned int) frame[length - 2] & 0xff) << 8;
+      res |= ((unsigned int) frame[length - 1] & 0xff);
+
+      return res == crc;
    }
 };
 
@@ -128,6 +665,21 @@ void NfcF::configure(long sampleRate)
    self->configure(sampleRate);
 }
 
+void NfcF::reset()
+{
+   self->reset();
+}
+
+void NfcF::saveStatus(StatusSnapshot &snapshot) const
+{
+   self->saveStatus(snapshot);
+}
+
+bool NfcF::loadStatus(StatusSnapshot &snapshot)
+{
+   return self->loadStatus(snapshot);
+}
+
 bool NfcF::detect()
 {
    return self->detectModulation();
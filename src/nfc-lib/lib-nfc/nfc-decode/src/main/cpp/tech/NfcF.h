@@ -52,6 +52,12 @@ struct NfcF
 
    void configure(long sampleRate);
 
+   void reset();
+
+   void saveStatus(StatusSnapshot &snapshot) const;
+
+   bool loadStatus(StatusSnapshot &snapshot);
+
    bool detect();
 
    void decode(sdr::SignalBuffer &samples, std::list<NfcFrame> &frames);
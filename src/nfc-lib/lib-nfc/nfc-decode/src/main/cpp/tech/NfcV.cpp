@@ -73,11 +73,14 @@ struct NfcV::Impl
    // modulation status for each bitrate
    ModulationStatus modulationStatus {0,};
 
+   // modulation ring buffers
+   ModulationBuffer modulationBuffer;
+
    // minimum modulation threshold to detect valid signal for NFC-V (default 85%)
    float minimumModulationThreshold = 0.850f;
 
    // last detected frame end
-   unsigned int lastFrameEnd = 0;
+   unsigned long long lastFrameEnd = 0;
 
    // chained frame flags
    unsigned int chainedFlags = 0;
@@ -137,6 +140,12 @@ struct NfcV::Impl
       bitrateParams.offsetDelay4Index = BUFFER_SIZE - bitrateParams.period4SymbolSamples;
       bitrateParams.offsetDelay8Index = BUFFER_SIZE - bitrateParams.period8SymbolSamples;
 
+      // signal buffers must reach oldest sample used
+      decoder->reserveSignalBuffer(bitrateParams.period0SymbolSamples);
+
+      // allocate modulation buffers sized for symbol period
+      modulationBuffer.configure(&modulationStatus, &bitrateParams, 1);
+
       // exponential symbol average
       bitrateParams.symbolAverageW0 = float(1 - 5.0 / bitrateParams.period1SymbolSamples);
       bitrateParams.symbolAverageW1 = float(1 - bitrateParams.symbolAverageW0);
@@ -210,8 +219,8 @@ struct NfcV::Impl
       modulation->delay2Index = (bitrate->offsetDelay2Index + decoder->signalClock);
 
       // get signal samples
-      float signalData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
-      float delay2Data = decoder->signalStatus.signalData[modulation->delay2Index & (BUFFER_SIZE - 1)];
+      float signalData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
+      float delay2Data = decoder->signalStatus.signalData[modulation->delay2Index & decoder->signalParams.signalBufferMask];
 
       // integrate signal data over 1/2 symbol
       modulation->filterIntegrate += signalData; // add new value
@@ -605,8 +614,8 @@ struct NfcV::Impl
          modulation->delay2Index = (bitrate->offsetDelay2Index + decoder->signalClock);
 
          // get signal samples
-         float currentData = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
-         float delayedData = decoder->signalStatus.signalData[modulation->delay2Index & (BUFFER_SIZE - 1)];
+         float currentData = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
+         float delayedData = decoder->signalStatus.signalData[modulation->delay2Index & decoder->signalParams.signalBufferMask];
 
          // integrate signal data over 1/2 symbol
          modulation->filterIntegrate += currentData; // add new value
@@ -744,9 +753,9 @@ struct NfcV::Impl
          modulation->delay0Index = (bitrate->offsetDelay0Index + decoder->signalClock);
 
          // get signal samples
-         float signalData = decoder->signalStatus.signalData[modulation->delay1Index & (BUFFER_SIZE - 1)];
-         float signalMDev = decoder->signalStatus.signalMdev[modulation->delay1Index & (BUFFER_SIZE - 1)];
-         float signalDeep = decoder->signalStatus.signalDeep[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float signalData = decoder->signalStatus.signalData[modulation->delay1Index & decoder->signalParams.signalBufferMask];
+         float signalMDev = decoder->signalStatus.signalMdev[modulation->delay1Index & decoder->signalParams.signalBufferMask];
+         float signalDeep = decoder->signalStatus.signalDeep[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
          // compute symbol average (signal offset)
          modulation->symbolAverage = modulation->symbolAverage * bitrate->symbolAverageW0 + signalData * bitrate->symbolAverageW1;
@@ -755,7 +764,7 @@ struct NfcV::Impl
          signalData -= modulation->symbolAverage;
 
          // store signal square in filter buffer
-         modulation->integrationData[modulation->delay1Index & (BUFFER_SIZE - 1)] = signalData * signalData;
+         modulation->integrationData[modulation->delay1Index & modulation->integrationMask] = signalData * signalData;
 
          // start correlation after frameGuardTime
          if (decoder->signalClock < (frameStatus.guardEnd - bitrate->period0SymbolSamples))
@@ -766,8 +775,8 @@ struct NfcV::Impl
          modulation->filterPoint2 = (modulation->delay1Index + bitrate->period1SymbolSamples) % bitrate->period0SymbolSamples;
 
          // integrate symbol (moving average)
-         modulation->filterIntegrate += modulation->integrationData[modulation->delay1Index & (BUFFER_SIZE - 1)]; // add new value
-         modulation->filterIntegrate -= modulation->integrationData[modulation->delay0Index & (BUFFER_SIZE - 1)]; // remove delayed value
+         modulation->filterIntegrate += modulation->integrationData[modulation->delay1Index & modulation->integrationMask]; // add new value
+         modulation->filterIntegrate -= modulation->integrationData[modulation->delay0Index & modulation->integrationMask]; // remove delayed value
 
          // store integrated signal in correlation buffer
          modulation->correlationData[modulation->filterPoint1] = modulation->filterIntegrate;
@@ -921,8 +930,8 @@ struct NfcV::Impl
          modulation->delay0Index = (bitrate->offsetDelay0Index + decoder->signalClock);
 
          // get signal samples
-         float signalData = decoder->signalStatus.signalData[modulation->delay1Index & (BUFFER_SIZE - 1)];
-//         float signalDeep = decoder->signalStatus.signalData[modulation->signalIndex & (BUFFER_SIZE - 1)];
+         float signalData = decoder->signalStatus.signalData[modulation->delay1Index & decoder->signalParams.signalBufferMask];
+//         float signalDeep = decoder->signalStatus.signalData[modulation->signalIndex & decoder->signalParams.signalBufferMask];
 
          // compute symbol average (signal offset)
          modulation->symbolAverage = modulation->symbolAverage * bitrate->symbolAverageW0 + signalData * bitrate->symbolAverageW1;
@@ -931,15 +940,15 @@ struct NfcV::Impl
          signalData -= modulation->symbolAverage;
 
          // store signal square in filter buffer
-         modulation->integrationData[modulation->delay1Index & (BUFFER_SIZE - 1)] = signalData * signalData;
+         modulation->integrationData[modulation->delay1Index & modulation->integrationMask] = signalData * signalData;
 
          // compute correlation points
          modulation->filterPoint1 = (modulation->delay1Index % bitrate->period0SymbolSamples);
          modulation->filterPoint2 = (modulation->delay1Index + bitrate->period1SymbolSamples) % bitrate->period0SymbolSamples;
 
          // integrate symbol (moving average)
-         modulation->filterIntegrate += modulation->integrationData[modulation->delay1Index & (BUFFER_SIZE - 1)]; // add new value
-         modulation->filterIntegrate -= modulation->integrationData[modulation->delay0Index & (BUFFER_SIZE - 1)]; // remove delayed value
+         modulation->filterIntegrate += modulation->integrationData[modulation->delay1Index & modulation->integrationMask]; // add new value
+         modulation->filterIntegrate -= modulation->integrationData[modulation->delay0Index & modulation->integrationMask]; // remove delayed value
 
          // store integrated signal in correlation buffer
          modulation->correlationData[modulation->filterPoint1] = modulation->filterIntegrate;
@@ -1022,6 +1031,70 @@ struct NfcV::Impl
       return pattern;
    }
 
+   /*
+    * Reset after signal discontinuity, integrators are cleared and frame in progress is discarded
+    */
+   inline void reset()
+   {
+      // clear modulation integrators and search status
+      modulationStatus = {0,};
+
+      // clear modulation buffers
+      modulationBuffer.reset(&modulationStatus, &bitrateParams, 1);
+
+      // clear stream, symbol and frame status
+      resetModulation();
+   }
+
+   /*
+    * Store decoder status in snapshot
+    */
+   inline void saveStatus(StatusSnapshot &snapshot) const
+   {
+      snapshot.save(pulseParams);
+      snapshot.save(bitrateParams);
+      snapshot.save(symbolStatus);
+      snapshot.save(streamStatus);
+      snapshot.save(frameStatus);
+      snapshot.save(protocolStatus);
+      snapshot.save(modulationStatus);
+      snapshot.save(modulationBuffer.data);
+      snapshot.save(minimumModulationThreshold);
+      snapshot.save(lastFrameEnd);
+      snapshot.save(chainedFlags);
+
+      // detected modulation is stored only if owned by this tech
+      snapshot.saveIndex(decoder->pulse, pulseParams, 2);
+      snapshot.saveIndex(decoder->bitrate, &bitrateParams, 1);
+      snapshot.saveIndex(decoder->modulation, &modulationStatus, 1);
+   }
+
+   /*
+    * Restore decoder status from snapshot, tech must be configured with same sample rate
+    */
+   inline bool loadStatus(StatusSnapshot &snapshot)
+   {
+      snapshot.load(pulseParams);
+      snapshot.load(bitrateParams);
+      snapshot.load(symbolStatus);
+      snapshot.load(streamStatus);
+      snapshot.load(frameStatus);
+      snapshot.load(protocolStatus);
+      snapshot.load(modulationStatus);
+      snapshot.load(modulationBuffer.data);
+      modulationBuffer.bind(&modulationStatus, &bitrateParams, 1);
+      snapshot.load(minimumModulationThreshold);
+      snapshot.load(lastFrameEnd);
+      snapshot.load(chainedFlags);
+
+      // restore detected modulation if owned by this tech
+      snapshot.loadIndex(decoder->pulse, pulseParams, 2);
+      snapshot.loadIndex(decoder->bitrate, &bitrateParams, 1);
+      snapshot.loadIndex(decoder->modulation, &modulationStatus, 1);
+
+      return snapshot.valid;
+   }
+
    /*
    * Reset modulation status
    */
@@ -1180,6 +1253,21 @@ void NfcV::configure(long sampleRate)
    self->configure(sampleRate);
 }
 
+void NfcV::reset()
+{
+   self->reset();
+}
+
+void NfcV::saveStatus(StatusSnapshot &snapshot) const
+{
+   self->saveStatus(snapshot);
+}
+
+bool NfcV::loadStatus(StatusSnapshot &snapshot)
+{
+   return self->loadStatus(snapshot);
+}
+
 bool NfcV::detect()
 {
    return self->detectModulation();
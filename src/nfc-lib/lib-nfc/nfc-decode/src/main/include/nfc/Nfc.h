@@ -99,6 +99,16 @@ constexpr int NFCB_TR0_MIN_TABLE[] = {0, 48 * 16, 16 * 16, 0};
 // TR1min, in 1/FC units
 constexpr int NFCB_TR1_MIN_TABLE[] = {0, 64 * 16, 16 * 16, 0};
 
+/*
+ * NFC-F parameters
+ */
+
+// NFC-F SYNC code sent after preamble, B2h 4Dh
+constexpr int NFCF_SYNC_CODE = 0xB24D;
+
+// NFC-F minimum preamble length, in bits (all zero)
+constexpr int NFCF_PREAMBLE_LEN = 48;
+
 /*
  * NFC-V parameters
  */
@@ -0,0 +1,74 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#ifndef NFC_NFCCHECKPOINT_H
+#define NFC_NFCCHECKPOINT_H
+
+#include <string>
+#include <memory>
+
+#include <rt/ByteBuffer.h>
+
+namespace nfc {
+
+/*
+ * decoder status snapshots stored alongside a recording, indexed by stream sample offset
+ */
+class NfcCheckpoint
+{
+      struct Impl;
+
+   public:
+
+      enum OpenMode
+      {
+         Read = 1,
+         Write = 2
+      };
+
+      explicit NfcCheckpoint(const std::string &name);
+
+      bool open(OpenMode mode);
+
+      void close();
+
+      bool isOpen() const;
+
+      int count() const;
+
+      // append decoder status snapshot taken at given stream offset
+      bool write(long long offset, const rt::ByteBuffer &status);
+
+      // nearest snapshot at or before given stream offset, invalid buffer if none
+      rt::ByteBuffer find(long long offset, long long *found = nullptr);
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif //NFC_NFCCHECKPOINT_H
\ No newline at end of file
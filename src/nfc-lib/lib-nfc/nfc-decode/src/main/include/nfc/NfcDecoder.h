@@ -26,7 +26,9 @@
 #define NFC_NFCDECODER_H
 
 #include <list>
+#include <string>
 
+#include <rt/ByteBuffer.h>
 #include <rt/FloatBuffer.h>
 
 #include <sdr/SignalBuffer.h>
@@ -41,6 +43,13 @@ class NfcDecoder
 
    public:
 
+      // envelope kernels accepted by decoder, squared power from sdr::SignalBuffer does not fit modulation thresholds
+      enum EnvelopeKernel
+      {
+         Exact = sdr::SignalBuffer::Exact,
+         AlphaMaxBetaMin = sdr::SignalBuffer::AlphaMaxBetaMin
+      };
+
       NfcDecoder();
 
       std::list<NfcFrame> nextFrames(sdr::SignalBuffer samples);
@@ -57,6 +66,12 @@ class NfcDecoder
 
       void setPowerLevelThreshold(float value);
 
+      // kernel by value, Exact or AlphaMaxBetaMin, any other is ignored
+      void setEnvelopeKernel(int kernel);
+
+      // kernel by name, "exact" or "alphaMaxBetaMin"
+      void setEnvelopeKernel(const std::string &name);
+
       void setModulationThresholdNfcA(float min, float max);
 
       void setModulationThresholdNfcB(float min, float max);
@@ -67,8 +82,18 @@ class NfcDecoder
 
       float powerLevelThreshold() const;
 
+      int envelopeKernel() const;
+
       float signalStrength() const;
 
+      long long streamOffset() const;
+
+      // snapshot of decoder status, taken between nextFrames calls
+      rt::ByteBuffer saveStatus() const;
+
+      // restore decoder status, next samples must continue from restored streamOffset
+      bool loadStatus(const rt::ByteBuffer &status);
+
    private:
 
       std::shared_ptr<Impl> impl;
@@ -109,13 +109,13 @@ class NfcFrame : public rt::ByteBuffer
 
       void setTimeEnd(double end);
 
-      unsigned long sampleStart() const;
+      unsigned long long sampleStart() const;
 
-      void setSampleStart(unsigned long start);
+      void setSampleStart(unsigned long long start);
 
-      unsigned long sampleEnd() const;
+      unsigned long long sampleEnd() const;
 
-      void setSampleEnd(unsigned long end);
+      void setSampleEnd(unsigned long long end);
 
    private:
 
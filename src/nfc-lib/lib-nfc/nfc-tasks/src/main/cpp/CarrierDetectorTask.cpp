@@ -66,7 +66,8 @@ struct CarrierDetectorTask::Impl : CarrierDetectorTask, AbstractTask
 
    bool loop() override
    {
-      wait(50);
+      // wait until next status update
+      wait(500);
 
       /*
       * update recorder status
@@ -32,6 +32,7 @@
 #include <nfc/FourierProcessTask.h>
 
 #include "AbstractTask.h"
+#include "TaskMetrics.h"
 
 namespace nfc {
 
@@ -68,10 +69,16 @@ struct FourierProcessTask::Impl : FourierProcessTask, AbstractTask
    // last signal buffer
    sdr::SignalBuffer signalBuffer;
 
+   // last FFT process time
+   std::chrono::time_point<std::chrono::steady_clock> lastProcess;
+
    // stream lock
    std::mutex signalMutex;
 
-   explicit Impl(int length = 1024) : AbstractTask("FourierProcessTask", "fourier"), status(FourierProcessTask::Idle), length(length)
+   // shared pipeline metrics
+   TaskMetrics &metrics;
+
+   explicit Impl(int length = 1024) : AbstractTask("FourierProcessTask", "fourier"), status(FourierProcessTask::Idle), length(length), metrics(TaskMetrics::global())
    {
       fftIn = static_cast<float *>(mufft_alloc(length * sizeof(float) * 2));
       fftOut = static_cast<float *>(mufft_alloc(length * sizeof(float) * 2));
@@ -89,8 +96,15 @@ struct FourierProcessTask::Impl : FourierProcessTask, AbstractTask
       signalSubscription = signalStream->subscribe([=](const sdr::SignalBuffer &buffer) {
          if (signalMutex.try_lock())
          {
-            signalBuffer = buffer;
+            bool idle = !signalBuffer.isValid();
+
+            // keep only samples used by transform, borrowed buffers copy just this window
+            signalBuffer = buffer.slice(0, length * decimation);
             signalMutex.unlock();
+
+            // only wake up worker when leaving idle state, otherwise is paced by frame rate
+            if (idle)
+               notify();
          }
       });
    }
@@ -119,11 +133,27 @@ struct FourierProcessTask::Impl : FourierProcessTask, AbstractTask
 
    bool loop() override
    {
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lastProcess).count();
+
       // process FFT at 20 fps (50ms)
-      wait(50);
+      if (elapsed < 50)
+      {
+         wait(int(50 - elapsed));
+      }
+      else if (process())
+      {
+         // fast fourier transform computed for last buffer
+         status = FourierProcessTask::Transform;
+
+         lastProcess = std::chrono::steady_clock::now();
+      }
+      else
+      {
+         // no signal, wait until next buffer arrives or next status update
+         status = FourierProcessTask::Idle;
 
-      // compute fast fourier transform
-      process();
+         wait(500);
+      }
 
       // update recorder status
       if ((std::chrono::steady_clock::now() - lastStatus) > std::chrono::milliseconds(500))
@@ -134,21 +164,39 @@ struct FourierProcessTask::Impl : FourierProcessTask, AbstractTask
       return true;
    }
 
-   void process()
+   bool process()
    {
       std::lock_guard<std::mutex> lock(signalMutex);
 
       // IQ complex signal to real FFT transform
-      if (signalBuffer.isValid() && signalBuffer.stride() == 2)
+      if (signalBuffer.isValid() && signalBuffer.isComplex())
       {
-         float *data = signalBuffer.data();
+         long long start = TaskMetrics::now();
 
-         // apply signal windowing and decimation
-         #pragma GCC ivdep
-         for (int i = 0, w = 0; w < length; i += 2, w++)
+         // packed 16 bit I/Q pairs, normalized to float range
+         if (signalBuffer.sampleType() == sdr::SignalDevice::Integer)
          {
-            fftIn[i + 0] = data[decimation * i + 0] * fftWin[w];
-            fftIn[i + 1] = data[decimation * i + 1] * fftWin[w];
+            auto data = reinterpret_cast<const short *>(signalBuffer.data());
+
+            // apply signal windowing and decimation
+            #pragma GCC ivdep
+            for (int i = 0, w = 0; w < length; i += 2, w++)
+            {
+               fftIn[i + 0] = data[decimation * i + 0] * (fftWin[w] / 32768);
+               fftIn[i + 1] = data[decimation * i + 1] * (fftWin[w] / 32768);
+            }
+         }
+         else
+         {
+            float *data = signalBuffer.data();
+
+            // apply signal windowing and decimation
+            #pragma GCC ivdep
+            for (int i = 0, w = 0; w < length; i += 2, w++)
+            {
+               fftIn[i + 0] = data[decimation * i + 0] * fftWin[w];
+               fftIn[i + 1] = data[decimation * i + 1] * fftWin[w];
+            }
          }
 
          // execute FFT
@@ -169,11 +217,29 @@ struct FourierProcessTask::Impl : FourierProcessTask, AbstractTask
 
          // publish to observers
          frequencyStream->next(result);
+
+         // release processed buffer, next one wakes up worker
+         signalBuffer.reset();
+
+         metrics.fourierTransforms.add();
+         metrics.fourierProcessTime.record((TaskMetrics::now() - start) / 1000);
+
+         return true;
       }
+
+      return false;
    }
 
    void updateFourierStatus()
    {
+      json data({
+                      {"status",     status == Transform ? "transform" : "idle"},
+                      {"transforms", metrics.fourierTransforms.get()}
+                });
+
+      updateStatus(status, data);
+
+      lastStatus = std::chrono::steady_clock::now();
    }
 };
 
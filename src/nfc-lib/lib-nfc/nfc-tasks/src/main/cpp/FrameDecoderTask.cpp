@@ -25,10 +25,12 @@
 #include <rt/Logger.h>
 #include <rt/BlockingQueue.h>
 
+#include <nfc/Nfc.h>
 #include <nfc/NfcDecoder.h>
 #include <nfc/FrameDecoderTask.h>
 
 #include "AbstractTask.h"
+#include "TaskMetrics.h"
 
 namespace nfc {
 
@@ -46,16 +48,26 @@ struct FrameDecoderTask::Impl : FrameDecoderTask, AbstractTask
    // signal stream subscription
    rt::Subject<sdr::SignalBuffer>::Subscription signalSubscription;
 
+   // signal buffer with arrival time, for latency measurement
+   struct SignalEntry
+   {
+      sdr::SignalBuffer buffer;
+      long long arrival;
+   };
+
    // signal stream queue buffer
-   rt::BlockingQueue<sdr::SignalBuffer> signalQueue;
+   rt::BlockingQueue<SignalEntry> signalQueue;
 
    // decoder
    std::shared_ptr<nfc::NfcDecoder> decoder;
 
+   // shared pipeline metrics
+   TaskMetrics &metrics;
+
    // last status sent
    std::chrono::time_point<std::chrono::steady_clock> lastStatus;
 
-   Impl() : AbstractTask("FrameDecoderTask", "decoder"), status(FrameDecoderTask::Halt), decoder(new nfc::NfcDecoder())
+   Impl() : AbstractTask("FrameDecoderTask", "decoder"), status(FrameDecoderTask::Halt), decoder(new nfc::NfcDecoder()), metrics(TaskMetrics::global())
    {
       // access to signal subject stream
       signalSubject = rt::Subject<sdr::SignalBuffer>::name("signal.iq");
@@ -66,8 +78,16 @@ struct FrameDecoderTask::Impl : FrameDecoderTask, AbstractTask
       // subscribe to signal events
       signalSubscription = signalSubject->subscribe([this](const sdr::SignalBuffer &buffer) {
          if (status == FrameDecoderTask::Listen)
-            signalQueue.add(buffer);
+         {
+            signalQueue.add({buffer, TaskMetrics::now()});
+
+            metrics.decoderQueueDepth.set(signalQueue.size());
+         }
       });
+
+      // wake up worker on new commands or signal buffers
+      watch(commandQueue);
+      watch(signalQueue);
    }
 
    void start() override
@@ -83,21 +103,21 @@ struct FrameDecoderTask::Impl : FrameDecoderTask, AbstractTask
       /*
        * process pending commands
        */
-      if (auto command = commandQueue.get())
+      for (auto &command : commandQueue.drain())
       {
-         log.info("decoder command [{}]", {command->code});
+         log.info("decoder command [{}]", {command.code});
 
-         if (command->code == FrameDecoderTask::Start)
+         if (command.code == FrameDecoderTask::Start)
          {
-            startDecoder(command.value());
+            startDecoder(command);
          }
-         else if (command->code == FrameDecoderTask::Stop)
+         else if (command.code == FrameDecoderTask::Stop)
          {
-            stopDecoder(command.value());
+            stopDecoder(command);
          }
-         else if (command->code == FrameDecoderTask::Configure)
+         else if (command.code == FrameDecoderTask::Configure)
          {
-            configDecoder(command.value());
+            configDecoder(command);
          }
       }
 
@@ -108,10 +128,11 @@ struct FrameDecoderTask::Impl : FrameDecoderTask, AbstractTask
       {
          signalDecode();
       }
-      else
-      {
-         wait(50);
-      }
+
+      /*
+       * wait until new commands or signal buffers arrive
+       */
+      wait();
 
       return true;
    }
@@ -154,6 +175,15 @@ struct FrameDecoderTask::Impl : FrameDecoderTask, AbstractTask
          if (config.contains("powerLevelThreshold"))
             decoder->setPowerLevelThreshold(config["powerLevelThreshold"]);
 
+         // signal envelope kernel, by name or by value
+         if (config.contains("envelopeKernel"))
+         {
+            if (config["envelopeKernel"].is_string())
+               decoder->setEnvelopeKernel(config["envelopeKernel"].get<std::string>());
+            else
+               decoder->setEnvelopeKernel(config["envelopeKernel"].get<int>());
+         }
+
          // NFC-A parameters
          if (config.contains("nfca"))
          {
@@ -244,19 +274,53 @@ struct FrameDecoderTask::Impl : FrameDecoderTask, AbstractTask
 
    void signalDecode()
    {
-      if (auto buffer = signalQueue.get())
+      bool finished = false;
+
+      for (auto &entry : signalQueue.drain())
       {
-         for (const auto &frame : decoder->nextFrames(buffer.value()))
+         auto &buffer = entry.buffer;
+
+         long long start = TaskMetrics::now();
+
+         metrics.decoderQueueLatency.record((start - entry.arrival) / 1000);
+
+         for (const auto &frame : decoder->nextFrames(buffer))
          {
             frameSubject->next(frame);
+
+            if (frame.techType() <= nfc::TechType::NfcV)
+               metrics.decoderFrames[frame.techType()].add();
          }
 
-         if (!buffer->isValid())
+         if (buffer.isValid())
          {
-            log.info("decoder EOF buffer received, finish!");
+            long long elapsed = TaskMetrics::now() - start;
+            unsigned int samples = buffer.elements();
+
+            metrics.decoderSampleRate.set(buffer.sampleRate());
+            metrics.decoderLastBuffer.set(start);
+            metrics.decoderSamples.add(samples);
+            metrics.decoderNanos.add(elapsed);
+
+            if (samples > 0)
+               metrics.decoderSampleCost.record(elapsed / samples);
 
-            updateDecoderStatus(FrameDecoderTask::Halt);
+            finished = false;
          }
+         else
+         {
+            finished = true;
+         }
+      }
+
+      metrics.decoderQueueDepth.set(signalQueue.size());
+
+      // buffers queued after EOF belong to a new stream, stop only if batch ends with EOF
+      if (finished)
+      {
+         log.info("decoder EOF buffer received, finish!");
+
+         updateDecoderStatus(FrameDecoderTask::Halt);
       }
    }
 
@@ -63,6 +63,9 @@ struct FrameStorageTask::Impl : FrameStorageTask, AbstractTask
       decoderSubscription = decoderStream->subscribe([this](const nfc::NfcFrame &frame) {
          frameQueue.add(frame);
       });
+
+      // wake up worker on new commands
+      watch(commandQueue);
    }
 
    void start() override
@@ -78,25 +81,28 @@ struct FrameStorageTask::Impl : FrameStorageTask, AbstractTask
       /*
        * first process pending commands
        */
-      if (auto command = commandQueue.get())
+      for (auto &command : commandQueue.drain())
       {
-         log.info("recorder command [{}]", {command->code});
+         log.info("recorder command [{}]", {command.code});
 
-         if (command->code == FrameStorageTask::Read)
+         if (command.code == FrameStorageTask::Read)
          {
-            readFile(command.value());
+            readFile(command);
          }
-         else if (command->code == FrameStorageTask::Write)
+         else if (command.code == FrameStorageTask::Write)
          {
-            writeFile(command.value());
+            writeFile(command);
          }
-         else if (command->code == FrameStorageTask::Clear)
+         else if (command.code == FrameStorageTask::Clear)
          {
-            clearQueue(command.value());
+            clearQueue(command);
          }
       }
 
-      wait(250);
+      /*
+       * wait until new commands arrive
+       */
+      wait();
 
       return true;
    }
@@ -0,0 +1,275 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+#include <fstream>
+
+#include <rt/Logger.h>
+#include <rt/BlockingQueue.h>
+
+#include <nfc/Nfc.h>
+#include <nfc/MetricsMonitorTask.h>
+
+#include "AbstractTask.h"
+#include "TaskMetrics.h"
+
+namespace nfc {
+
+struct MetricsMonitorTask::Impl : MetricsMonitorTask, AbstractTask
+{
+   // monitor status
+   int status;
+
+   // metrics publish interval
+   int interval;
+
+   // shared pipeline metrics
+   TaskMetrics &metrics;
+
+   // metrics dump file
+   std::ofstream output;
+
+   // counter values at last update, for rate calculation
+   struct Snapshot
+   {
+      long long time = 0;
+      unsigned long long receiverBuffers = 0;
+      unsigned long long receiverSamples = 0;
+      unsigned long long decoderSamples = 0;
+      unsigned long long decoderNanos = 0;
+      unsigned long long decoderFrames[5] {};
+      unsigned long long recorderSamples = 0;
+      unsigned long long fourierTransforms = 0;
+   } last;
+
+   explicit Impl(int interval = 1000) : AbstractTask("MetricsMonitorTask", "metrics"), status(MetricsMonitorTask::Idle), interval(interval), metrics(TaskMetrics::global())
+   {
+      // wake up worker on new commands
+      watch(commandQueue);
+   }
+
+   void start() override
+   {
+      last.time = TaskMetrics::now();
+   }
+
+   void stop() override
+   {
+      if (output.is_open())
+         output.close();
+   }
+
+   bool loop() override
+   {
+      /*
+       * process pending commands
+       */
+      for (auto &command : commandQueue.drain())
+      {
+         log.info("metrics command [{}]", {command.code});
+
+         if (command.code == MetricsMonitorTask::Start)
+         {
+            startWriting(command);
+         }
+         else if (command.code == MetricsMonitorTask::Stop)
+         {
+            stopWriting(command);
+         }
+         else if (command.code == MetricsMonitorTask::Query)
+         {
+            command.resolve();
+
+            updateMetricsStatus();
+         }
+      }
+
+      /*
+       * publish metrics periodically
+       */
+      auto elapsed = (TaskMetrics::now() - last.time) / 1000000;
+
+      if (elapsed >= interval)
+      {
+         updateMetricsStatus();
+      }
+
+      /*
+       * wait until new commands arrive or next metrics update
+       */
+      elapsed = (TaskMetrics::now() - last.time) / 1000000;
+
+      wait(elapsed < interval ? int(interval - elapsed) : 1);
+
+      return true;
+   }
+
+   void startWriting(rt::Event &command)
+   {
+      if (auto file = command.get<std::string>("file"))
+      {
+         log.info("write metrics to file {}", {file.value()});
+
+         if (output.is_open())
+            output.close();
+
+         output.open(file.value(), std::ios::out | std::ios::app);
+
+         if (output.is_open())
+         {
+            status = MetricsMonitorTask::Writing;
+
+            command.resolve();
+         }
+         else
+         {
+            log.warn("unable to open metrics file {}", {file.value()});
+
+            command.reject();
+         }
+      }
+      else
+      {
+         command.reject();
+      }
+   }
+
+   void stopWriting(rt::Event &command)
+   {
+      if (output.is_open())
+      {
+         log.info("stop writing metrics");
+
+         output.close();
+      }
+
+      status = MetricsMonitorTask::Idle;
+
+      command.resolve();
+   }
+
+   void updateMetricsStatus()
+   {
+      long long now = TaskMetrics::now();
+
+      double seconds = double(now - last.time) / 1E9;
+
+      if (seconds <= 0)
+         return;
+
+      unsigned long long receiverBuffers = metrics.receiverBuffers.get();
+      unsigned long long receiverSamples = metrics.receiverSamples.get();
+      unsigned long long decoderSamples = metrics.decoderSamples.get();
+      unsigned long long decoderNanos = metrics.decoderNanos.get();
+      unsigned long long recorderSamples = metrics.recorderSamples.get();
+      unsigned long long fourierTransforms = metrics.fourierTransforms.get();
+
+      // decoder performance over the last interval
+      double decodedSamples = double(decoderSamples - last.decoderSamples);
+      double decodeSeconds = double(decoderNanos - last.decoderNanos) / 1E9;
+      long long sampleRate = metrics.decoderSampleRate.get();
+
+      json receiver({
+                          {"buffersPerSecond", double(receiverBuffers - last.receiverBuffers) / seconds},
+                          {"samplesPerSecond", double(receiverSamples - last.receiverSamples) / seconds},
+                          {"samplesDropped",   metrics.receiverSamplesDropped.get()},
+                          {"lastBufferAge",    bufferAge(metrics.receiverLastBuffer, now)},
+                          {"deliveryTime",     metrics.receiverDelivery.collect()}
+                    });
+
+      json decoder({
+                         {"queueDepth",       metrics.decoderQueueDepth.get()},
+                         {"samplesPerSecond", decodedSamples / seconds},
+                         {"nsPerSample",      decodedSamples > 0 ? decodeSeconds * 1E9 / decodedSamples : 0},
+                         {"realTimeFactor",   decodeSeconds > 0 && sampleRate > 0 ? (decodedSamples / double(sampleRate)) / decodeSeconds : 0},
+                         {"load",             decodeSeconds / seconds},
+                         {"lastBufferAge",    bufferAge(metrics.decoderLastBuffer, now)},
+                         {"queueLatency",     metrics.decoderQueueLatency.collect()},
+                         {"sampleCost",       metrics.decoderSampleCost.collect()}
+                   });
+
+      static const char *techNames[] = {"none", "nfca", "nfcb", "nfcf", "nfcv"};
+
+      for (int tech = nfc::TechType::NfcA; tech <= nfc::TechType::NfcV; tech++)
+      {
+         unsigned long long frames = metrics.decoderFrames[tech].get();
+
+         decoder["framesPerSecond"][techNames[tech]] = double(frames - last.decoderFrames[tech]) / seconds;
+
+         last.decoderFrames[tech] = frames;
+      }
+
+      json recorder({
+                          {"queueDepth",       metrics.recorderQueueDepth.get()},
+                          {"samplesPerSecond", double(recorderSamples - last.recorderSamples) / seconds}
+                    });
+
+      json fourier({
+                         {"transformsPerSecond", double(fourierTransforms - last.fourierTransforms) / seconds},
+                         {"processTime",         metrics.fourierProcessTime.collect()}
+                   });
+
+      json data({
+                      {"status",   status == Writing ? "writing" : "idle"},
+                      {"interval", seconds},
+                      {"receiver", receiver},
+                      {"decoder",  decoder},
+                      {"recorder", recorder},
+                      {"fourier",  fourier}
+                });
+
+      if (output.is_open())
+      {
+         output << data.dump() << std::endl;
+      }
+
+      updateStatus(status, data);
+
+      last.time = now;
+      last.receiverBuffers = receiverBuffers;
+      last.receiverSamples = receiverSamples;
+      last.decoderSamples = decoderSamples;
+      last.decoderNanos = decoderNanos;
+      last.recorderSamples = recorderSamples;
+      last.fourierTransforms = fourierTransforms;
+   }
+
+   // time since last buffer in milliseconds, or -1 if no buffer has been received yet
+   static double bufferAge(const MetricGauge &gauge, long long now)
+   {
+      long long time = gauge.get();
+
+      return time ? double(now - time) / 1E6 : -1;
+   }
+};
+
+MetricsMonitorTask::MetricsMonitorTask() : rt::Worker("MetricsMonitorTask")
+{
+}
+
+rt::Worker *MetricsMonitorTask::construct()
+{
+   return new MetricsMonitorTask::Impl;
+}
+
+}
\ No newline at end of file
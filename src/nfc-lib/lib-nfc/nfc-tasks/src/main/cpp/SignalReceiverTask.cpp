@@ -24,14 +24,19 @@
 
 #include <rt/Logger.h>
 #include <rt/Format.h>
+#include <rt/Executor.h>
 #include <rt/BlockingQueue.h>
 
 #include <sdr/SignalBuffer.h>
 #include <sdr/AirspyDevice.h>
+#include <sdr/DeviceFactory.h>
+#include <sdr/ReplayDevice.h>
+#include <sdr/SyntheticDevice.h>
 
 #include <nfc/SignalReceiverTask.h>
 
 #include "AbstractTask.h"
+#include "TaskMetrics.h"
 
 namespace nfc {
 
@@ -40,16 +45,29 @@ struct SignalReceiverTask::Impl : SignalReceiverTask, AbstractTask
    // radio device
    std::shared_ptr<sdr::RadioDevice> receiver;
 
+   // configured device name, if empty first available airspy is used
+   std::string deviceName;
+
    // signal buffer frame stream subject
    rt::Subject<sdr::SignalBuffer> *signalStream = nullptr;
 
+   // shared pipeline metrics
+   TaskMetrics &metrics;
+
    // last detection attempt
    std::chrono::time_point<std::chrono::steady_clock> lastSearch;
 
-   Impl() : AbstractTask("SignalReceiverTask", "receiver")
+   // scheduling for device stream thread
+   int streamPriority;
+   int streamCore;
+
+   Impl(int streamPriority, int streamCore) : AbstractTask("SignalReceiverTask", "receiver"), metrics(TaskMetrics::global()), streamPriority(streamPriority), streamCore(streamCore)
    {
       // access to signal subject stream
       signalStream = rt::Subject<sdr::SignalBuffer>::name("signal.iq");
+
+      // wake up worker on new commands
+      watch(commandQueue);
    }
 
    void start() override
@@ -71,37 +89,42 @@ struct SignalReceiverTask::Impl : SignalReceiverTask, AbstractTask
       /*
        * process pending commands
        */
-      if (auto command = commandQueue.get())
+      for (auto &command : commandQueue.drain())
       {
-         log.info("receiver command [{}]", {command->code});
+         log.info("receiver command [{}]", {command.code});
 
-         if (command->code == SignalReceiverTask::Start)
+         if (command.code == SignalReceiverTask::Start)
          {
-            startReceiver(command.value());
+            startReceiver(command);
          }
-         else if (command->code == SignalReceiverTask::Stop)
+         else if (command.code == SignalReceiverTask::Stop)
          {
-            stopReceiver(command.value());
+            stopReceiver(command);
          }
-         else if (command->code == SignalReceiverTask::Query)
+         else if (command.code == SignalReceiverTask::Query)
          {
-            queryReceiver(command.value());
+            queryReceiver(command);
          }
-         else if (command->code == SignalReceiverTask::Configure)
+         else if (command.code == SignalReceiverTask::Configure)
          {
-            configReceiver(command.value());
+            configReceiver(command);
          }
       }
 
       /*
       * process device refresh
       */
-      if ((std::chrono::steady_clock::now() - lastSearch) > std::chrono::milliseconds(500))
+      if ((std::chrono::steady_clock::now() - lastSearch) >= std::chrono::milliseconds(500))
       {
          refresh();
       }
 
-      wait(50);
+      /*
+       * wait until new commands arrive or next device refresh
+       */
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lastSearch).count();
+
+      wait(elapsed < 500 ? int(500 - elapsed) : 1);
 
       return true;
    }
@@ -110,7 +133,36 @@ struct SignalReceiverTask::Impl : SignalReceiverTask, AbstractTask
    {
       int mode = SignalReceiverTask::Statistics;
 
-      if (!receiver)
+      if (!receiver && !deviceName.empty())
+      {
+         // open configured receiver, such as synthetic://<script>
+         sdr::SignalDevice *device = sdr::DeviceFactory::newInstance(deviceName);
+
+         if (auto radio = dynamic_cast<sdr::RadioDevice *>(device))
+         {
+            receiver.reset(radio);
+
+            if (receiver->open(sdr::SignalDevice::Read))
+            {
+               log.info("device {} connected!", {deviceName});
+
+               mode = SignalReceiverTask::Attach;
+            }
+            else
+            {
+               receiver.reset();
+
+               log.warn("device {} open failed", {deviceName});
+            }
+         }
+         else
+         {
+            delete device;
+
+            log.warn("device {} is not a radio device", {deviceName});
+         }
+      }
+      else if (!receiver)
       {
          // open first available receiver
          for (const auto &name : sdr::AirspyDevice::listDevices())
@@ -165,7 +217,28 @@ struct SignalReceiverTask::Impl : SignalReceiverTask, AbstractTask
       {
          log.info("start streaming for device {}", {receiver->name()});
 
-         receiver->start([this](sdr::SignalBuffer &buffer) { signalStream->next(buffer); });
+         receiver->start([this](sdr::SignalBuffer &buffer) {
+
+            // stream threads are created by device drivers, scheduling is applied on first buffer delivered by each one
+            static thread_local bool scheduled = false;
+
+            if (!scheduled)
+            {
+               rt::Executor::schedule("SignalReceiverStream", streamPriority, streamCore);
+
+               scheduled = true;
+            }
+
+            long long start = TaskMetrics::now();
+
+            signalStream->next(buffer);
+
+            // time spent by all signal observers
+            metrics.receiverDelivery.record(TaskMetrics::now() - start);
+            metrics.receiverLastBuffer.set(start);
+            metrics.receiverBuffers.add();
+            metrics.receiverSamples.add(buffer.elements());
+         });
 
          command.resolve();
 
@@ -201,12 +274,26 @@ struct SignalReceiverTask::Impl : SignalReceiverTask, AbstractTask
 
    void configReceiver(const rt::Event &command)
    {
-      if (receiver)
+      if (auto data = command.get<std::string>("data"))
       {
-         if (auto data = command.get<std::string>("data"))
+         auto config = json::parse(data.value());
+
+         // switch to named device, current receiver is closed
+         if (config.contains("device") && config["device"] != deviceName)
          {
-            auto config = json::parse(data.value());
+            deviceName = config["device"];
+
+            if (receiver)
+            {
+               log.info("shutdown device {}", {receiver->name()});
+               receiver.reset();
+            }
+
+            refresh();
+         }
 
+         if (receiver)
+         {
             log.info("change receiver config {}: {}", {receiver->name(), config.dump()});
 
             if (config.contains("centerFreq"))
@@ -226,6 +313,33 @@ struct SignalReceiverTask::Impl : SignalReceiverTask, AbstractTask
 
             if (config.contains("gainValue"))
                receiver->setGainValue(config["gainValue"]);
+
+            if (config.contains("sampleType"))
+               receiver->setSampleType(config["sampleType"]);
+
+            if (auto synthetic = std::dynamic_pointer_cast<sdr::SyntheticDevice>(receiver))
+            {
+               if (config.contains("streamSpeed"))
+                  synthetic->setStreamSpeed(config["streamSpeed"]);
+            }
+
+            if (auto replay = std::dynamic_pointer_cast<sdr::ReplayDevice>(receiver))
+            {
+               if (config.contains("streamSpeed"))
+                  replay->setStreamSpeed(config["streamSpeed"]);
+
+               if (config.contains("transferSize"))
+                  replay->setTransferSize(config["transferSize"]);
+
+               if (config.contains("dropRate"))
+                  replay->setDropRate(config["dropRate"]);
+
+               if (config.contains("maxLatency"))
+                  replay->setMaxLatency(config["maxLatency"]);
+
+               if (config.contains("loop"))
+                  replay->setLoop(config["loop"]);
+            }
          }
       }
 
@@ -248,6 +362,7 @@ struct SignalReceiverTask::Impl : SignalReceiverTask, AbstractTask
          // data parameters
          data["centerFreq"] = receiver->centerFreq();
          data["sampleRate"] = receiver->sampleRate();
+         data["sampleType"] = receiver->sampleType();
          data["gainMode"] = receiver->gainMode();
          data["gainValue"] = receiver->gainValue();
          data["mixerAgc"] = receiver->mixerAgc();
@@ -257,6 +372,8 @@ struct SignalReceiverTask::Impl : SignalReceiverTask, AbstractTask
          data["samplesReceived"] = receiver->samplesReceived();
          data["samplesDropped"] = receiver->samplesDropped();
 
+         metrics.receiverSamplesDropped.set(receiver->samplesDropped());
+
          // send capabilities on data attach
          if (event == SignalReceiverTask::Attach)
          {
@@ -298,9 +415,9 @@ SignalReceiverTask::SignalReceiverTask() : rt::Worker("SignalReceiverTask")
 {
 }
 
-rt::Worker *SignalReceiverTask::construct()
+rt::Worker *SignalReceiverTask::construct(int streamPriority, int streamCore)
 {
-   return new SignalReceiverTask::Impl;
+   return new SignalReceiverTask::Impl(streamPriority, streamCore);
 }
 
 }
\ No newline at end of file
@@ -22,17 +22,173 @@
 
 */
 
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstring>
+
 #include <rt/Logger.h>
 
 #include <sdr/SignalBuffer.h>
 #include <sdr/RecordDevice.h>
 
+#include <nfc/Nfc.h>
+#include <nfc/NfcFrame.h>
 #include <nfc/SignalRecorderTask.h>
 
 #include "AbstractTask.h"
+#include "TaskMetrics.h"
 
 namespace nfc {
 
+/*
+ * Pre-trigger capture ring, preallocated when capture starts and written from signal stream without locks.
+ * Single producer (signal stream observer) single consumer (recorder worker), consumer validates after
+ * each copy that producer has not overwritten the samples read.
+ */
+struct CaptureRing
+{
+   // ring sample data, interleaved by stride
+   std::vector<float> data;
+
+   // ring capacity in samples
+   unsigned long long capacity = 0;
+
+   // values per sample (2 for IQ)
+   unsigned int stride = 0;
+
+   // total samples written
+   std::atomic<unsigned long long> head {0};
+
+   // largest block written at once, samples that may be in progress beyond head
+   std::atomic<unsigned int> block {0};
+
+   // sample rate of last block written
+   std::atomic<unsigned int> sampleRate {0};
+
+   // producer gate, ring storage is only valid for writes while enabled
+   std::atomic<bool> enabled {false};
+
+   // producers currently inside write section
+   std::atomic<int> writers {0};
+
+   void allocate(unsigned long long samples, unsigned int channels)
+   {
+      disable();
+
+      // zero filled to commit memory pages before streaming starts
+      data.assign(samples * channels, 0.0f);
+
+      capacity = samples;
+      stride = channels;
+      head = 0;
+      block = 0;
+      sampleRate = 0;
+
+      enabled = true;
+   }
+
+   void release()
+   {
+      disable();
+
+      std::vector<float>().swap(data);
+
+      capacity = 0;
+   }
+
+   // stop producer and wait until any write in progress has finished
+   void disable()
+   {
+      enabled = false;
+
+      while (writers.load() > 0)
+         std::this_thread::yield();
+   }
+
+   // producer: enter write section, returns false if ring is disabled
+   bool enter()
+   {
+      writers++;
+
+      if (enabled.load())
+         return true;
+
+      writers--;
+
+      return false;
+   }
+
+   // producer: leave write section
+   void leave()
+   {
+      writers--;
+   }
+
+   // producer: append samples, overwriting oldest ones, 16 bit integer samples are converted to float
+   template<typename T>
+   void write(const T *values, unsigned int samples, unsigned int rate)
+   {
+      unsigned long long start = head.load(std::memory_order_relaxed);
+
+      if (samples > block.load(std::memory_order_relaxed))
+         block.store(samples, std::memory_order_relaxed);
+
+      sampleRate.store(rate, std::memory_order_relaxed);
+
+      while (samples > 0)
+      {
+         unsigned long long offset = start % capacity;
+         unsigned long long length = std::min<unsigned long long>(samples, capacity - offset);
+
+         store(data.data() + offset * stride, values, length * stride);
+
+         values += length * stride;
+         samples -= length;
+         start += length;
+      }
+
+      head.store(start, std::memory_order_release);
+   }
+
+   static void store(float *target, const float *values, unsigned long long count)
+   {
+      std::memcpy(target, values, count * sizeof(float));
+   }
+
+   static void store(float *target, const short *values, unsigned long long count)
+   {
+      for (unsigned long long i = 0; i < count; i++)
+         target[i] = values[i] * (1.0f / 32768);
+   }
+
+   // consumer: copy samples [from, from + samples) to buffer, returns false if not available or overwritten during copy
+   bool read(unsigned long long from, unsigned int samples, float *values) const
+   {
+      unsigned long long last = head.load(std::memory_order_acquire);
+
+      if (from + samples > last || last + block.load(std::memory_order_relaxed) > from + capacity)
+         return false;
+
+      for (unsigned long long next = from, pending = samples; pending > 0;)
+      {
+         unsigned long long offset = next % capacity;
+         unsigned long long length = std::min<unsigned long long>(pending, capacity - offset);
+
+         std::memcpy(values, data.data() + offset * stride, length * stride * sizeof(float));
+
+         values += length * stride;
+         pending -= length;
+         next += length;
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      // samples are valid if producer has not reached them while copying
+      return head.load(std::memory_order_relaxed) + block.load(std::memory_order_relaxed) <= from + capacity;
+   }
+};
+
 struct SignalRecorderTask::Impl : SignalRecorderTask, AbstractTask
 {
    // decoder status
@@ -47,22 +203,97 @@ struct SignalRecorderTask::Impl : SignalRecorderTask, AbstractTask
    // signal stream queue buffer
    rt::BlockingQueue<sdr::SignalBuffer> signalQueue;
 
+   // decoded frames subject, for capture triggers
+   rt::Subject<nfc::NfcFrame> *frameStream = nullptr;
+
+   // frame stream subscription
+   rt::Subject<nfc::NfcFrame>::Subscription frameSubscription;
+
+   // pre-trigger capture ring
+   CaptureRing ring;
+
+   // capture window in seconds before and after trigger
+   float preTrigger = 2.0f;
+   float postTrigger = 1.0f;
+
+   // capture triggers
+   bool triggerFirstFrame = true;
+   bool triggerCrcError = false;
+   int triggerCommand = -1;
+
+   // first frame after carrier detection is pending
+   bool firstFrameArmed = true;
+
+   // trigger fired, with ring position when fired
+   std::atomic<bool> triggerPending {false};
+   std::atomic<unsigned long long> triggerHead {0};
+
+   // current capture window being written, in ring samples
+   unsigned long long captureNext = 0;
+   unsigned long long captureEnd = 0;
+
+   // capture file name prefix and captures written
+   std::string capturePrefix;
+   int captureCount = 0;
+
    // last status sent
    std::chrono::time_point<std::chrono::steady_clock> lastStatus;
 
    // record device
    std::shared_ptr<sdr::RecordDevice> device;
 
-   Impl() : AbstractTask("SignalRecorderTask", "recorder"), status(SignalRecorderTask::Idle)
+   // shared pipeline metrics
+   TaskMetrics &metrics;
+
+   Impl() : AbstractTask("SignalRecorderTask", "recorder"), status(SignalRecorderTask::Idle), metrics(TaskMetrics::global())
    {
       // access to signal subject stream
       signalStream = rt::Subject<sdr::SignalBuffer>::name("signal.iq");
 
       // subscribe to signal events
       signalSubscription = signalStream->subscribe([this](const sdr::SignalBuffer &buffer) {
-         if (status == SignalRecorderTask::Writing || status == SignalRecorderTask::Capture)
+         if (status == SignalRecorderTask::Writing)
+         {
             signalQueue.add(buffer);
+
+            metrics.recorderQueueDepth.set(signalQueue.size());
+         }
+         else if (status == SignalRecorderTask::Buffering)
+         {
+            if (buffer.isValid() && buffer.isComplex() && ring.enter())
+            {
+               if (ring.stride == 2)
+               {
+                  // packed 16 bit I/Q pairs, one per element
+                  if (buffer.sampleType() == sdr::SignalDevice::Integer)
+                     ring.write(reinterpret_cast<const short *>(buffer.data() + buffer.position()), buffer.available(), buffer.sampleRate());
+                  else
+                     ring.write(buffer.data() + buffer.position(), buffer.available() / buffer.stride(), buffer.sampleRate());
+               }
+
+               ring.leave();
+
+               // wake up worker only while capture window is pending
+               if (triggerPending)
+                  notify();
+            }
+         }
       });
+
+      // access to decoded frames stream
+      frameStream = rt::Subject<nfc::NfcFrame>::name("decoder.frame");
+
+      // subscribe to frame events for capture triggers
+      frameSubscription = frameStream->subscribe([this](const nfc::NfcFrame &frame) {
+         if (status == SignalRecorderTask::Buffering)
+         {
+            frameTrigger(frame);
+         }
+      });
+
+      // wake up worker on new commands or signal buffers
+      watch(commandQueue);
+      watch(signalQueue);
    }
 
    void start() override
@@ -71,6 +302,8 @@ struct SignalRecorderTask::Impl : SignalRecorderTask, AbstractTask
 
    void stop() override
    {
+      ring.release();
+
       close();
    }
 
@@ -79,54 +312,62 @@ struct SignalRecorderTask::Impl : SignalRecorderTask, AbstractTask
       /*
        * first process pending commands
        */
-      if (auto command = commandQueue.get())
+      for (auto &command : commandQueue.drain())
       {
-         log.info("recorder command [{}]", {command->code});
+         log.info("recorder command [{}]", {command.code});
 
-         if (command->code == SignalRecorderTask::Read)
+         if (command.code == SignalRecorderTask::Read)
          {
-            readFile(command.value());
+            readFile(command);
          }
-         else if (command->code == SignalRecorderTask::Write)
+         else if (command.code == SignalRecorderTask::Write)
          {
-            writeFile(command.value());
+            writeFile(command);
          }
-         else if (command->code == SignalRecorderTask::Stop)
+         else if (command.code == SignalRecorderTask::Stop)
          {
-            closeFile(command.value());
+            closeFile(command);
          }
-         else if (command->code == SignalRecorderTask::Capture)
+         else if (command.code == SignalRecorderTask::Capture)
          {
-            startCapture(command.value());
+            startCapture(command);
          }
-         else if (command->code == SignalRecorderTask::Replay)
+         else if (command.code == SignalRecorderTask::Replay)
          {
-            startReplay(command.value());
+            startReplay(command);
+         }
+         else if (command.code == SignalRecorderTask::Trigger)
+         {
+            manualTrigger(command);
          }
       }
 
       /*
-       * now process device reading
+       * now process device reading, as fast as possible
        */
       if (status == SignalRecorderTask::Reading)
       {
          signalRead();
       }
-      else if (status == SignalRecorderTask::Writing)
-      {
-         signalWrite();
-      }
-      else if (status == SignalRecorderTask::Capture)
-      {
-         signalCapture();
-      }
-      else if (status == SignalRecorderTask::Replaying)
-      {
-         signalReplay();
-      }
       else
       {
-         wait(50);
+         if (status == SignalRecorderTask::Writing)
+         {
+            signalWrite();
+         }
+         else if (status == SignalRecorderTask::Buffering)
+         {
+            signalCapture();
+         }
+         else if (status == SignalRecorderTask::Replaying)
+         {
+            signalReplay();
+         }
+
+         /*
+          * wait until new commands or signal buffers arrive
+          */
+         wait();
       }
 
       /*
@@ -211,6 +452,14 @@ struct SignalRecorderTask::Impl : SignalRecorderTask, AbstractTask
 
    void closeFile(const rt::Event &command)
    {
+      if (status == SignalRecorderTask::Buffering)
+      {
+         // flush pending capture window
+         finishCapture();
+
+         ring.release();
+      }
+
       close();
 
       command.resolve();
@@ -220,11 +469,115 @@ struct SignalRecorderTask::Impl : SignalRecorderTask, AbstractTask
 
    void startCapture(const rt::Event &command)
    {
+      // default memory budget for capture ring
+      long long memoryBudget = 256 * 1024 * 1024;
+
+      capturePrefix = "capture";
+
+      if (auto file = command.get<std::string>("file"))
+      {
+         capturePrefix = file.value();
+      }
+
+      if (auto data = command.get<std::string>("data"))
+      {
+         auto config = json::parse(data.value());
+
+         log.info("capture config: {}", {config.dump()});
+
+         if (config.contains("memoryBudget"))
+            memoryBudget = config["memoryBudget"];
+
+         if (config.contains("preTrigger"))
+            preTrigger = config["preTrigger"];
+
+         if (config.contains("postTrigger"))
+            postTrigger = config["postTrigger"];
+
+         if (config.contains("firstFrame"))
+            triggerFirstFrame = config["firstFrame"];
+
+         if (config.contains("crcError"))
+            triggerCrcError = config["crcError"];
+
+         if (config.contains("commandByte"))
+            triggerCommand = config["commandByte"];
+      }
+
+      // stop any other recording in progress
+      close();
+
+      signalQueue.clear();
+
+      // preallocate IQ ring for the whole memory budget
+      ring.allocate(memoryBudget / (2 * sizeof(float)), 2);
+
+      captureNext = 0;
+      captureEnd = 0;
+      captureCount = 0;
+      firstFrameArmed = true;
+      triggerPending = false;
+
+      log.info("capture started, ring of {} samples ({} bytes)", {ring.capacity, memoryBudget});
+
       command.resolve();
 
       updateRecorderStatus(SignalRecorderTask::Buffering);
    }
 
+   void manualTrigger(const rt::Event &command)
+   {
+      if (status == SignalRecorderTask::Buffering)
+      {
+         fireTrigger("manual");
+
+         command.resolve();
+      }
+      else
+      {
+         command.reject();
+      }
+   }
+
+   // runs on decoder thread, must be fast
+   void frameTrigger(const nfc::NfcFrame &frame)
+   {
+      if (frame.isNoCarrier())
+      {
+         firstFrameArmed = true;
+      }
+      else if (frame.isPollFrame() || frame.isListenFrame())
+      {
+         if (triggerFirstFrame && firstFrameArmed)
+         {
+            firstFrameArmed = false;
+
+            fireTrigger("first frame");
+         }
+         else if (triggerCrcError && frame.hasCrcError())
+         {
+            fireTrigger("crc error");
+         }
+         else if (triggerCommand >= 0 && frame.isPollFrame() && frame.limit() > 0 && frame[0] == triggerCommand)
+         {
+            fireTrigger("command byte");
+         }
+      }
+   }
+
+   void fireTrigger(const char *reason)
+   {
+      // triggers are ignored while previous capture window is pending
+      if (!triggerPending.exchange(true))
+      {
+         triggerHead = ring.head.load();
+
+         log.info("capture trigger fired: {}", {reason});
+
+         notify();
+      }
+   }
+
    void startReplay(const rt::Event &command)
    {
       command.resolve();
@@ -241,6 +594,8 @@ struct SignalRecorderTask::Impl : SignalRecorderTask, AbstractTask
          if (device->read(samples) > 0)
          {
             signalStream->next(samples);
+
+            metrics.recorderSamples.add(samples.elements());
          }
 
          if (device->isEof())
@@ -263,29 +618,135 @@ struct SignalRecorderTask::Impl : SignalRecorderTask, AbstractTask
    {
       if (device && device->isOpen())
       {
-         if (auto buffer = signalQueue.get())
+         for (auto &buffer : signalQueue.drain())
          {
-            if (!buffer->isEmpty())
+            if (!buffer.isEmpty())
             {
-//               device->write(buffer.value());
+//               device->write(buffer);
 
                // convert I/Q samples to Real sample
-               sdr::SignalBuffer result(buffer->elements(), 1, buffer->sampleRate());
+               sdr::SignalBuffer result(buffer.elements(), 1, buffer.sampleRate());
 
-               buffer->stream([&result](const float *value, int stride) {
-                  result.put(sqrtf(value[0] * value[0] + value[1] * value[1]));
-               });
+               result.pull(buffer.magnitude(result.data()));
 
                result.flip();
 
                device->write(result);
+
+               metrics.recorderSamples.add(result.elements());
             }
          }
+
+         metrics.recorderQueueDepth.set(signalQueue.size());
       }
    }
 
    void signalCapture()
    {
+      unsigned int sampleRate = ring.sampleRate;
+
+      // start new capture window when trigger has been fired
+      if (!captureEnd && triggerPending && sampleRate)
+      {
+         unsigned long long trigger = triggerHead;
+
+         // pre-trigger window limited by ring contents, keeping margin for producer
+         auto before = std::min<unsigned long long>((unsigned long long) (preTrigger * sampleRate), ring.capacity - ring.capacity / 8);
+         auto after = (unsigned long long) (postTrigger * sampleRate);
+
+         if (before > trigger)
+            before = trigger;
+
+         char file[256];
+         char date[32];
+         struct tm timeinfo {};
+
+         std::time_t rawTime = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+         localtime_s(&timeinfo, &rawTime);
+         strftime(date, sizeof(date), "%Y%m%d%H%M%S", &timeinfo);
+         snprintf(file, sizeof(file), "%s-%s-%d.wav", capturePrefix.c_str(), date, ++captureCount);
+
+         device = std::make_shared<sdr::RecordDevice>(file);
+
+         device->setSampleRate(sampleRate);
+         device->setChannelCount(ring.stride);
+
+         if (device->open(sdr::SignalDevice::Write))
+         {
+            log.info("writing capture {}, {} samples before and {} after trigger", {device->name(), before, after});
+
+            captureNext = trigger - before;
+            captureEnd = trigger + after;
+         }
+         else
+         {
+            log.warn("unable to open capture file {}", {device->name()});
+
+            device.reset();
+
+            triggerPending = false;
+         }
+      }
+
+      // write available samples of current capture window
+      if (captureEnd)
+      {
+         unsigned long long available = std::min<unsigned long long>(ring.head, captureEnd);
+
+         while (captureNext < available)
+         {
+            auto length = (unsigned int) std::min<unsigned long long>(available - captureNext, 65536);
+
+            sdr::SignalBuffer buffer(length * ring.stride, ring.stride, sampleRate);
+
+            if (ring.read(captureNext, length, buffer.pull(length * ring.stride)))
+            {
+               buffer.flip();
+
+               device->write(buffer);
+
+               metrics.recorderSamples.add(length);
+
+               captureNext += length;
+            }
+            else
+            {
+               // consumer too slow, skip overwritten samples
+               unsigned long long limit = ring.head + ring.block + ring.capacity / 8;
+               unsigned long long oldest = limit > ring.capacity ? limit - ring.capacity : 0;
+
+               if (oldest <= captureNext)
+                  break;
+
+               log.warn("capture ring overrun, {} samples lost", {oldest - captureNext});
+
+               captureNext = std::min(oldest, available);
+            }
+         }
+
+         if (captureNext >= captureEnd)
+         {
+            finishCapture();
+
+            updateRecorderStatus(SignalRecorderTask::Buffering);
+         }
+      }
+   }
+
+   void finishCapture()
+   {
+      if (captureEnd)
+      {
+         log.info("capture {} finished", {device->name()});
+
+         device.reset();
+
+         captureNext = 0;
+         captureEnd = 0;
+
+         // re-arm trigger
+         triggerPending = false;
+      }
    }
 
    void signalReplay()
@@ -317,6 +778,8 @@ struct SignalRecorderTask::Impl : SignalRecorderTask, AbstractTask
             break;
          case Buffering:
             data["status"] = "buffering";
+            data["captureCount"] = captureCount;
+            data["captureSeconds"] = ring.sampleRate ? double(ring.capacity) / ring.sampleRate : 0;
             break;
          case Replaying:
             data["status"] = "replaying";
@@ -0,0 +1,208 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+#ifndef NFC_TASKMETRICS_H
+#define NFC_TASKMETRICS_H
+
+#include <atomic>
+#include <chrono>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace nfc {
+
+/*
+ * monotonic event counter, updated from any thread without locks
+ */
+struct MetricCounter
+{
+   std::atomic<unsigned long long> value {0};
+
+   inline void add(unsigned long long count = 1)
+   {
+      value.fetch_add(count, std::memory_order_relaxed);
+   }
+
+   inline unsigned long long get() const
+   {
+      return value.load(std::memory_order_relaxed);
+   }
+};
+
+/*
+ * last observed value, like queue depth or last buffer arrival time
+ */
+struct MetricGauge
+{
+   std::atomic<long long> value {0};
+
+   inline void set(long long update)
+   {
+      value.store(update, std::memory_order_relaxed);
+   }
+
+   inline long long get() const
+   {
+      return value.load(std::memory_order_relaxed);
+   }
+};
+
+/*
+ * lock-free histogram with 4 linear sub-buckets per power of two (relative error below 25%), values
+ * are accumulated by producers and periodically collected (and cleared) by metrics task
+ */
+struct MetricHistogram
+{
+   static constexpr int SUBBITS = 2;
+   static constexpr int BUCKETS = (64 - SUBBITS + 1) << SUBBITS;
+
+   std::atomic<unsigned long long> buckets[BUCKETS] {};
+   std::atomic<unsigned long long> sum {0};
+   std::atomic<unsigned long long> max {0};
+
+   inline void record(unsigned long long value)
+   {
+      buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+      sum.fetch_add(value, std::memory_order_relaxed);
+
+      unsigned long long last = max.load(std::memory_order_relaxed);
+
+      while (value > last && !max.compare_exchange_weak(last, value, std::memory_order_relaxed));
+   }
+
+   // returns statistics since last collect and clear histogram
+   json collect()
+   {
+      unsigned long long values[BUCKETS];
+      unsigned long long total = 0;
+
+      for (int i = 0; i < BUCKETS; i++)
+         total += values[i] = buckets[i].exchange(0, std::memory_order_relaxed);
+
+      unsigned long long sumValue = sum.exchange(0, std::memory_order_relaxed);
+      unsigned long long maxValue = max.exchange(0, std::memory_order_relaxed);
+
+      if (!total)
+         return {{"count", 0}};
+
+      return {
+            {"count", total},
+            {"mean",  double(sumValue) / double(total)},
+            {"p50",   percentile(values, total, 0.50)},
+            {"p90",   percentile(values, total, 0.90)},
+            {"p99",   percentile(values, total, 0.99)},
+            {"max",   maxValue}
+      };
+   }
+
+   // bucket index: values below 2^SUBBITS are exact, others keep SUBBITS bits after leading one
+   inline static int index(unsigned long long value)
+   {
+      if (value < (1 << SUBBITS))
+         return int(value);
+
+      int msb = 63 - __builtin_clzll(value);
+      int shift = msb - SUBBITS;
+
+      return ((shift + 1) << SUBBITS) + int((value >> shift) & ((1 << SUBBITS) - 1));
+   }
+
+   // upper bound of values stored in bucket
+   inline static unsigned long long limit(int index)
+   {
+      if (index < (1 << SUBBITS))
+         return index;
+
+      int shift = (index >> SUBBITS) - 1;
+      unsigned long long base = (1ull << SUBBITS) | (index & ((1 << SUBBITS) - 1));
+
+      return ((base + 1) << shift) - 1;
+   }
+
+   static unsigned long long percentile(const unsigned long long *values, unsigned long long total, double rank)
+   {
+      auto target = (unsigned long long) (rank * double(total));
+      unsigned long long accumulated = 0;
+
+      for (int i = 0; i < BUCKETS; i++)
+      {
+         accumulated += values[i];
+
+         if (accumulated > target)
+            return limit(i);
+      }
+
+      return limit(BUCKETS - 1);
+   }
+};
+
+/*
+ * processing pipeline metrics shared by all tasks, published by MetricsMonitorTask on "metrics.status"
+ */
+struct TaskMetrics
+{
+   // receiver stage: buffers delivered to "signal.iq" and time spent by observers (ns)
+   MetricCounter receiverBuffers;
+   MetricCounter receiverSamples;
+   MetricGauge receiverSamplesDropped;
+   MetricGauge receiverLastBuffer;
+   MetricHistogram receiverDelivery;
+
+   // decoder stage: queue depth, latency since signal delivery (us), decode cost (ns/sample) and frames per tech
+   MetricGauge decoderQueueDepth;
+   MetricGauge decoderSampleRate;
+   MetricGauge decoderLastBuffer;
+   MetricCounter decoderSamples;
+   MetricCounter decoderNanos;
+   MetricCounter decoderFrames[5];
+   MetricHistogram decoderQueueLatency;
+   MetricHistogram decoderSampleCost;
+
+   // recorder stage: queue depth and samples written / read
+   MetricGauge recorderQueueDepth;
+   MetricCounter recorderSamples;
+
+   // fourier stage: transforms and time spent on each one (us)
+   MetricCounter fourierTransforms;
+   MetricHistogram fourierProcessTime;
+
+   static TaskMetrics &global()
+   {
+      static TaskMetrics metrics;
+
+      return metrics;
+   }
+
+   // monotonic time in nanoseconds, used for gauges and latency measurement
+   inline static long long now()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+};
+
+}
+
+#endif //NFC_LAB_TASKMETRICS_H
\ No newline at end of file
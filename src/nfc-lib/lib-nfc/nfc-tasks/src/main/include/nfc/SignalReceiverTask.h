@@ -26,6 +26,7 @@
 #define NFC_SIGNALRECEIVERTASK_H
 
 #include <rt/Worker.h>
+#include <rt/Executor.h>
 
 namespace nfc {
 
@@ -58,7 +59,8 @@ class SignalReceiverTask : public rt::Worker
 
    public:
 
-      static rt::Worker *construct();
+      // stream priority and core are applied to device thread that delivers the samples
+      static rt::Worker *construct(int streamPriority = rt::Executor::Normal, int streamCore = rt::Executor::AnyCore);
 };
 
 }
@@ -39,7 +39,8 @@ class SignalRecorderTask : public rt::Worker
          Read,
          Write,
          Capture,
-         Replay
+         Replay,
+         Trigger
       };
 
       enum Status
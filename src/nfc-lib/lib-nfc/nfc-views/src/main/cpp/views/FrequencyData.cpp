@@ -23,11 +23,13 @@
 */
 
 #include <cmath>
-#include <mutex>
+#include <cstring>
+#include <algorithm>
 
 #include <rt/Buffer.h>
 
 #include <gl/engine/Text.h>
+#include <gl/engine/StreamBuffer.h>
 
 #include <nfc/DefaultShader.h>
 #include <nfc/SignalSmoother.h>
@@ -47,23 +49,17 @@ struct FrequencyData::Impl
    nfc::SmoothParameters params;
 
    // shader buffers
-   gl::Buffer dataValue;
+   gl::StreamBuffer dataValue;
    gl::Buffer dataRange;
    gl::Buffer dataBlock;
 
-   // signal buffer update mutex
-   std::mutex signalMutex;
-
-   // last received buffer
-   sdr::SignalBuffer signalBuffer;
-
    Impl(int length) : length(length)
    {
       decimation = 2;
 
       // initialize GL shader buffers
       dataRange = gl::Buffer::createArrayBuffer(length * sizeof(float));
-      dataValue = gl::Buffer::createArrayBuffer(length * sizeof(float) * 2);
+      dataValue = gl::StreamBuffer::createArrayBuffer(length * sizeof(float) * 2);
       dataBlock = gl::Buffer::createStorageBuffer(1 << 18).bind(0);
 
       // default smooth parameters
@@ -73,6 +69,29 @@ struct FrequencyData::Impl
 
 FrequencyData::FrequencyData(int length) : self(std::make_shared<Impl>(length))
 {
+   addDrawItem<SignalSmoother>([this](gl::Device *device, SignalSmoother *shader) {
+      auto dataValue = self->dataValue.current();
+
+      if (dataValue.valid())
+      {
+         shader->process(self->dataRange, dataValue, self->params, self->length);
+
+         // region can not be reused until GPU finish reading
+         self->dataValue.fence();
+      }
+   });
+
+   addDrawItem<HeatmapShader>([this](gl::Device *device, HeatmapShader *shader) {
+      shader->setMatrixBlock(*this);
+      shader->setDataRange(self->dataRange);
+      shader->drawLineStrip(self->length);
+   });
+
+   addDrawItem<EnvelopeShader>([this](gl::Device *device, EnvelopeShader *shader) {
+      shader->setMatrixBlock(*this);
+      shader->setDataRange(self->dataRange);
+      shader->drawLineStrip(self->length);
+   });
 }
 
 void FrequencyData::setCenterFreq(long value)
@@ -85,10 +104,17 @@ void FrequencyData::setSampleRate(long value)
 
 void FrequencyData::refresh(const sdr::SignalBuffer &buffer)
 {
-   if (self->signalMutex.try_lock())
+   if (buffer.isValid())
    {
-      self->signalBuffer = buffer;
-      self->signalMutex.unlock();
+      // copy spectrum directly to GPU visible memory, discarded if render thread is behind
+      if (auto data = self->dataValue.map())
+      {
+         unsigned int length = std::min((unsigned int) (buffer.available() * sizeof(float)), self->dataValue.size());
+
+         std::memcpy(data, buffer.data(), length);
+
+         self->dataValue.unmap(length);
+      }
    }
 }
 
@@ -113,34 +139,11 @@ gl::Widget *FrequencyData::resize(int width, int height)
 
 void FrequencyData::update(float time, float delta)
 {
-   std::lock_guard<std::mutex> lock(self->signalMutex);
-
-   if (self->signalBuffer.isValid())
+   // switch to last received spectrum, if any
+   if (self->dataValue.acquire())
    {
-      self->dataValue.update(self->signalBuffer.data(), 0, self->signalBuffer.available() * sizeof(float));
+      touch();
    }
 }
 
-void FrequencyData::draw(gl::Device *device, gl::Program *shader) const
-{
-   if (auto *smoothShader = dynamic_cast<SignalSmoother *>(shader))
-   {
-      smoothShader->process(self->dataRange, self->dataValue, self->params, self->length);
-   }
-   else if (auto heatmapShader = dynamic_cast<HeatmapShader *>(shader))
-   {
-      heatmapShader->setMatrixBlock(*this);
-      heatmapShader->setDataRange(self->dataRange);
-      heatmapShader->drawLineStrip(self->length);
-   }
-   else if (auto envelopeShader = dynamic_cast<EnvelopeShader *>(shader))
-   {
-      envelopeShader->setMatrixBlock(*this);
-      envelopeShader->setDataRange(self->dataRange);
-      envelopeShader->drawLineStrip(self->length);
-   }
-
-   gl::Widget::draw(device, shader);
-}
-
 }
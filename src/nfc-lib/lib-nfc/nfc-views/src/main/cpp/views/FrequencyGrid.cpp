@@ -48,6 +48,21 @@ FrequencyGrid::FrequencyGrid(int length) : self(std::make_shared<Impl>())
 
    // create caption
    add(self->viewCaptionLabel = gl::FreeType::text("calibriz", 16, "NFC Frequency"));
+
+   addDrawItem<DefaultShader>([this](gl::Device *device, DefaultShader *shader) {
+      shader->setMatrixBlock(*this);
+      shader->setLineThickness(1.0f);
+
+      // grid and marks
+      shader->setVertexPoints(self->gridBuffer, 3, 4 * sizeof(gl::Vertex) + offsetof(gl::Vertex, point));
+      shader->setVertexColors(self->gridBuffer, 4, 4 * sizeof(gl::Vertex) + offsetof(gl::Vertex, color));
+      shader->drawLines(2);
+
+      // outline loop
+      shader->setVertexPoints(self->gridBuffer, 3, offsetof(gl::Vertex, point));
+      shader->setVertexColors(self->gridBuffer, 4, offsetof(gl::Vertex, color));
+      shader->drawLineLoop(4);
+   });
 }
 
 void FrequencyGrid::setCenterFreq(long value)
@@ -84,25 +99,4 @@ gl::Widget *FrequencyGrid::resize(int width, int height)
    return this;
 }
 
-void FrequencyGrid::draw(gl::Device *device, gl::Program *shader) const
-{
-   if (auto defaultShader = dynamic_cast<DefaultShader *>(shader))
-   {
-      defaultShader->setMatrixBlock(*this);
-      defaultShader->setLineThickness(1.0f);
-
-      // grid and marks
-      defaultShader->setVertexPoints(self->gridBuffer, 3, 4 * sizeof(gl::Vertex) + offsetof(gl::Vertex, point));
-      defaultShader->setVertexColors(self->gridBuffer, 4, 4 * sizeof(gl::Vertex) + offsetof(gl::Vertex, color));
-      defaultShader->drawLines(2);
-
-      // outline loop
-      defaultShader->setVertexPoints(self->gridBuffer, 3, offsetof(gl::Vertex, point));
-      defaultShader->setVertexColors(self->gridBuffer, 4, offsetof(gl::Vertex, color));
-      defaultShader->drawLineLoop(4);
-   }
-
-   gl::Widget::draw(device, shader);
-}
-
 }
@@ -49,6 +49,10 @@ struct FrequencyPeak::Impl
    // signal buffer update mutex
    std::mutex signalMutex;
 
+   // generation of last received and last processed buffer
+   unsigned int signalGeneration = 0;
+   unsigned int updateGeneration = 0;
+
    // last received buffer
    sdr::SignalBuffer signalBuffer;
 
@@ -69,6 +73,13 @@ FrequencyPeak::FrequencyPeak(int length) : self(std::make_shared<Impl>())
    add(self->frequencyCarrierLabel = gl::FreeType::text("courbd", 11));
 //   add(self->frequencyMinimumLabel = gl::FreeType::text("courbd", 12));
 //   add(self->frequencyMaximumLabel = gl::FreeType::text("courbd", 12));
+
+   addDrawItem<PeakShader>([this](gl::Device *device, PeakShader *shader) {
+      shader->setMatrixBlock(*this);
+      shader->setObjectColor(self->peakColor);
+      shader->setPeakMarks(self->peakMarks);
+      shader->drawPoints(1);
+   });
 }
 
 void FrequencyPeak::setCenterFreq(long value)
@@ -86,6 +97,7 @@ void FrequencyPeak::refresh(const sdr::SignalBuffer &buffer)
    if (self->signalMutex.try_lock())
    {
       self->signalBuffer = buffer;
+      self->signalGeneration++;
       self->signalMutex.unlock();
    }
 }
@@ -103,6 +115,12 @@ void FrequencyPeak::update(float time, float delta)
 {
    std::lock_guard<std::mutex> lock(self->signalMutex);
 
+   // nothing to do until new buffer is received
+   if (self->updateGeneration == self->signalGeneration)
+      return;
+
+   self->updateGeneration = self->signalGeneration;
+
    if (self->signalBuffer.isValid())
    {
       const auto data = self->signalBuffer.data();
@@ -115,19 +133,19 @@ void FrequencyPeak::update(float time, float delta)
       float variance = 0;
 
       // compute signal average
-      for (int i = 0; i < length; i++)
+      for (unsigned int i = 0; i < length; i++)
          average += data[i];
 
       average = average / (float) length;
 
       // compute signal variance
-      for (int i = 0; i < length; i++)
+      for (unsigned int i = 0; i < length; i++)
          variance += (data[i] - average) * (data[i] - average);
 
       variance = variance / (float) length;
 
       // detect signal peaks
-      for (int i = 0; i < length; i++)
+      for (unsigned int i = 0; i < length; i++)
       {
          float deviation = (data[i] - average) * (data[i] - average);
 
@@ -140,6 +158,8 @@ void FrequencyPeak::update(float time, float delta)
 
       self->peakMarks.update(peaks, 0, sizeof(peaks));
 
+      touch();
+
       if (peaks[0])
       {
          // get signal parameters
@@ -169,17 +189,4 @@ void FrequencyPeak::update(float time, float delta)
    }
 }
 
-void FrequencyPeak::draw(gl::Device *device, gl::Program *shader) const
-{
-   if (auto peakShader = dynamic_cast<PeakShader *>(shader))
-   {
-      peakShader->setMatrixBlock(*this);
-      peakShader->setObjectColor(self->peakColor);
-      peakShader->setPeakMarks(self->peakMarks);
-      peakShader->drawPoints(1);
-   }
-
-   gl::Widget::draw(device, shader);
-}
-
 }
@@ -22,10 +22,12 @@
 
 */
 
-#include <mutex>
+#include <cstring>
+#include <algorithm>
 
 #include <gl/engine/Buffer.h>
 #include <gl/engine/Geometry.h>
+#include <gl/engine/StreamBuffer.h>
 #include <gl/typeface/FreeType.h>
 
 #include <sdr/SignalBuffer.h>
@@ -39,14 +41,8 @@ struct QuadratureData::Impl
 {
    unsigned int samples;
 
-   // signal data
-   gl::Buffer dataValue;
-
-   // last received buffer
-   sdr::SignalBuffer signalBuffer;
-
-   // signal buffer update mutex
-   std::mutex signalMutex;
+   // signal data, written directly from refresh
+   gl::StreamBuffer dataValue;
 };
 
 QuadratureData::QuadratureData(int samples) : self(std::make_shared<Impl>())
@@ -54,7 +50,22 @@ QuadratureData::QuadratureData(int samples) : self(std::make_shared<Impl>())
    self->samples = samples;
 
    // IQ signal buffer
-   self->dataValue = gl::Buffer::createArrayBuffer(2 * samples * sizeof(float));
+   self->dataValue = gl::StreamBuffer::createArrayBuffer(2 * samples * sizeof(float));
+
+   addDrawItem<QuadratureShader>([this](gl::Device *device, QuadratureShader *shader) {
+      auto dataValue = self->dataValue.current();
+
+      if (dataValue.valid())
+      {
+         shader->setMatrixBlock(*this);
+         shader->setLineThickness(1.0f);
+         shader->setDataValue(dataValue);
+         shader->drawLineStrip(self->dataValue.length() / (2 * sizeof(float)));
+
+         // region can not be reused until GPU finish reading
+         self->dataValue.fence();
+      }
+   });
 }
 
 void QuadratureData::setCenterFreq(long value)
@@ -67,10 +78,28 @@ void QuadratureData::setSampleRate(long value)
 
 void QuadratureData::refresh(const sdr::SignalBuffer &buffer)
 {
-   if (self->signalMutex.try_lock())
+   if (buffer.isValid() && buffer.isComplex())
    {
-      self->signalBuffer = buffer;
-      self->signalMutex.unlock();
+      // copy samples directly to GPU visible memory, discarded if render thread is behind
+      if (auto data = self->dataValue.map())
+      {
+         unsigned int points = std::min(buffer.elements(), self->samples);
+
+         // packed 16 bit I/Q pairs are normalized while copying
+         if (buffer.sampleType() == sdr::SignalDevice::Integer)
+         {
+            auto values = reinterpret_cast<const short *>(buffer.data());
+
+            for (unsigned int i = 0; i < points * 2; i++)
+               static_cast<float *>(data)[i] = values[i] * (1.0f / 32768);
+         }
+         else
+         {
+            std::memcpy(data, buffer.data(), points * 2 * sizeof(float));
+         }
+
+         self->dataValue.unmap(points * 2 * sizeof(float));
+      }
    }
 }
 
@@ -85,31 +114,11 @@ gl::Widget *QuadratureData::resize(int width, int height)
 
 void QuadratureData::update(float time, float delta)
 {
-   std::lock_guard<std::mutex> lock(self->signalMutex);
-
-   if (self->signalBuffer.isValid() && self->signalBuffer.stride() == 2)
-   {
-      unsigned int points = std::min(self->signalBuffer.elements(), self->samples);
-
-      self->dataValue.update(self->signalBuffer.data(), 0, points * 2 * sizeof(float));
-   }
-   else
-   {
-      self->dataValue.update(nullptr, 0, 0);
-   }
-}
-
-void QuadratureData::draw(gl::Device *device, gl::Program *shader) const
-{
-   if (auto *qualityShader = dynamic_cast<QuadratureShader *>(shader))
+   // switch to last received samples, if any
+   if (self->dataValue.acquire())
    {
-      qualityShader->setMatrixBlock(*this);
-      qualityShader->setLineThickness(1.0f);
-      qualityShader->setDataValue(self->dataValue);
-      qualityShader->drawLineStrip(self->samples);
+      touch();
    }
-
-   gl::Widget::draw(device, shader);
 }
 
 }
\ No newline at end of file
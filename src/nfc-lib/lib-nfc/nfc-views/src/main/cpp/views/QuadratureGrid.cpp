@@ -48,6 +48,21 @@ QuadratureGrid::QuadratureGrid(int samples) : self(std::make_shared<Impl>())
 
    // create caption
    add(self->viewCaptionLabel = gl::FreeType::text("calibriz", 16, "NFC Field"));
+
+   addDrawItem<DefaultShader>([this](gl::Device *device, DefaultShader *shader) {
+      shader->setMatrixBlock(*this);
+      shader->setLineThickness(1.0f);
+
+      // grid and marks
+      shader->setVertexPoints(self->gridBuffer, 3, 4 * sizeof(gl::Vertex) + offsetof(gl::Vertex, point));
+      shader->setVertexColors(self->gridBuffer, 4, 4 * sizeof(gl::Vertex) + offsetof(gl::Vertex, color));
+      shader->drawLines(4 + 32);
+
+      // outline loop
+      shader->setVertexPoints(self->gridBuffer, 3, offsetof(gl::Vertex, point));
+      shader->setVertexColors(self->gridBuffer, 4, offsetof(gl::Vertex, color));
+      shader->drawLineLoop(4);
+   });
 }
 
 void QuadratureGrid::setCenterFreq(long value)
@@ -99,25 +114,4 @@ gl::Widget *QuadratureGrid::resize(int width, int height)
    return this;
 }
 
-void QuadratureGrid::draw(gl::Device *device, gl::Program *shader) const
-{
-   if (auto defaultShader = dynamic_cast<DefaultShader *>(shader))
-   {
-      defaultShader->setMatrixBlock(*this);
-      defaultShader->setLineThickness(1.0f);
-
-      // grid and marks
-      defaultShader->setVertexPoints(self->gridBuffer, 3, 4 * sizeof(gl::Vertex) + offsetof(gl::Vertex, point));
-      defaultShader->setVertexColors(self->gridBuffer, 4, 4 * sizeof(gl::Vertex) + offsetof(gl::Vertex, color));
-      defaultShader->drawLines(4 + 32);
-
-      // outline loop
-      defaultShader->setVertexPoints(self->gridBuffer, 3, offsetof(gl::Vertex, point));
-      defaultShader->setVertexColors(self->gridBuffer, 4, offsetof(gl::Vertex, color));
-      defaultShader->drawLineLoop(4);
-   }
-
-   gl::Widget::draw(device, shader);
-}
-
 }
\ No newline at end of file
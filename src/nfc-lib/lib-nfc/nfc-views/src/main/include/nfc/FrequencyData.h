@@ -53,8 +53,6 @@ class FrequencyData : public gl::Widget, public SignalView
 
       void update(float time, float delta) override;
 
-      void draw(gl::Device *device, gl::Program *shader) const override;
-
    private:
 
       std::shared_ptr<Impl> self;
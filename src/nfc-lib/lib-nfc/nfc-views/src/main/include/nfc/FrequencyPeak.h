@@ -51,8 +51,6 @@ class FrequencyPeak : public gl::Widget, public SignalView
 
       void update(float time, float delta) override;
 
-      void draw(gl::Device *device, gl::Program *shader) const override;
-
    private:
 
       std::shared_ptr<Impl> self;
@@ -47,8 +47,6 @@ class QuadratureGrid : public gl::Widget, public SignalView
 
       gl::Widget *resize(int width, int height) override;
 
-      void draw(gl::Device *device, gl::Program *shader) const override;
-
    private:
 
       std::shared_ptr<Impl> self;
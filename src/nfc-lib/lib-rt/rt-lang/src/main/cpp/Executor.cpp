@@ -22,10 +22,13 @@
 
 */
 
+
 #include <atomic>
+#include <cerrno>
 #include <mutex>
-#include <queue>
+#include <deque>
 #include <list>
+#include <vector>
 #include <thread>
 #include <condition_variable>
 
@@ -33,110 +36,229 @@
 #include <rt/BlockingQueue.h>
 #include <rt/Executor.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
 namespace rt {
 
 struct Executor::Impl
 {
    rt::Logger log {"Executor"};
 
+   // local task queue for each pool thread, owner pops from back, thieves from front
+   struct WorkQueue
+   {
+      std::mutex mutex;
+      std::deque<std::shared_ptr<Task>> tasks;
+   };
+
    // max number of tasks in pool (waiting + running)
    int poolSize;
 
-   // running threads
+   // pool threads
    std::list<std::thread> threadList;
 
+   // dedicated task threads
+   std::list<std::thread> dedicatedList;
+
+   // work queues, one per pool thread
+   std::vector<std::unique_ptr<WorkQueue>> workQueues;
+
    // waiting group
    std::condition_variable threadSync;
 
-   // waiting tasks pool
-   BlockingQueue<std::shared_ptr<Task>> waitingTasks;
-
    // current running tasks
    BlockingQueue<std::shared_ptr<Task>> runningTasks;
 
+   // number of tasks waiting in work queues
+   std::atomic<int> waitingTasks {0};
+
+   // round-robin index for external submissions
+   std::atomic<unsigned int> nextQueue {0};
+
    // shutdown flag
    std::atomic<bool> shutdown;
 
    // sync mutex
    std::mutex syncMutex;
 
+   // dedicated threads mutex
+   std::mutex dedicatedMutex;
+
+   // index of work queue owned by current thread, -1 for non-pool threads
+   static thread_local int currentQueue;
+
    Impl(int poolSize, int coreSize) : poolSize(poolSize), shutdown(false)
    {
       log.info("executor service starting width {} threads", {coreSize});
 
+      for (int i = 0; i < coreSize; i++)
+      {
+         workQueues.emplace_back(new WorkQueue);
+      }
+
       // create new thread group
       for (int i = 0; i < coreSize; i++)
       {
-         threadList.emplace_back([this] { this->exec(); });
+         threadList.emplace_back([this, i] { this->exec(i); });
       }
    }
 
-   void exec()
+   void exec(int index)
    {
       // get current thread id
       std::thread::id id = std::this_thread::get_id();
 
+      // bind thread to own work queue
+      currentQueue = index;
+
       log.debug("worker thread {} started", {id});
 
       // main thread loop
       while (!shutdown)
       {
-         if (auto next = waitingTasks.get())
+         if (auto task = next(index))
          {
-            auto task = next.value();
-
             runningTasks.add(task);
 
-            try
-            {
-               log.debug("task {} started in thread {}", {task->name(), id});
-
-               next.value()->run(); // call next handler
-
-               log.debug("task {} finished in thread {}", {task->name(), id});
-            }
-            catch (...)
-            {
-               log.error("unhandled task {} exception in thread {}", {task->name(), id});
-            }
-
-            // on shutdown process do not remove from list to avoid concurrent modification
-            if (!shutdown)
-            {
-               runningTasks.remove(task);
-            }
+            run(task, id);
          }
          else if (!shutdown)
          {
             // lock mutex before wait in condition variable
             std::unique_lock<std::mutex> lock(syncMutex);
 
-            // stop thread until is notified
-            threadSync.wait(lock);
+            // stop thread until new tasks are available
+            threadSync.wait(lock, [this] { return waitingTasks > 0 || shutdown; });
          }
       }
 
       log.debug("executor thread {} terminated", {id});
    }
 
+   std::shared_ptr<Task> next(int index)
+   {
+      // first take most recent task from own queue
+      {
+         WorkQueue *queue = workQueues[index].get();
+
+         std::lock_guard<std::mutex> lock(queue->mutex);
+
+         if (!queue->tasks.empty())
+         {
+            auto task = queue->tasks.back();
+            queue->tasks.pop_back();
+            waitingTasks--;
+            return task;
+         }
+      }
+
+      // then try to steal oldest task from other queues
+      for (unsigned int i = 1; i < workQueues.size(); i++)
+      {
+         WorkQueue *queue = workQueues[(index + i) % workQueues.size()].get();
+
+         std::lock_guard<std::mutex> lock(queue->mutex);
+
+         if (!queue->tasks.empty())
+         {
+            auto task = queue->tasks.front();
+            queue->tasks.pop_front();
+            waitingTasks--;
+            return task;
+         }
+      }
+
+      return nullptr;
+   }
+
+   void run(const std::shared_ptr<Task> &task, std::thread::id id)
+   {
+      try
+      {
+         log.debug("task {} started in thread {}", {task->name(), id});
+
+         task->run(); // call next handler
+
+         log.debug("task {} finished in thread {}", {task->name(), id});
+      }
+      catch (...)
+      {
+         log.error("unhandled task {} exception in thread {}", {task->name(), id});
+      }
+
+      // on shutdown process do not remove from list to avoid concurrent modification
+      if (!shutdown)
+      {
+         runningTasks.remove(task);
+      }
+   }
+
    void submit(Task *task)
+   {
+      if (!shutdown && !workQueues.empty())
+      {
+         // pool threads push to own queue, others distribute in round-robin
+         int index = currentQueue >= 0 ? currentQueue : int(nextQueue++ % workQueues.size());
+
+         WorkQueue *queue = workQueues[index].get();
+
+         // add task to work queue
+         {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+
+            queue->tasks.emplace_back(task);
+         }
+
+         // notify one waiting thread
+         {
+            std::lock_guard<std::mutex> lock(syncMutex);
+
+            waitingTasks++;
+         }
+
+         threadSync.notify_one();
+      }
+   }
+
+   void submit(Task *task, int priority, int cpuCore)
    {
       if (!shutdown)
       {
-         // add task to wait pool
-         waitingTasks.add(task);
+         std::shared_ptr<Task> shared(task);
+
+         std::lock_guard<std::mutex> lock(dedicatedMutex);
+
+         // register before thread start so shutdown can always reach the task
+         runningTasks.add(shared);
 
-         // notify waiting threads
-         threadSync.notify_all();
+         dedicatedList.emplace_back([this, shared, priority, cpuCore] {
+
+            // configure scheduling for current thread
+            Executor::schedule(shared->name(), priority, cpuCore);
+
+            run(shared, std::this_thread::get_id());
+         });
       }
    }
 
-   void terminate(int timeout)
+   void terminate()
    {
       log.info("stopping threads of the executor service");
 
       // signal executor shutdown
-      shutdown = true;
+      {
+         std::lock_guard<std::mutex> lock(syncMutex);
+
+         shutdown = true;
+      }
 
       // terminate running tasks
       while (auto task = runningTasks.get())
@@ -162,20 +284,44 @@ struct Executor::Impl
          }
       }
 
+      // joint all dedicated threads
+      {
+         std::lock_guard<std::mutex> lock(dedicatedMutex);
+
+         for (auto &thread : dedicatedList)
+         {
+            if (thread.joinable())
+            {
+               log.debug("joint on thread {}", {thread.get_id()});
+
+               thread.join();
+            }
+         }
+      }
+
       // finally remove waiting tasks
-      waitingTasks.clear();
+      for (auto &queue : workQueues)
+      {
+         std::lock_guard<std::mutex> lock(queue->mutex);
+
+         queue->tasks.clear();
+      }
+
+      waitingTasks = 0;
 
       log.info("all threads terminated, executor service shutdown completed!");
    }
 };
 
+thread_local int Executor::Impl::currentQueue = -1;
+
 Executor::Executor(int poolSize, int coreSize) : impl(std::make_shared<Impl>(poolSize, coreSize))
 {
 }
 
 Executor::~Executor()
 {
-   impl->terminate(0);
+   impl->terminate();
 }
 
 void Executor::submit(Task *task)
@@ -183,9 +329,91 @@ void Executor::submit(Task *task)
    impl->submit(task);
 }
 
+void Executor::submit(Task *task, int priority, int cpuCore)
+{
+   impl->submit(task, priority, cpuCore);
+}
+
 void Executor::shutdown()
 {
-   impl->terminate(0);
+   impl->terminate();
+}
+
+void Executor::schedule(const std::string &name, int priority, int cpuCore)
+{
+   static rt::Logger log {"Executor"};
+
+   int cores = (int) std::thread::hardware_concurrency();
+
+   if (cpuCore != AnyCore && (cpuCore < 0 || cpuCore >= cores))
+   {
+      log.warn("thread {} requested core {} but only {} available, affinity ignored", {name, cpuCore, cores});
+
+      cpuCore = AnyCore;
+   }
+
+#ifdef _WIN32
+   HANDLE thread = GetCurrentThread();
+
+   if (cpuCore != AnyCore && !SetThreadAffinityMask(thread, DWORD_PTR(1) << cpuCore))
+      log.warn("thread {} failed SetThreadAffinityMask: {}", {name, (unsigned long) GetLastError()});
+
+   int level;
+
+   switch (priority)
+   {
+      case Lowest:
+         level = THREAD_PRIORITY_LOWEST;
+         break;
+      case Low:
+         level = THREAD_PRIORITY_BELOW_NORMAL;
+         break;
+      case High:
+         level = THREAD_PRIORITY_ABOVE_NORMAL;
+         break;
+      case Highest:
+         level = THREAD_PRIORITY_HIGHEST;
+         break;
+      case Realtime:
+         level = THREAD_PRIORITY_TIME_CRITICAL;
+         break;
+      default:
+         level = THREAD_PRIORITY_NORMAL;
+         break;
+   }
+
+   if (!SetThreadPriority(thread, level))
+      log.warn("thread {} failed SetThreadPriority: {}", {name, (unsigned long) GetLastError()});
+#else
+   if (cpuCore != AnyCore)
+   {
+      cpu_set_t cpuset;
+
+      CPU_ZERO(&cpuset);
+      CPU_SET(cpuCore, &cpuset);
+
+      if (int error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset))
+         log.warn("thread {} failed pthread_setaffinity_np: {}", {name, error});
+   }
+
+   if (priority == Realtime)
+   {
+      sched_param param {};
+
+      param.sched_priority = (sched_get_priority_min(SCHED_FIFO) + sched_get_priority_max(SCHED_FIFO)) / 2;
+
+      if (int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param))
+         log.warn("thread {} failed pthread_setschedparam: {}", {name, error});
+   }
+   else if (priority != Normal)
+   {
+      // per-thread nice value, 5 levels per priority step
+      if (setpriority(PRIO_PROCESS, (id_t) syscall(SYS_gettid), -5 * priority) < 0)
+         log.warn("thread {} failed setpriority: {}", {name, errno});
+   }
+#endif
+
+   log.info("thread {} scheduled with priority {} on core {}", {name, priority, cpuCore});
 }
 
 }
\ No newline at end of file
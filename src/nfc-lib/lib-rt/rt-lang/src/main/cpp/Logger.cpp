@@ -97,7 +97,7 @@ struct LogWriter
    {
       delete event;
    }
-} writer;
+};
 #endif
 
 // direct to stderr logger, warning, performance impact! use only for strange debugging when others logger do not work!
@@ -121,23 +121,23 @@ struct LogWriter
       delete event;
    }
 
-} writer;
+};
 #endif
 
 // threaded logger to console stdout, runs on low priority thread
 #ifdef STDOUT_LOG
 struct LogWriter
 {
-   // writer thread
-   std::thread thread;
-
    // shutdown flag
    std::atomic<bool> shutdown;
 
    // events queue
    BlockingQueue<LogEvent *> queue;
 
-   LogWriter() : thread([this] { this->exec(); }), shutdown(false)
+   // writer thread, declared last so it starts after all other members are constructed
+   std::thread thread;
+
+   LogWriter() : shutdown(false), thread([this] { this->exec(); })
    {
       sched_param param {0};
 
@@ -170,6 +170,12 @@ struct LogWriter
             write(event.value());
          }
       }
+
+      // flush events queued before shutdown
+      for (auto event : queue.drain())
+      {
+         write(event);
+      }
    }
 
    void write(LogEvent *event)
@@ -189,16 +195,13 @@ struct LogWriter
       delete event;
    }
 
-} writer;
+};
 #endif
 
 // threaded logger to file stream, runs on low priority thread
 #ifdef FSTREAM_LOG
 struct LogWriter
 {
-   // writer thread
-   std::thread thread;
-
    // shutdown flag
    std::atomic<bool> shutdown;
 
@@ -208,7 +211,10 @@ struct LogWriter
    // events queue
    BlockingQueue<LogEvent *> queue;
 
-   LogWriter() : thread([this] { this->exec(); }), shutdown(false)
+   // writer thread, declared last so it starts after all other members are constructed
+   std::thread thread;
+
+   LogWriter() : shutdown(false), thread([this] { this->exec(); })
    {
       sched_param param {0};
 
@@ -243,13 +249,16 @@ struct LogWriter
       {
          while (auto event = queue.get(100))
          {
-            if (stream)
-            {
-               write(event.value());
-            }
+            write(event.value());
          }
       }
 
+      // flush events queued before shutdown
+      for (auto event : queue.drain())
+      {
+         write(event);
+      }
+
       // close file
       stream.close();
    }
@@ -266,16 +275,28 @@ struct LogWriter
 
       strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &timeinfo);
 
-      snprintf(buffer, sizeof(buffer), "%s.%03d (thread-%d) %s [%s] %s\n", date, millis, event->thread, event->level.c_str(), event->logger.c_str(), Format::format(event->format, event->params).c_str());
+      // events are discarded if log file can not be opened
+      if (stream)
+      {
+         snprintf(buffer, sizeof(buffer), "%s.%03d (thread-%d) %s [%s] %s\n", date, millis, event->thread, event->level.c_str(), event->logger.c_str(), Format::format(event->format, event->params).c_str());
 
-      stream << buffer;
+         stream << buffer;
+      }
 
       delete event;
    }
 
-} writer;
+};
 #endif
 
+// created on first use, loggers may log from static initializers of other translation units
+static LogWriter &writer()
+{
+   static LogWriter instance;
+
+   return instance;
+}
+
 struct Logger::Impl
 {
    int levels;
@@ -298,7 +319,7 @@ void Logger::trace(const std::string &format, std::vector<Variant> params) const
 {
    if (self->levels & TRACE)
    {
-      writer.push(new LogEvent(tags[TRACE], self->name, format, std::move(params)));
+      writer().push(new LogEvent(tags[TRACE], self->name, format, std::move(params)));
    }
 }
 
@@ -306,7 +327,7 @@ void Logger::debug(const std::string &format, std::vector<Variant> params) const
 {
    if (self->levels & DEBUG)
    {
-      writer.push(new LogEvent(tags[DEBUG], self->name, format, std::move(params)));
+      writer().push(new LogEvent(tags[DEBUG], self->name, format, std::move(params)));
    }
 }
 
@@ -314,7 +335,7 @@ void Logger::info(const std::string &format, std::vector<Variant> params) const
 {
    if (self->levels & INFO)
    {
-      writer.push(new LogEvent(tags[INFO], self->name, format, std::move(params)));
+      writer().push(new LogEvent(tags[INFO], self->name, format, std::move(params)));
    }
 }
 
@@ -322,7 +343,7 @@ void Logger::warn(const std::string &format, std::vector<Variant> params) const
 {
    if (self->levels & WARN)
    {
-      writer.push(new LogEvent(tags[WARN], self->name, format, std::move(params)));
+      writer().push(new LogEvent(tags[WARN], self->name, format, std::move(params)));
    }
 }
 
@@ -330,7 +351,7 @@ void Logger::error(const std::string &format, std::vector<Variant> params) const
 {
    if (self->levels & ERROR)
    {
-      writer.push(new LogEvent(tags[ERROR], self->name, format, std::move(params)));
+      writer().push(new LogEvent(tags[ERROR], self->name, format, std::move(params)));
    }
 }
 
@@ -338,7 +359,7 @@ void Logger::print(int level, const std::string &format, std::vector<Variant> pa
 {
    if (self->levels & level)
    {
-      writer.push(new LogEvent(tags[level & 0x07], self->name, format, std::move(params)));
+      writer().push(new LogEvent(tags[level & 0x07], self->name, format, std::move(params)));
    }
 }
 
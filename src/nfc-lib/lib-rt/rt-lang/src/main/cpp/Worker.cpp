@@ -55,6 +55,9 @@ struct Worker::Impl
    // terminate flag
    std::atomic<int> terminated {0};
 
+   // pending notification flag, guarded by sleepMutex
+   bool signaled = false;
+
    explicit Impl(const std::string &name, int interval) : log(name), name(name), interval(interval)
    {
    }
@@ -64,19 +67,32 @@ struct Worker::Impl
       terminate();
    }
 
-   // wait and wait for notification
-   inline void wait(int milliseconds)
+   // wait for notification or timeout, returns true if notified
+   inline bool wait(int milliseconds)
    {
       std::unique_lock<std::mutex> lock(sleepMutex);
 
       if (milliseconds > 0)
-         sync.wait_for(lock, std::chrono::milliseconds(milliseconds));
+         sync.wait_for(lock, std::chrono::milliseconds(milliseconds), [this] { return signaled || terminated; });
       else
-         sync.wait(lock);
+         sync.wait(lock, [this] { return signaled || terminated; });
+
+      bool notified = signaled;
+
+      signaled = false;
+
+      return notified;
    }
 
+   // notifications are not lost if worker is not waiting
    inline void notify()
    {
+      {
+         std::lock_guard<std::mutex> lock(sleepMutex);
+
+         signaled = true;
+      }
+
       sync.notify_one();
    }
 
@@ -86,6 +102,11 @@ struct Worker::Impl
       // set terminate flag
       if (!terminated.fetch_add(1))
       {
+         // synchronize with waiting worker before notify
+         {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+         }
+
          // notify
          sync.notify_one();
 
@@ -109,9 +130,9 @@ bool Worker::alive()
    return !impl->terminated;
 }
 
-void Worker::wait(int milliseconds)
+bool Worker::wait(int milliseconds)
 {
-   impl->wait(milliseconds);
+   return impl->wait(milliseconds);
 }
 
 void Worker::notify()
@@ -27,6 +27,8 @@
 
 #include <list>
 #include <mutex>
+#include <optional>
+#include <functional>
 #include <condition_variable>
 
 namespace rt {
@@ -58,12 +60,12 @@ class BlockingQueue
 
          inline bool operator==(const Iterator &other)
          {
-            return it.operator==(other.it);
+            return it == other.it;
          }
 
          inline bool operator!=(const Iterator &other)
          {
-            return it.operator!=(other.it);
+            return it != other.it;
          }
 
          inline Iterator &operator++()
@@ -87,6 +89,10 @@ class BlockingQueue
 
          // notify for unlock wait
          sync.notify_all();
+
+         // notify listener
+         if (listener)
+            listener();
       }
 
       template<typename... A>
@@ -99,6 +105,10 @@ class BlockingQueue
 
          // notify for unlock wait
          sync.notify_all();
+
+         // notify listener
+         if (listener)
+            listener();
       }
 
       inline std::optional<T> get(int milliseconds = 0)
@@ -129,6 +139,25 @@ class BlockingQueue
          return value;
       }
 
+      inline std::list<T> drain()
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+
+         std::list<T> result;
+
+         // take all pending elements at once
+         result.swap(queue);
+
+         return result;
+      }
+
+      inline void listen(std::function<void()> handler)
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+
+         listener = std::move(handler);
+      }
+
       inline void remove(const T &e)
       {
          std::lock_guard<std::mutex> lock(mutex);
@@ -170,6 +199,9 @@ class BlockingQueue
 
       // synchronization condition
       mutable std::condition_variable sync;
+
+      // called on each new element, must not block
+      std::function<void()> listener;
 };
 
 }
@@ -27,6 +27,7 @@
 
 #include <atomic>
 #include <memory>
+#include <algorithm>
 #include <functional>
 
 #define BUFFER_ALIGNMENT 256
@@ -41,13 +42,16 @@ class Buffer
       struct Alloc
       {
          T *data = nullptr; // aligned payload data pointer
+         unsigned int capacity = 0; // allocated elements
          void *block = nullptr;  // raw memory block pointer
          void *context = nullptr; // custom context payload
          unsigned int type = 0; // custom data type
          unsigned int stride = 0; // custom data stride
          std::atomic<int> references; // block reference count
+         std::function<void(T *)> release; // borrowed memory release callback
+         Alloc *retained = nullptr; // owned copy of borrowed memory, shared by all retained references
 
-         Alloc(unsigned int type, unsigned int capacity, unsigned int stride, void *context) : data(nullptr), type(type), references(1), stride(stride), context(context)
+         Alloc(unsigned int type, unsigned int capacity, unsigned int stride, void *context) : data(nullptr), capacity(capacity), type(type), references(1), stride(stride), context(context)
          {
             // allocate raw memory including alignment space
             block = malloc(capacity * sizeof(T) + BUFFER_ALIGNMENT);
@@ -56,10 +60,28 @@ class Buffer
             data = (T *) ((((uintptr_t) block) + BUFFER_ALIGNMENT) & ~(BUFFER_ALIGNMENT - 1));
          }
 
+         Alloc(T *data, unsigned int capacity, unsigned int type, unsigned int stride, void *context, std::function<void(T *)> release) : data(data), capacity(capacity), type(type), references(1), stride(stride), context(context), release(std::move(release))
+         {
+         }
+
          ~Alloc()
          {
+            // release retained copy
+            if (retained && retained->detach() == 0)
+               delete retained;
+
             // release allocated buffer
-            free(block);
+            if (block)
+               free(block);
+
+            // or return borrowed memory to owner
+            else if (release)
+               release(data);
+         }
+
+         inline bool borrowed() const
+         {
+            return !block;
          }
 
          inline int attach()
@@ -79,8 +101,9 @@ class Buffer
          unsigned int position; // current data position
          unsigned int capacity; // buffer data capacity
          unsigned int limit; // buffer data limit
+         unsigned int offset; // view start within shared allocation
 
-         State(unsigned int position, unsigned int capacity, unsigned int limit) : position(position), capacity(capacity), limit(limit)
+         State(unsigned int position, unsigned int capacity, unsigned int limit, unsigned int offset = 0) : position(position), capacity(capacity), limit(limit), offset(offset)
          {
          }
 
@@ -92,10 +115,9 @@ class Buffer
       {
       }
 
-      Buffer(const Buffer &other) : state(other.state), alloc(other.alloc)
+      Buffer(const Buffer &other) : state(other.state), alloc(nullptr)
       {
-         if (alloc)
-            alloc->attach();
+         alloc = other.retain(state);
       }
 
       explicit Buffer(T *data, unsigned int capacity, unsigned int type = 0, unsigned int stride = 1, void *context = nullptr) : state(0, capacity, capacity), alloc(new Alloc(type, capacity, stride, context))
@@ -108,6 +130,11 @@ class Buffer
       {
       }
 
+      // borrowed buffer, wraps external memory without copy, valid only until release callback is called
+      Buffer(T *data, unsigned int capacity, unsigned int type, unsigned int stride, void *context, std::function<void(T *)> release) : state(0, capacity, capacity), alloc(new Alloc(data, capacity, type, stride, context, std::move(release)))
+      {
+      }
+
       ~Buffer()
       {
          if (alloc && alloc->detach() == 0)
@@ -132,10 +159,7 @@ class Buffer
             delete alloc;
 
          state = other.state;
-         alloc = other.alloc;
-
-         if (alloc)
-            alloc->attach();
+         alloc = other.retain(state);
 
          return *this;
       }
@@ -145,6 +169,11 @@ class Buffer
          return alloc;
       }
 
+      inline bool isBorrowed() const
+      {
+         return alloc && alloc->borrowed();
+      }
+
       inline bool isEmpty() const
       {
          return state.position == state.limit;
@@ -207,14 +236,14 @@ class Buffer
 
       inline T *data() const
       {
-         return alloc ? alloc->data : nullptr;
+         return alloc ? base() : nullptr;
       }
 
       inline T *pull(int size)
       {
          if (alloc && state.position + size <= state.capacity)
          {
-            T *ptr = alloc->data + state.position;
+            T *ptr = base() + state.position;
 
             state.position += size;
 
@@ -245,6 +274,23 @@ class Buffer
          return *this;
       }
 
+      // view over elements [position + offset, position + offset + length), sharing allocation with this buffer
+      inline Buffer<T> slice(unsigned int offset, unsigned int length) const
+      {
+         Buffer<T> view;
+
+         if (alloc)
+         {
+            unsigned int start = std::min(state.position + offset, state.limit);
+            unsigned int count = std::min(length, state.limit - start);
+
+            view.state = {0, count, count, state.offset + start};
+            view.alloc = retain(view.state);
+         }
+
+         return view;
+      }
+
       inline Buffer<T> &clear()
       {
          if (alloc)
@@ -281,7 +327,7 @@ class Buffer
       {
          if (alloc && state.position < state.limit)
          {
-            *data = alloc->data[state.position++];
+            *data = base()[state.position++];
          }
 
          return *this;
@@ -291,7 +337,7 @@ class Buffer
       {
          if (alloc && state.position < state.limit)
          {
-            alloc->data[state.position++] = *data;
+            base()[state.position++] = *data;
          }
 
          return *this;
@@ -301,7 +347,7 @@ class Buffer
       {
          if (alloc && state.position < state.limit)
          {
-            value = alloc->data[state.position++];
+            value = base()[state.position++];
          }
 
          return *this;
@@ -311,20 +357,22 @@ class Buffer
       {
          if (alloc && state.position < state.limit)
          {
-            alloc->data[state.position++] = value;
+            base()[state.position++] = value;
          }
 
          return *this;
       }
 
+      // bulk copy, bounds are checked once and copy is lowered to memmove for trivial types
       inline Buffer<T> &get(T *data, unsigned int size)
       {
          if (alloc)
          {
-            for (int i = 0; state.position < state.limit && i < size; i++, state.position++)
-            {
-               data[i] = alloc->data[state.position];
-            }
+            unsigned int count = std::min(size, state.limit - state.position);
+
+            std::copy_n(base() + state.position, count, data);
+
+            state.position += count;
          }
 
          return *this;
@@ -334,48 +382,115 @@ class Buffer
       {
          if (alloc)
          {
-            for (int i = 0; i < size && state.position < state.limit; i++, state.position++)
-            {
-               alloc->data[state.position] = data[i];
-            }
+            unsigned int count = std::min(size, state.limit - state.position);
+
+            std::copy_n(data, count, base() + state.position);
+
+            state.position += count;
          }
 
          return *this;
       }
 
-      template<typename E>
-      inline E reduce(E value, const std::function<E(E, T)> &handler) const
+      // contiguous view of remaining elements, from position to limit
+      inline T *begin() const
       {
-         if (alloc)
+         return alloc ? base() + state.position : nullptr;
+      }
+
+      inline T *end() const
+      {
+         return alloc ? base() + state.limit : nullptr;
+      }
+
+      // handlers are template parameters so lambdas are inlined in loop body
+      template<typename E, typename H>
+      inline E reduce(E value, H handler) const
+      {
+         for (const T *it = begin(), *last = end(); it < last; it++)
          {
-            for (int i = state.position; i < state.limit; i++)
-            {
-               value = handler(value, alloc->data[i]);
-            }
+            value = handler(value, *it);
          }
 
          return value;
       }
 
-      inline void stream(const std::function<void(const T *, unsigned int)> &handler) const
+      template<typename H>
+      inline void stream(H handler) const
       {
          if (alloc)
          {
-            for (int i = state.position; i < state.limit; i += alloc->stride)
+            for (const T *it = begin(), *last = end(); it < last; it += alloc->stride)
             {
-               handler(alloc->data + i, alloc->stride);
+               handler(it, alloc->stride);
             }
          }
       }
 
+      // in place transform of remaining elements
+      template<typename H>
+      inline Buffer<T> &transform(H handler)
+      {
+         for (T *it = begin(), *last = end(); it < last; it++)
+         {
+            *it = handler(*it);
+         }
+
+         return *this;
+      }
+
       inline T &operator[](unsigned int index)
       {
-         return alloc->data[index];
+         return base()[index];
       }
 
       inline const T &operator[](unsigned int index) const
       {
-         return alloc->data[index];
+         return base()[index];
+      }
+
+   private:
+
+      inline T *base() const
+      {
+         return alloc->data + state.offset;
+      }
+
+      // attach new reference for given view, borrowed memory is copied on first retain so copies outlive the borrow
+      inline Alloc *retain(State &view) const
+      {
+         if (!alloc)
+            return nullptr;
+
+         if (alloc->borrowed())
+         {
+            // partial views only copy their own range
+            if (view.offset != 0 || view.capacity != alloc->capacity)
+            {
+               auto copy = new Alloc(alloc->type, view.capacity, alloc->stride, alloc->context);
+
+               std::copy_n(alloc->data + view.offset, view.capacity, copy->data);
+
+               view.offset = 0;
+
+               return copy;
+            }
+
+            if (!alloc->retained)
+            {
+               alloc->retained = new Alloc(alloc->type, alloc->capacity, alloc->stride, alloc->context);
+
+               std::copy_n(alloc->data, alloc->capacity, alloc->retained->data);
+            }
+
+            alloc->retained->attach();
+
+            return alloc->retained;
+         }
+
+         alloc->attach();
+
+         return alloc;
       }
 };
 
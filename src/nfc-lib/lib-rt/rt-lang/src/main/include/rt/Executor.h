@@ -25,6 +25,9 @@
 #ifndef LANG_EXECUTOR_H
 #define LANG_EXECUTOR_H
 
+#include <memory>
+#include <string>
+
 #include <rt/Task.h>
 
 namespace rt {
@@ -33,16 +36,38 @@ class Executor
 {
       struct Impl;
 
+   public:
+
+      enum Priority
+      {
+         Lowest = -2,
+         Low = -1,
+         Normal = 0,
+         High = 1,
+         Highest = 2,
+         Realtime = 3
+      };
+
+      // run in any core
+      static constexpr int AnyCore = -1;
+
    public:
 
       explicit Executor(int poolSize = 100, int coreSize = 4);
 
       ~Executor();
 
+      // run task in shared work-stealing thread pool, for short jobs
       void submit(Task *task);
 
+      // run task in a dedicated thread with scheduling priority and optional core affinity, for long-running workers
+      void submit(Task *task, int priority, int cpuCore = AnyCore);
+
       void shutdown();
 
+      // apply scheduling priority and core affinity to calling thread, for threads not created by executor such as device callbacks
+      static void schedule(const std::string &name, int priority, int cpuCore = AnyCore);
+
    private:
 
       std::shared_ptr<Impl> impl;
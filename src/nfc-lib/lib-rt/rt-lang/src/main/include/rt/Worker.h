@@ -28,6 +28,7 @@
 #include <mutex>
 
 #include <rt/Task.h>
+#include <rt/BlockingQueue.h>
 
 namespace rt {
 
@@ -41,10 +42,16 @@ class Worker : public rt::Task
 
       bool alive();
 
-      void wait(int milliseconds = 0);
+      bool wait(int milliseconds = 0);
 
       void notify();
 
+      template<typename T>
+      void watch(BlockingQueue<T> &queue)
+      {
+         queue.listen([this] { notify(); });
+      }
+
       std::string name() override;
 
       void terminate() override;
@@ -24,6 +24,7 @@
 
 #include <queue>
 #include <mutex>
+#include <chrono>
 #include <utility>
 
 #include <airspy.h>
@@ -59,14 +60,16 @@ struct AirspyDevice::Impl
    int deviceError = 0;
    airspy_device *deviceHandle = nullptr;
    airspy_read_partid_serialno_t devicePart {};
-   airspy_sample_type deviceSample = AIRSPY_SAMPLE_FLOAT32_IQ;
 
    std::mutex streamMutex;
    std::queue<SignalBuffer> streamQueue;
    RadioDevice::StreamHandler streamCallback;
 
-   long samplesReceived = 0;
-   long samplesDropped = 0;
+   long long samplesReceived = 0;
+   long long samplesDropped = 0;
+
+   // stream index of next sample, including samples dropped by device
+   long long sampleIndex = 0;
    long samplesStreamed = 0;
 
    explicit Impl(std::string name) : deviceName(std::move(name))
@@ -158,8 +161,8 @@ struct AirspyDevice::Impl
          if ((deviceError = airspy_board_partid_serialno_read(handle, &devicePart)) != AIRSPY_SUCCESS)
             log.warn("failed airspy_board_partid_serialno_read: [{}] {}", {deviceError, airspy_error_name((enum airspy_error) deviceError)});
 
-         // set sample type yo AIRSPY_SAMPLE_FLOAT32_IQ
-         if ((deviceError = airspy_set_sample_type(handle, deviceSample)) != AIRSPY_SUCCESS)
+         // set sample type to AIRSPY_SAMPLE_FLOAT32_IQ or AIRSPY_SAMPLE_INT16_IQ
+         if ((deviceError = airspy_set_sample_type(handle, sampleType == RadioDevice::Integer ? AIRSPY_SAMPLE_INT16_IQ : AIRSPY_SAMPLE_FLOAT32_IQ)) != AIRSPY_SUCCESS)
             log.warn("failed airspy_set_sample_type: [{}] {}", {deviceError, airspy_error_name((enum airspy_error) deviceError)});
 
          // set version string
@@ -215,6 +218,7 @@ struct AirspyDevice::Impl
          // clear counters
          samplesDropped = 0;
          samplesReceived = 0;
+         sampleIndex = 0;
          samplesStreamed = 0;
          streamCallback = std::move(handler);
          streamQueue = std::queue<SignalBuffer>();
@@ -305,6 +309,34 @@ struct AirspyDevice::Impl
       return 0;
    }
 
+   int setSampleType(int value)
+   {
+      if (value != RadioDevice::Integer && value != RadioDevice::Float)
+      {
+         log.warn("unsupported sample type {}", {value});
+         return -1;
+      }
+
+      // sample conversion can not be changed while transfers are running
+      if (isStreaming())
+      {
+         log.warn("sample type can not be changed while streaming");
+         return -1;
+      }
+
+      sampleType = value;
+
+      if (deviceHandle)
+      {
+         if ((deviceError = airspy_set_sample_type(deviceHandle, sampleType == RadioDevice::Integer ? AIRSPY_SAMPLE_INT16_IQ : AIRSPY_SAMPLE_FLOAT32_IQ)) != AIRSPY_SUCCESS)
+            log.warn("failed airspy_set_sample_type: [{}] {}", {deviceError, airspy_error_name((enum airspy_error) deviceError)});
+
+         return deviceError;
+      }
+
+      return 0;
+   }
+
    int setGainMode(int mode)
    {
       gainMode = mode;
@@ -561,14 +593,12 @@ int AirspyDevice::setSampleRate(long value)
 
 int AirspyDevice::sampleType() const
 {
-   return Float;
+   return impl->sampleType;
 }
 
 int AirspyDevice::setSampleType(int value)
 {
-   impl->log.warn("setSampleType has no effect!");
-
-   return -1;
+   return impl->setSampleType(value);
 }
 
 long AirspyDevice::centerFreq() const
@@ -631,12 +661,12 @@ int AirspyDevice::setDecimation(int value)
    return impl->setDecimation(value);
 }
 
-long AirspyDevice::samplesReceived()
+long long AirspyDevice::samplesReceived()
 {
    return impl->samplesReceived;
 }
 
-long AirspyDevice::samplesDropped()
+long long AirspyDevice::samplesDropped()
 {
    return impl->samplesDropped;
 }
@@ -676,8 +706,18 @@ int process_transfer(airspy_transfer *transfer)
    // check device validity
    if (auto *device = static_cast<AirspyDevice::Impl *>(transfer->ctx))
    {
-      // generate sample block buffer
-      SignalBuffer buffer((float *) transfer->samples, transfer->sample_count * 2, 2, device->sampleRate, 0, 0);
+      // wrap transfer samples without copy, only valid during this call so any retained reference gets its own copy
+      SignalBuffer buffer = transfer->sample_type == AIRSPY_SAMPLE_INT16_IQ
+                            ? SignalBuffer((short *) transfer->samples, transfer->sample_count, device->sampleRate, nullptr, nullptr)
+                            : SignalBuffer((float *) transfer->samples, transfer->sample_count * 2, 2, device->sampleRate, 0, 0, nullptr, nullptr);
+
+      // samples dropped by device leave a gap in stream index so consumers can resynchronize
+      device->sampleIndex += transfer->dropped_samples;
+
+      buffer.setSampleOffset(device->sampleIndex);
+      buffer.setTimestamp(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+      device->sampleIndex += transfer->sample_count;
 
       // update counters
       device->samplesReceived += transfer->sample_count;
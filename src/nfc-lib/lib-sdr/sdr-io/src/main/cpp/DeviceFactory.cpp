@@ -23,6 +23,9 @@
 */
 
 #include <sdr/AirspyDevice.h>
+#include <sdr/ReplayDevice.h>
+#include <sdr/SharedDevice.h>
+#include <sdr/SyntheticDevice.h>
 #include <sdr/DeviceFactory.h>
 
 namespace sdr {
@@ -35,6 +38,15 @@ SignalDevice *DeviceFactory::newInstance(const std::string &name)
    if (name.rfind("airspy://", 0) == 0)
       return new AirspyDevice(name);
 
+   if (name.rfind("replay://", 0) == 0)
+      return new ReplayDevice(name);
+
+   if (name.rfind("shm://", 0) == 0)
+      return new SharedDevice(name);
+
+   if (name.rfind("synthetic://", 0) == 0)
+      return new SyntheticDevice(name);
+
 //   if (name.startsWith("rtlsdr://"))
 //      return new RealtekDevice(name, parent);
 
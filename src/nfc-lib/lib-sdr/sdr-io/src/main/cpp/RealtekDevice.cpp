@@ -55,8 +55,8 @@ struct RealtekDevice::Impl
    std::queue<SignalBuffer> streamQueue;
    RadioDevice::StreamHandler streamCallback;
 
-   long samplesReceived {};
-   long samplesDropped {};
+   long long samplesReceived {};
+   long long samplesDropped {};
    long samplesStreamed {};
 
    explicit Impl(const std::string &name) : name(name)
@@ -465,12 +465,12 @@ int RealtekDevice::setGainValue(int value)
    return result;
 }
 
-long RealtekDevice::samplesReceived()
+long long RealtekDevice::samplesReceived()
 {
    return impl->samplesReceived;
 }
 
-long RealtekDevice::samplesDropped()
+long long RealtekDevice::samplesDropped()
 {
    return impl->samplesDropped;
 }
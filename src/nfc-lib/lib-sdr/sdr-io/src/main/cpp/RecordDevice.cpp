@@ -22,10 +22,14 @@
 
 */
 
+#include <cmath>
 #include <queue>
+#include <future>
+#include <thread>
 #include <fstream>
 #include <iostream>
 #include <cstring>
+#include <algorithm>
 #include <utility>
 
 #include <rt/Logger.h>
@@ -33,8 +37,16 @@
 #include <sdr/SignalBuffer.h>
 #include <sdr/RecordDevice.h>
 
+#include <SampleCodec.h>
+
 #define BUFFER_SIZE (1024)
 
+// compressed container block length in sample frames, block is the random access unit
+#define PACKED_BLOCK_FRAMES (16384)
+
+// maximum number of blocks coded in parallel
+#define PACKED_MAX_WORKERS (8)
+
 namespace sdr {
 
 struct chunk
@@ -72,8 +84,37 @@ struct FILEHeader
    DATAHeader data;
 };
 
+/*
+ * compressed sample container, blocks of coded samples followed by block index
+ */
+struct PACKHeader
+{
+   char id[4];
+   unsigned short version;
+   unsigned short numChannels;
+   unsigned int sampleRate;
+   unsigned short bitsPerSample;
+   unsigned short reserved;
+   unsigned int blockFrames;
+   unsigned int blockCount;
+   unsigned long long sampleCount;
+   unsigned long long indexOffset;
+};
+
+struct PACKBlock
+{
+   unsigned int frames;
+   unsigned int size;
+};
+
 struct RecordDevice::Impl
 {
+   enum FileFormat
+   {
+      WaveFile = 0,
+      PackedFile = 1
+   };
+
    rt::Logger log {"RecordDevice"};
 
    std::string name {};
@@ -84,12 +125,21 @@ struct RecordDevice::Impl
    int sampleRate {};
    int sampleSize {};
    int sampleType {};
-   int sampleCount {};
-   int sampleOffset {};
+   long long sampleCount {};
+   long long sampleOffset {};
    int channelCount {};
+   int fileFormat {};
 
    std::fstream file;
 
+   // compressed container status, file offset of each block and pending samples
+   std::vector<unsigned long long> blockIndex;
+   std::vector<int> blockSamples;
+   unsigned int blockFrames {};
+   unsigned int blockOffset {};
+   unsigned int blockNext {};
+   unsigned int workers {};
+
    explicit Impl(std::string name) : name(std::move(name)), sampleSize(16), sampleRate(44100), sampleType(1), channelCount(1)
    {
       log.debug("created RecordDevice for name [{}]", {this->name});
@@ -121,16 +171,24 @@ struct RecordDevice::Impl
       // initialize
       sampleCount = 0;
       sampleOffset = 0;
+      fileFormat = WaveFile;
+
+      // compressed container blocks are coded in parallel
+      workers = std::clamp(std::thread::hardware_concurrency(), 1u, (unsigned int) PACKED_MAX_WORKERS);
 
       switch (mode)
       {
          case SignalDevice::Write:
          {
+            // compressed container is selected by file extension
+            if (id.size() > 4 && id.compare(id.size() - 4, 4, ".iqz") == 0)
+               fileFormat = PackedFile;
+
             file.open(id, std::ios::out | std::ios::binary | std::ios::trunc);
 
             if (file.is_open())
             {
-               if (!writeHeader())
+               if (!(fileFormat == PackedFile ? startPacked() : writeHeader()))
                {
                   file.close();
                }
@@ -145,7 +203,7 @@ struct RecordDevice::Impl
 
             if (file.is_open())
             {
-               if (!readHeader())
+               if (!readHeader() && !readPackedHeader())
                {
                   file.close();
                }
@@ -170,7 +228,10 @@ struct RecordDevice::Impl
 
          if (openMode == SignalDevice::Write)
          {
-            writeHeader();
+            if (fileFormat == PackedFile)
+               finishPacked();
+            else
+               writeHeader();
          }
 
          file.close();
@@ -184,6 +245,9 @@ struct RecordDevice::Impl
 
    bool isEof() const
    {
+      if (fileFormat == PackedFile)
+         return blockNext >= blockIndex.size() && blockOffset >= blockSamples.size();
+
       return file.eof();
    }
 
@@ -199,6 +263,9 @@ struct RecordDevice::Impl
 
    int read(SignalBuffer &buffer)
    {
+      if (fileFormat == PackedFile)
+         return readPacked(buffer);
+
       switch (sampleSize)
       {
          case 8:
@@ -218,6 +285,9 @@ struct RecordDevice::Impl
 
    int write(SignalBuffer &buffer)
    {
+      if (fileFormat == PackedFile)
+         return writePacked(buffer);
+
       switch (sampleSize)
       {
          case 8:
@@ -233,6 +303,40 @@ struct RecordDevice::Impl
       return buffer.position();
    }
 
+   bool seek(long long sample)
+   {
+      if (!file.is_open() || openMode != SignalDevice::Read || sample < 0 || sample > sampleCount)
+         return false;
+
+      // clear eof status from previous reads
+      file.clear();
+
+      // decode block containing requested sample and skip previous samples
+      if (fileFormat == PackedFile)
+      {
+         unsigned int block = (unsigned int) (sample / blockFrames);
+
+         blockNext = block;
+         blockOffset = 0;
+         blockSamples.clear();
+
+         if (blockNext < blockIndex.size() && !readBlocks())
+            return false;
+
+         blockOffset = (unsigned int) (sample - (long long) block * blockFrames) * channelCount;
+         sampleOffset = sample * channelCount;
+
+         return true;
+      }
+
+      // data chunk starts after file header, samples are interleaved for all channels
+      file.seekg(sizeof(FILEHeader) + sample * channelCount * (sampleSize / 8));
+
+      sampleOffset = sample * channelCount;
+
+      return file.good();
+   }
+
    template<typename T>
    int readSamples(SignalBuffer &buffer)
    {
@@ -244,6 +348,9 @@ struct RecordDevice::Impl
       // sample scale from float
       float scale = 1 << (8 * sizeof(T) - 1);
 
+      // stream index of first sample read
+      buffer.setSampleOffset(sampleOffset / channelCount);
+
       while (buffer.available() && file)
       {
          // read one block of samples up to BUFFER_SIZE
@@ -277,29 +384,23 @@ struct RecordDevice::Impl
       // sample scale to float
       float scale = 1 << (8 * sizeof(T) - 1);
 
-      // number of samples converted
-      int converted = 0;
+      // contiguous samples from position to limit
+      const float *data = buffer.begin();
 
-      // process all buffer contents
-      buffer.stream([this, &scale, &converted, &block](const float *value, int stride) {
+      unsigned int length = buffer.available();
 
-         for (int c = 0; c < stride; c++)
-         {
-            // convert float sample to WAV sample
-            block[converted++] = toLittleEndian<T>((T) (value[c] * scale));
+      // process all buffer contents in blocks
+      for (unsigned int offset = 0; offset < length; offset += BUFFER_SIZE)
+      {
+         unsigned int converted = std::min(length - offset, (unsigned int) BUFFER_SIZE);
 
-            // write buffered block
-            if (converted == BUFFER_SIZE)
-            {
-               file.write(reinterpret_cast<const char *>(block), sizeof(block));
-               converted = 0;
-            }
+         // convert float samples to WAV samples
+         for (unsigned int i = 0; i < converted; i++)
+         {
+            block[i] = toLittleEndian<T>((T) (data[offset + i] * scale));
          }
-      });
 
-      // write last remaining block
-      if (converted)
-      {
+         // write converted block
          file.write(reinterpret_cast<const char *>(block), converted * sizeof(T));
       }
 
@@ -310,6 +411,282 @@ struct RecordDevice::Impl
    }
 
 
+   int readPacked(SignalBuffer &buffer)
+   {
+      // sample scale from float
+      float scale = std::ldexp(1.0f, sampleSize - 1);
+
+      // stream index of first sample read
+      buffer.setSampleOffset(sampleOffset / channelCount);
+
+      while (buffer.available())
+      {
+         // decode next blocks when pending samples are consumed
+         if (blockOffset >= blockSamples.size() && !readBlocks())
+            break;
+
+         unsigned int count = std::min(buffer.available(), (unsigned int) blockSamples.size() - blockOffset);
+
+         float *data = buffer.pull(count);
+
+         for (unsigned int i = 0; i < count; i++)
+         {
+            data[i] = blockSamples[blockOffset + i] / scale;
+         }
+
+         blockOffset += count;
+      }
+
+      buffer.flip();
+
+      sampleOffset += buffer.limit();
+
+      return buffer.limit();
+   }
+
+   int writePacked(SignalBuffer &buffer)
+   {
+      // sample scale to float, samples out of range are saturated
+      double scale = std::ldexp(1.0, sampleSize - 1);
+
+      for (const float *it = buffer.begin(), *last = buffer.end(); it < last; it++)
+      {
+         blockSamples.push_back(int(std::clamp(*it * scale, -scale, scale - 1)));
+      }
+
+      // code full blocks when there is one for each worker
+      if (blockSamples.size() >= blockFrames * channelCount * workers)
+         writeBlocks(false);
+
+      sampleCount += buffer.available() / channelCount;
+      sampleOffset += buffer.available();
+
+      return buffer.position();
+   }
+
+   /*
+    * Read next group of blocks and decode them in parallel
+    */
+   bool readBlocks()
+   {
+      unsigned int count = std::min(workers, (unsigned int) blockIndex.size() - blockNext);
+
+      if (!count)
+         return false;
+
+      std::vector<PACKBlock> blocks(count);
+      std::vector<std::vector<unsigned char>> coded(count);
+      std::vector<unsigned int> start(count + 1);
+
+      for (unsigned int i = 0; i < count; i++)
+      {
+         file.seekg(blockIndex[blockNext + i]);
+
+         if (!file.read(reinterpret_cast<char *>(&blocks[i]), sizeof(PACKBlock)) || blocks[i].frames > blockFrames)
+         {
+            log.warn("invalid block {} in file [{}]", {int(blockNext + i), name});
+            return false;
+         }
+
+         coded[i].resize(blocks[i].size);
+
+         if (!file.read(reinterpret_cast<char *>(coded[i].data()), blocks[i].size))
+         {
+            log.warn("truncated block {} in file [{}]", {int(blockNext + i), name});
+            return false;
+         }
+
+         start[i + 1] = start[i] + blocks[i].frames * channelCount;
+      }
+
+      blockSamples.resize(start[count]);
+      blockOffset = 0;
+
+      std::vector<std::future<bool>> tasks;
+
+      for (unsigned int i = 0; i < count; i++)
+      {
+         tasks.push_back(std::async(std::launch::async, [&, i] {
+            return SampleCodec::decode(coded[i].data(), coded[i].size(), blocks[i].frames, channelCount, blockSamples.data() + start[i]);
+         }));
+      }
+
+      bool valid = true;
+
+      for (auto &task: tasks)
+      {
+         valid = task.get() && valid;
+      }
+
+      if (!valid)
+      {
+         log.warn("corrupted block data in file [{}]", {name});
+         return false;
+      }
+
+      blockNext += count;
+
+      return true;
+   }
+
+   /*
+    * Code pending samples in parallel and append blocks to file, last incomplete block is only written on flush
+    */
+   void writeBlocks(bool flush)
+   {
+      unsigned int length = blockFrames * channelCount;
+      unsigned int count = (blockSamples.size() + (flush ? length - 1 : 0)) / length;
+
+      std::vector<std::vector<unsigned char>> coded(count);
+      std::vector<std::future<void>> tasks;
+
+      for (unsigned int i = 0; i < count; i++)
+      {
+         unsigned int frames = std::min((unsigned int) blockSamples.size() - i * length, length) / channelCount;
+
+         tasks.push_back(std::async(std::launch::async, [&, i, frames] {
+            SampleCodec::encode(blockSamples.data() + i * length, frames, channelCount, coded[i]);
+         }));
+      }
+
+      for (unsigned int i = 0; i < count; i++)
+      {
+         unsigned int frames = std::min((unsigned int) blockSamples.size() - i * length, length) / channelCount;
+
+         tasks[i].wait();
+
+         PACKBlock block {frames, (unsigned int) coded[i].size()};
+
+         blockIndex.push_back(file.tellp());
+
+         file.write(reinterpret_cast<const char *>(&block), sizeof(PACKBlock));
+         file.write(reinterpret_cast<const char *>(coded[i].data()), coded[i].size());
+      }
+
+      // keep samples of incomplete block
+      blockSamples.erase(blockSamples.begin(), blockSamples.begin() + std::min((unsigned int) blockSamples.size(), count * length));
+   }
+
+   bool startPacked()
+   {
+      blockFrames = PACKED_BLOCK_FRAMES;
+      blockIndex.clear();
+      blockSamples.clear();
+
+      return writePackedHeader(0);
+   }
+
+   void finishPacked()
+   {
+      // write remaining samples
+      writeBlocks(true);
+
+      // block index at end of file for random access
+      unsigned long long indexOffset = file.tellp();
+
+      file.write(reinterpret_cast<const char *>(blockIndex.data()), blockIndex.size() * sizeof(unsigned long long));
+
+      writePackedHeader(indexOffset);
+   }
+
+   bool readPackedHeader()
+   {
+      PACKHeader header {};
+
+      log.debug("read RecordDevice packed header for name [{}]", {name});
+
+      file.clear();
+      file.seekg(0);
+
+      if (!file.read(reinterpret_cast<char *>(&header), sizeof(PACKHeader)))
+         return false;
+
+      if (std::memcmp(&header.id, "NIQZ", 4) != 0 || header.version != 1)
+         return false;
+
+      if (!header.numChannels || !header.blockFrames || header.bitsPerSample < 8 || header.bitsPerSample > 32)
+         return false;
+
+      // Establish format
+      fileFormat = PackedFile;
+      sampleType = SignalDevice::Integer;
+      sampleRate = header.sampleRate;
+      sampleSize = header.bitsPerSample;
+      channelCount = header.numChannels;
+      blockFrames = header.blockFrames;
+
+      blockIndex.clear();
+      blockSamples.clear();
+      blockOffset = 0;
+      blockNext = 0;
+
+      // block index is written when recording is closed
+      if (header.indexOffset)
+      {
+         blockIndex.resize(header.blockCount);
+
+         file.seekg(header.indexOffset);
+
+         if (!file.read(reinterpret_cast<char *>(blockIndex.data()), blockIndex.size() * sizeof(unsigned long long)))
+            return false;
+
+         sampleCount = header.sampleCount;
+      }
+
+         // otherwise rebuild index from block headers, discarding incomplete last block
+      else
+      {
+         PACKBlock block {};
+
+         file.seekg(0, std::ios::end);
+
+         unsigned long long size = file.tellg();
+         unsigned long long offset = sizeof(PACKHeader);
+
+         while (offset + sizeof(PACKBlock) <= size)
+         {
+            file.seekg(offset);
+
+            if (!file.read(reinterpret_cast<char *>(&block), sizeof(PACKBlock)) || offset + sizeof(PACKBlock) + block.size > size)
+               break;
+
+            blockIndex.push_back(offset);
+
+            sampleCount += block.frames;
+
+            offset += sizeof(PACKBlock) + block.size;
+         }
+
+         log.warn("file [{}] was not closed, recovered {} blocks", {name, (int) blockIndex.size()});
+      }
+
+      file.clear();
+
+      sampleOffset = 0;
+
+      return true;
+   }
+
+   bool writePackedHeader(unsigned long long indexOffset)
+   {
+      PACKHeader header = {{'N', 'I', 'Q', 'Z'}, 1};
+
+      log.debug("write RecordDevice packed header for name [{}]", {name});
+
+      header.numChannels = channelCount;
+      header.sampleRate = sampleRate;
+      header.bitsPerSample = sampleSize;
+      header.blockFrames = blockFrames;
+      header.blockCount = blockIndex.size();
+      header.sampleCount = sampleCount;
+      header.indexOffset = indexOffset;
+
+      file.seekp(0);
+      file.write(reinterpret_cast<char *>(&header), sizeof(PACKHeader));
+
+      return file.good();
+   }
+
    bool readHeader()
    {
       FILEHeader header {};
@@ -433,12 +810,12 @@ bool RecordDevice::isStreaming() const
    return impl->isStreaming();
 }
 
-int RecordDevice::sampleCount() const
+long long RecordDevice::sampleCount() const
 {
    return impl->sampleCount;
 }
 
-int RecordDevice::sampleOffset() const
+long long RecordDevice::sampleOffset() const
 {
    return impl->sampleOffset;
 }
@@ -499,4 +876,9 @@ int RecordDevice::write(SignalBuffer &buffer)
    return impl->write(buffer);
 }
 
+bool RecordDevice::seek(long long sample)
+{
+   return impl->seek(sample);
+}
+
 }
@@ -0,0 +1,552 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <utility>
+
+#include <rt/Logger.h>
+
+#include <sdr/SignalBuffer.h>
+#include <sdr/RecordDevice.h>
+#include <sdr/ReplayDevice.h>
+
+namespace sdr {
+
+struct ReplayDevice::Impl
+{
+   rt::Logger log {"ReplayDevice"};
+
+   std::string deviceName;
+   std::string deviceVersion {"1.0"};
+   long centerFreq = 13.56E6;
+   int gainMode = 0;
+   int gainValue = 0;
+   int tunerAgc = 0;
+   int mixerAgc = 0;
+   int decimation = 0;
+
+   // recording source
+   std::shared_ptr<RecordDevice> source;
+   unsigned int channels = 0;
+   long sampleRate = 0;
+   int sampleSize = 0;
+   int sampleType = RadioDevice::Float;
+
+   // stream parameters, may be changed while streaming
+   std::atomic<float> streamSpeed {1};
+   std::atomic<unsigned int> transferSize {65536};
+   std::atomic<float> dropRate {0};
+   std::atomic<int> maxLatency {0};
+   std::atomic<bool> loop {false};
+
+   // fixed seed so injected drops are reproducible
+   std::mt19937 random {0x52504c59};
+   std::uniform_real_distribution<float> uniform {0.0f, 1.0f};
+
+   // streaming thread
+   std::thread streamThread;
+   std::atomic<bool> streamActive {false};
+   std::atomic<bool> streamEnd {false};
+   RadioDevice::StreamHandler streamCallback;
+
+   // stream index of next transfer, including dropped samples
+   long long streamIndex = 0;
+
+   // stream statistics
+   std::atomic<long long> samplesReceived {0};
+   std::atomic<long long> samplesDropped {0};
+   std::atomic<long> samplesStreamed {0};
+
+   explicit Impl(std::string name) : deviceName(std::move(name))
+   {
+      log.debug("created ReplayDevice for name [{}]", {this->deviceName});
+   }
+
+   ~Impl()
+   {
+      log.debug("destroy ReplayDevice");
+
+      close();
+   }
+
+   bool open(SignalDevice::OpenMode mode)
+   {
+      if (deviceName.find("replay://") != 0)
+      {
+         log.warn("invalid device name [{}]", {deviceName});
+         return false;
+      }
+
+      if (mode != SignalDevice::Read)
+      {
+         log.warn("replay device only supports read mode");
+         return false;
+      }
+
+      close();
+
+      source = std::make_shared<RecordDevice>(deviceName.substr(9));
+
+      if (!source->open(SignalDevice::Read))
+      {
+         log.warn("unable to open recording [{}]", {deviceName});
+         source.reset();
+         return false;
+      }
+
+      channels = source->channelCount();
+      sampleRate = source->sampleRate();
+      sampleSize = source->sampleSize();
+      streamIndex = 0;
+      streamEnd = false;
+
+      log.info("replay {} channels at {} samples per second from [{}]", {channels, sampleRate, deviceName});
+
+      return true;
+   }
+
+   void close()
+   {
+      stop();
+
+      if (source)
+      {
+         source->close();
+         source.reset();
+      }
+   }
+
+   int start(RadioDevice::StreamHandler handler)
+   {
+      if (!source)
+         return -1;
+
+      stop();
+
+      log.info("start streaming for device {}, speed {} transfer {} samples", {deviceName, (float) streamSpeed, (unsigned int) transferSize});
+
+      samplesReceived = 0;
+      samplesDropped = 0;
+      samplesStreamed = 0;
+      streamCallback = std::move(handler);
+      streamActive = true;
+
+      streamThread = std::thread([this] { streamLoop(); });
+
+      return 0;
+   }
+
+   int stop()
+   {
+      if (streamThread.joinable())
+      {
+         log.info("stop streaming for device {}", {deviceName});
+
+         streamActive = false;
+         streamThread.join();
+         streamCallback = nullptr;
+
+         return 0;
+      }
+
+      return -1;
+   }
+
+   /*
+    * Deliver recording in fixed size transfers, each one is due when its last sample would have been captured
+    */
+   void streamLoop()
+   {
+      auto streamStart = std::chrono::steady_clock::now();
+      long long streamFirst = streamIndex;
+      float speed = streamSpeed;
+      bool rewound = false;
+
+      while (streamActive)
+      {
+         SignalBuffer buffer(transferSize * channels, channels, sampleRate);
+
+         if (source->read(buffer) <= 0)
+         {
+            // rewind recording and continue with same stream index, unless nothing was read since last rewind
+            if (loop && !rewound && source->seek(0))
+            {
+               rewound = true;
+               continue;
+            }
+
+            if (rewound)
+               log.warn("no samples after rewind of device {}, stop looping", {deviceName});
+            else
+               log.info("end of recording for device {}", {deviceName});
+
+            streamEnd = true;
+
+            break;
+         }
+
+         unsigned int samples = buffer.elements();
+
+         rewound = false;
+
+         // stream offset is continuous across loops and drops
+         buffer.setSampleOffset(streamIndex);
+
+         streamIndex += samples;
+
+         // pacing restarts from current transfer when speed changes
+         if (speed != streamSpeed)
+         {
+            speed = streamSpeed;
+            streamStart = std::chrono::steady_clock::now();
+            streamFirst = streamIndex - samples;
+         }
+
+         if (speed > 0)
+         {
+            auto due = streamStart + std::chrono::microseconds((long long) (1E6 * double(streamIndex - streamFirst) / (sampleRate * speed)));
+            auto now = std::chrono::steady_clock::now();
+
+            if (now < due)
+            {
+               std::this_thread::sleep_until(due);
+            }
+
+               // consumer is late, receiver buffers are exhausted
+            else if (maxLatency > 0 && now - due > std::chrono::milliseconds(maxLatency.load()))
+            {
+               samplesDropped += samples;
+               continue;
+            }
+         }
+
+         // injected transfer loss
+         if (dropRate > 0 && uniform(random) < dropRate)
+         {
+            samplesDropped += samples;
+            continue;
+         }
+
+         buffer.setTimestamp(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+         samplesReceived += samples;
+         samplesStreamed += samples;
+
+         if (streamCallback)
+            streamCallback(buffer);
+      }
+
+      streamActive = false;
+   }
+
+   bool isOpen() const
+   {
+      return source != nullptr;
+   }
+
+   bool isEof() const
+   {
+      return streamEnd;
+   }
+
+   bool isReady() const
+   {
+      return source && !streamEnd;
+   }
+
+   bool isStreaming() const
+   {
+      return streamActive;
+   }
+
+   int read(SignalBuffer &buffer)
+   {
+      if (!source || streamActive)
+         return -1;
+
+      int result = source->read(buffer);
+
+      if (result > 0)
+      {
+         buffer.setSampleOffset(streamIndex);
+
+         streamIndex += buffer.elements();
+      }
+      else
+      {
+         streamEnd = true;
+      }
+
+      return result;
+   }
+
+   std::map<int, std::string> supportedSampleRates() const
+   {
+      std::map<int, std::string> result;
+
+      if (sampleRate)
+         result[sampleRate] = std::to_string(sampleRate);
+
+      return result;
+   }
+
+   std::map<int, std::string> supportedGainModes() const
+   {
+      return {{0, "Fixed"}};
+   }
+
+   std::map<int, std::string> supportedGainValues() const
+   {
+      return {{0, "0 db"}};
+   }
+};
+
+ReplayDevice::ReplayDevice(const std::string &name) : impl(std::make_shared<Impl>(name))
+{
+}
+
+const std::string &ReplayDevice::name()
+{
+   return impl->deviceName;
+}
+
+const std::string &ReplayDevice::version()
+{
+   return impl->deviceVersion;
+}
+
+bool ReplayDevice::open(SignalDevice::OpenMode mode)
+{
+   return impl->open(mode);
+}
+
+void ReplayDevice::close()
+{
+   impl->close();
+}
+
+int ReplayDevice::start(StreamHandler handler)
+{
+   return impl->start(handler);
+}
+
+int ReplayDevice::stop()
+{
+   return impl->stop();
+}
+
+bool ReplayDevice::isOpen() const
+{
+   return impl->isOpen();
+}
+
+bool ReplayDevice::isEof() const
+{
+   return impl->isEof();
+}
+
+bool ReplayDevice::isReady() const
+{
+   return impl->isReady();
+}
+
+bool ReplayDevice::isStreaming() const
+{
+   return impl->isStreaming();
+}
+
+int ReplayDevice::sampleSize() const
+{
+   return impl->sampleSize;
+}
+
+int ReplayDevice::setSampleSize(int value)
+{
+   return value == impl->sampleSize ? 0 : -1;
+}
+
+long ReplayDevice::sampleRate() const
+{
+   return impl->sampleRate;
+}
+
+int ReplayDevice::setSampleRate(long value)
+{
+   // recording sample rate can not be changed
+   return value == impl->sampleRate ? 0 : -1;
+}
+
+int ReplayDevice::sampleType() const
+{
+   return impl->sampleType;
+}
+
+int ReplayDevice::setSampleType(int value)
+{
+   return value == RadioDevice::Float ? 0 : -1;
+}
+
+long ReplayDevice::centerFreq() const
+{
+   return impl->centerFreq;
+}
+
+int ReplayDevice::setCenterFreq(long value)
+{
+   impl->centerFreq = value;
+
+   return 0;
+}
+
+int ReplayDevice::tunerAgc() const
+{
+   return impl->tunerAgc;
+}
+
+int ReplayDevice::setTunerAgc(int value)
+{
+   impl->tunerAgc = value;
+
+   return 0;
+}
+
+int ReplayDevice::mixerAgc() const
+{
+   return impl->mixerAgc;
+}
+
+int ReplayDevice::setMixerAgc(int value)
+{
+   impl->mixerAgc = value;
+
+   return 0;
+}
+
+int ReplayDevice::gainMode() const
+{
+   return impl->gainMode;
+}
+
+int ReplayDevice::setGainMode(int value)
+{
+   impl->gainMode = value;
+
+   return 0;
+}
+
+int ReplayDevice::gainValue() const
+{
+   return impl->gainValue;
+}
+
+int ReplayDevice::setGainValue(int value)
+{
+   impl->gainValue = value;
+
+   return 0;
+}
+
+int ReplayDevice::decimation() const
+{
+   return impl->decimation;
+}
+
+int ReplayDevice::setDecimation(int value)
+{
+   impl->decimation = value;
+
+   return 0;
+}
+
+long long ReplayDevice::samplesReceived()
+{
+   return impl->samplesReceived;
+}
+
+long long ReplayDevice::samplesDropped()
+{
+   return impl->samplesDropped;
+}
+
+long ReplayDevice::samplesStreamed()
+{
+   return impl->samplesStreamed;
+}
+
+std::map<int, std::string> ReplayDevice::supportedSampleRates() const
+{
+   return impl->supportedSampleRates();
+}
+
+std::map<int, std::string> ReplayDevice::supportedGainValues() const
+{
+   return impl->supportedGainValues();
+}
+
+std::map<int, std::string> ReplayDevice::supportedGainModes() const
+{
+   return impl->supportedGainModes();
+}
+
+int ReplayDevice::read(SignalBuffer &buffer)
+{
+   return impl->read(buffer);
+}
+
+int ReplayDevice::write(SignalBuffer &buffer)
+{
+   return -1;
+}
+
+void ReplayDevice::setStreamSpeed(float speed)
+{
+   impl->streamSpeed = speed;
+}
+
+void ReplayDevice::setTransferSize(unsigned int samples)
+{
+   if (samples > 0)
+      impl->transferSize = samples;
+}
+
+void ReplayDevice::setDropRate(float rate)
+{
+   impl->dropRate = rate;
+}
+
+void ReplayDevice::setMaxLatency(int milliseconds)
+{
+   impl->maxLatency = milliseconds;
+}
+
+void ReplayDevice::setLoop(bool loop)
+{
+   impl->loop = loop;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,335 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#include <cstdint>
+
+#include <SampleCodec.h>
+
+// predictor code for constant channels
+#define ORDER_CONSTANT 15
+
+// maximum fixed predictor order
+#define ORDER_MAXIMUM 3
+
+// rice quotient escape, residuals with larger quotient are stored raw
+#define RICE_ESCAPE 32
+
+namespace sdr {
+
+struct BitWriter
+{
+   std::vector<unsigned char> &output;
+
+   // pending bits, aligned to lsb
+   uint64_t buffer = 0;
+   unsigned int bits = 0;
+
+   explicit BitWriter(std::vector<unsigned char> &output) : output(output)
+   {
+   }
+
+   inline void put(uint32_t value, unsigned int count)
+   {
+      buffer = (buffer << count) | (value & ((1ull << count) - 1));
+      bits += count;
+
+      while (bits >= 8)
+      {
+         bits -= 8;
+         output.push_back(buffer >> bits);
+      }
+   }
+
+   inline void ones(unsigned int count)
+   {
+      for (; count >= 16; count -= 16)
+         put(0xffff, 16);
+
+      put((1u << count) - 1, count);
+   }
+
+   inline void flush()
+   {
+      if (bits)
+         put(0, 8 - bits);
+   }
+};
+
+struct BitReader
+{
+   const unsigned char *data;
+   unsigned int size;
+   unsigned int offset = 0;
+
+   // pending bits, aligned to msb, zero padded after end of data
+   uint64_t buffer = 0;
+   unsigned int bits = 0;
+
+   // total consumed bits
+   uint64_t consumed = 0;
+
+   BitReader(const unsigned char *data, unsigned int size) : data(data), size(size)
+   {
+   }
+
+   inline void fill()
+   {
+      while (bits <= 56)
+      {
+         uint64_t next = offset < size ? data[offset] : 0;
+
+         buffer |= next << (56 - bits);
+         offset++;
+         bits += 8;
+      }
+   }
+
+   inline void skip(unsigned int count)
+   {
+      buffer <<= count;
+      bits -= count;
+      consumed += count;
+   }
+
+   inline uint32_t get(unsigned int count)
+   {
+      if (!count)
+         return 0;
+
+      fill();
+
+      auto value = uint32_t(buffer >> (64 - count));
+
+      skip(count);
+
+      return value;
+   }
+
+   // count leading one bits up to limit, terminating zero is consumed
+   inline unsigned int unary(unsigned int limit)
+   {
+      fill();
+
+      unsigned int run = ~buffer ? __builtin_clzll(~buffer) : 64;
+
+      if (run >= limit)
+      {
+         skip(limit);
+         return limit;
+      }
+
+      skip(run + 1);
+
+      return run;
+   }
+
+   inline bool valid() const
+   {
+      return consumed <= uint64_t(size) * 8;
+   }
+};
+
+inline uint64_t zigzag(int64_t value)
+{
+   return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value)
+{
+   return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+// fixed polynomial predictors, x[n] estimated from x[n-1], x[n-2], x[n-3]
+inline int64_t predict(unsigned int order, const int *x, unsigned int channels)
+{
+   switch (order)
+   {
+      case 1:
+         return int64_t(x[-1 * int(channels)]);
+
+      case 2:
+         return 2 * int64_t(x[-1 * int(channels)]) - int64_t(x[-2 * int(channels)]);
+
+      case 3:
+         return 3 * int64_t(x[-1 * int(channels)]) - 3 * int64_t(x[-2 * int(channels)]) + int64_t(x[-3 * int(channels)]);
+
+      default:
+         return 0;
+   }
+}
+
+static void encodeChannel(const int *samples, unsigned int frames, unsigned int channels, BitWriter &writer)
+{
+   bool constant = true;
+
+   for (unsigned int i = 1; i < frames && constant; i++)
+   {
+      constant = samples[i * channels] == samples[0];
+   }
+
+   // carrier only or silence stretches are stored as single value
+   if (constant)
+   {
+      writer.put(ORDER_CONSTANT, 4);
+      writer.put(uint32_t(samples[0]), 32);
+      return;
+   }
+
+   // residual magnitude for each predictor order
+   uint64_t residual[ORDER_MAXIMUM + 1] {0,};
+
+   for (unsigned int i = ORDER_MAXIMUM; i < frames; i++)
+   {
+      const int *x = samples + i * channels;
+
+      for (unsigned int order = 0; order <= ORDER_MAXIMUM; order++)
+      {
+         residual[order] += zigzag(int64_t(x[0]) - predict(order, x, channels));
+      }
+   }
+
+   unsigned int order = 0;
+
+   if (frames > ORDER_MAXIMUM)
+   {
+      for (unsigned int i = 1; i <= ORDER_MAXIMUM; i++)
+      {
+         if (residual[i] < residual[order])
+            order = i;
+      }
+   }
+
+   // rice parameter from mean residual
+   unsigned int k = 0;
+   uint64_t count = frames - order;
+
+   while (k < 31 && (count << (k + 1)) < residual[order])
+      k++;
+
+   writer.put(order, 4);
+   writer.put(k, 5);
+
+   // warm-up samples
+   for (unsigned int i = 0; i < order; i++)
+   {
+      writer.put(uint32_t(samples[i * channels]), 32);
+   }
+
+   // rice coded residuals
+   for (unsigned int i = order; i < frames; i++)
+   {
+      const int *x = samples + i * channels;
+
+      uint64_t value = zigzag(int64_t(x[0]) - predict(order, x, channels));
+      uint64_t quotient = value >> k;
+
+      if (quotient < RICE_ESCAPE)
+      {
+         writer.ones(quotient);
+         writer.put(0, 1);
+         writer.put(uint32_t(value), k);
+      }
+      else
+      {
+         writer.ones(RICE_ESCAPE);
+         writer.put(uint32_t(value >> 32), 32);
+         writer.put(uint32_t(value), 32);
+      }
+   }
+}
+
+static bool decodeChannel(int *samples, unsigned int frames, unsigned int channels, BitReader &reader)
+{
+   unsigned int order = reader.get(4);
+
+   if (order == ORDER_CONSTANT)
+   {
+      int value = int(reader.get(32));
+
+      for (unsigned int i = 0; i < frames; i++)
+         samples[i * channels] = value;
+
+      return true;
+   }
+
+   if (order > ORDER_MAXIMUM || order > frames)
+      return false;
+
+   unsigned int k = reader.get(5);
+
+   for (unsigned int i = 0; i < order; i++)
+   {
+      samples[i * channels] = int(reader.get(32));
+   }
+
+   for (unsigned int i = order; i < frames; i++)
+   {
+      int *x = samples + i * channels;
+
+      uint64_t value;
+      unsigned int quotient = reader.unary(RICE_ESCAPE);
+
+      if (quotient < RICE_ESCAPE)
+      {
+         value = (uint64_t(quotient) << k) | reader.get(k);
+      }
+      else
+      {
+         value = uint64_t(reader.get(32)) << 32;
+         value |= reader.get(32);
+      }
+
+      x[0] = int(unzigzag(value) + predict(order, x, channels));
+   }
+
+   return true;
+}
+
+void SampleCodec::encode(const int *samples, unsigned int frames, unsigned int channels, std::vector<unsigned char> &output)
+{
+   BitWriter writer(output);
+
+   for (unsigned int c = 0; c < channels; c++)
+   {
+      encodeChannel(samples + c, frames, channels, writer);
+   }
+
+   writer.flush();
+}
+
+bool SampleCodec::decode(const unsigned char *data, unsigned int size, unsigned int frames, unsigned int channels, int *samples)
+{
+   BitReader reader(data, size);
+
+   for (unsigned int c = 0; c < channels; c++)
+   {
+      if (!decodeChannel(samples + c, frames, channels, reader))
+         return false;
+   }
+
+   return reader.valid();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#ifndef SDR_SAMPLECODEC_H
+#define SDR_SAMPLECODEC_H
+
+#include <vector>
+
+namespace sdr {
+
+/*
+ * lossless block codec for integer samples, each channel is coded with best fixed linear predictor (order 0 to 3)
+ * and rice codes for prediction residuals, constant channels are stored as one value
+ */
+struct SampleCodec
+{
+   // encode one block of interleaved samples, coded data is appended to output
+   static void encode(const int *samples, unsigned int frames, unsigned int channels, std::vector<unsigned char> &output);
+
+   // decode one block of interleaved samples, false if coded data is not valid
+   static bool decode(const unsigned char *data, unsigned int size, unsigned int frames, unsigned int channels, int *samples);
+};
+
+}
+
+#endif //SDR_SAMPLECODEC_H
\ No newline at end of file
@@ -0,0 +1,614 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+#include <rt/Logger.h>
+
+#include <sdr/SignalBuffer.h>
+#include <sdr/SharedRing.h>
+#include <sdr/SharedDevice.h>
+
+namespace sdr {
+
+// wait time when ring has no new samples
+#define POLL_INTERVAL std::chrono::milliseconds(1)
+
+// time between writer process checks while ring is idle
+#define LIVENESS_INTERVAL std::chrono::milliseconds(250)
+
+struct SharedDevice::Impl
+{
+   rt::Logger log {"SharedDevice"};
+
+   std::string deviceName;
+   std::string deviceVersion {"1.0"};
+   long centerFreq = 13.56E6;
+   int gainMode = 0;
+   int gainValue = 0;
+   int tunerAgc = 0;
+   int mixerAgc = 0;
+   int decimation = 0;
+
+   // shared ring reader
+   std::shared_ptr<SharedRing> ring;
+   unsigned int channels = 0;
+   unsigned int capacity = 0;
+   long sampleRate = 0;
+   int sampleSize = 32;
+   int sampleType = RadioDevice::Float;
+
+   // maximum samples per transfer
+   std::atomic<unsigned int> transferSize {65536};
+
+   // streaming thread
+   std::thread streamThread;
+   std::atomic<bool> streamActive {false};
+   std::atomic<bool> streamEnd {false};
+   RadioDevice::StreamHandler streamCallback;
+
+   // stream index of next sample to read
+   unsigned long long readIndex = 0;
+
+   // last time writer process was found running
+   std::chrono::steady_clock::time_point writerSeen;
+   bool writerGone = false;
+
+   // stream statistics
+   std::atomic<long long> samplesReceived {0};
+   std::atomic<long long> samplesDropped {0};
+   std::atomic<long> samplesStreamed {0};
+
+   explicit Impl(std::string name) : deviceName(std::move(name))
+   {
+      log.debug("created SharedDevice for name [{}]", {this->deviceName});
+   }
+
+   ~Impl()
+   {
+      log.debug("destroy SharedDevice");
+
+      close();
+   }
+
+   bool open(SignalDevice::OpenMode mode)
+   {
+      if (deviceName.find("shm://") != 0)
+      {
+         log.warn("invalid device name [{}]", {deviceName});
+         return false;
+      }
+
+      if (mode != SignalDevice::Read)
+      {
+         log.warn("shared device only supports read mode");
+         return false;
+      }
+
+      close();
+
+      ring = std::make_shared<SharedRing>(deviceName.substr(6));
+
+      if (!ring->attach())
+      {
+         log.warn("unable to attach ring [{}]", {deviceName});
+         ring.reset();
+         return false;
+      }
+
+      const SharedRingHeader *header = ring->header();
+
+      channels = header->channels;
+      capacity = header->capacity;
+      sampleRate = header->sampleRate;
+      streamEnd = false;
+      writerSeen = std::chrono::steady_clock::now();
+      writerGone = false;
+
+      // start from newest samples, older ones may be overwritten soon
+      readIndex = header->head.load(std::memory_order_acquire);
+
+      return true;
+   }
+
+   void close()
+   {
+      stop();
+
+      if (ring)
+      {
+         ring->close();
+         ring.reset();
+      }
+   }
+
+   int start(RadioDevice::StreamHandler handler)
+   {
+      if (!ring)
+         return -1;
+
+      stop();
+
+      log.info("start streaming for device {}", {deviceName});
+
+      samplesReceived = 0;
+      samplesDropped = 0;
+      samplesStreamed = 0;
+      streamCallback = std::move(handler);
+      streamActive = true;
+
+      streamThread = std::thread([this] { streamLoop(); });
+
+      return 0;
+   }
+
+   int stop()
+   {
+      if (streamThread.joinable())
+      {
+         log.info("stop streaming for device {}", {deviceName});
+
+         streamActive = false;
+         streamThread.join();
+         streamCallback = nullptr;
+
+         return 0;
+      }
+
+      return -1;
+   }
+
+   /*
+    * Deliver ring samples to stream handler, each buffer is a validated copy of one contiguous span of ring slots
+    */
+   void streamLoop()
+   {
+      while (streamActive)
+      {
+         unsigned int length = available(transferSize);
+
+         if (!length)
+         {
+            if (streamEnd)
+               break;
+
+            std::this_thread::sleep_for(POLL_INTERVAL);
+
+            continue;
+         }
+
+         unsigned long long first = readIndex;
+
+         // writer never waits for readers, so consumers can not be handed ring memory that may be reused under them
+         SignalBuffer buffer(length * channels, channels, sampleRate);
+
+         buffer.put(slot(first), length * channels);
+
+         readIndex += length;
+
+         // copy is discarded if writer reached these samples while copying, next buffer offset shows the gap
+         if (overrun(first))
+         {
+            log.warn("ring overrun while copying {} samples at {}", {length, first});
+
+            samplesDropped += length;
+
+            continue;
+         }
+
+         buffer.flip();
+         buffer.setSampleOffset((long long) first);
+         buffer.setTimestamp(timestamp(first));
+
+         samplesReceived += length;
+         samplesStreamed += length;
+
+         if (streamCallback)
+            streamCallback(buffer);
+      }
+
+      streamActive = false;
+   }
+
+   /*
+    * Samples that can be read from readIndex up to ring end, skipping those lost by overrun, 0 if none or end of stream
+    */
+   unsigned int available(unsigned int limit)
+   {
+      const SharedRingHeader *header = ring->header();
+
+      bool closed = header->state.load(std::memory_order_acquire) == 0 || !writerAlive();
+
+      unsigned long long head = header->head.load(std::memory_order_acquire);
+
+      if (overrun(readIndex))
+      {
+         log.warn("ring overrun, {} samples lost", {head - readIndex});
+
+         samplesDropped += (long long) (head - readIndex);
+
+         readIndex = head;
+      }
+
+      // writer state is loaded first, so all its samples have been seen
+      if (head == readIndex)
+      {
+         streamEnd = closed;
+         return 0;
+      }
+
+      unsigned int offset = readIndex & (capacity - 1);
+
+      return (unsigned int) std::min<unsigned long long>({head - readIndex, limit, capacity - offset});
+   }
+
+   // false once writer process has exited without closing ring, checked at most once per liveness interval
+   bool writerAlive()
+   {
+      auto now = std::chrono::steady_clock::now();
+
+      if (writerGone || now - writerSeen < LIVENESS_INTERVAL)
+         return !writerGone;
+
+      if (!ring->isWriterAlive())
+      {
+         log.warn("writer process {} of ring [{}] is gone, ending stream", {ring->header()->writerId, deviceName});
+
+         writerGone = true;
+
+         return false;
+      }
+
+      writerSeen = now;
+
+      return true;
+   }
+
+   // true if samples from index have been, or may be being, overwritten by writer
+   bool overrun(unsigned long long index) const
+   {
+      const SharedRingHeader *header = ring->header();
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      unsigned long long head = header->head.load(std::memory_order_acquire);
+
+      return head + header->block.load(std::memory_order_relaxed) > index + capacity;
+   }
+
+   const float *slot(unsigned long long index) const
+   {
+      return ring->data() + size_t(index & (capacity - 1)) * channels;
+   }
+
+   long long timestamp(unsigned long long index) const
+   {
+      long long startTime = ring->header()->startTime;
+
+      if (startTime)
+         return startTime + (long long) (1E6 * double(index) / sampleRate);
+
+      return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+   }
+
+   bool isOpen() const
+   {
+      return ring != nullptr;
+   }
+
+   bool isEof() const
+   {
+      return streamEnd;
+   }
+
+   bool isReady() const
+   {
+      return ring && !streamEnd;
+   }
+
+   bool isStreaming() const
+   {
+      return streamActive;
+   }
+
+   /*
+    * Copy next contiguous span of samples to buffer, waits until writer publishes them
+    */
+   int read(SignalBuffer &buffer)
+   {
+      if (!ring || streamActive || buffer.stride() != channels)
+         return -1;
+
+      while (true)
+      {
+         unsigned int length = available(buffer.capacity() / channels);
+
+         if (!length)
+         {
+            if (streamEnd)
+               return -1;
+
+            std::this_thread::sleep_for(POLL_INTERVAL);
+
+            continue;
+         }
+
+         unsigned long long first = readIndex;
+
+         buffer.clear();
+         buffer.put(slot(first), length * channels);
+
+         readIndex += length;
+
+         // copy is discarded if writer reached these samples while copying
+         if (overrun(first))
+         {
+            samplesDropped += length;
+            continue;
+         }
+
+         buffer.flip();
+         buffer.setSampleOffset((long long) first);
+         buffer.setTimestamp(timestamp(first));
+
+         samplesReceived += length;
+
+         return buffer.limit();
+      }
+   }
+
+   std::map<int, std::string> supportedSampleRates() const
+   {
+      std::map<int, std::string> result;
+
+      if (sampleRate)
+         result[sampleRate] = std::to_string(sampleRate);
+
+      return result;
+   }
+
+   std::map<int, std::string> supportedGainModes() const
+   {
+      return {{0, "Fixed"}};
+   }
+
+   std::map<int, std::string> supportedGainValues() const
+   {
+      return {{0, "0 db"}};
+   }
+};
+
+SharedDevice::SharedDevice(const std::string &name) : impl(std::make_shared<Impl>(name))
+{
+}
+
+const std::string &SharedDevice::name()
+{
+   return impl->deviceName;
+}
+
+const std::string &SharedDevice::version()
+{
+   return impl->deviceVersion;
+}
+
+bool SharedDevice::open(SignalDevice::OpenMode mode)
+{
+   return impl->open(mode);
+}
+
+void SharedDevice::close()
+{
+   impl->close();
+}
+
+int SharedDevice::start(StreamHandler handler)
+{
+   return impl->start(handler);
+}
+
+int SharedDevice::stop()
+{
+   return impl->stop();
+}
+
+bool SharedDevice::isOpen() const
+{
+   return impl->isOpen();
+}
+
+bool SharedDevice::isEof() const
+{
+   return impl->isEof();
+}
+
+bool SharedDevice::isReady() const
+{
+   return impl->isReady();
+}
+
+bool SharedDevice::isStreaming() const
+{
+   return impl->isStreaming();
+}
+
+int SharedDevice::sampleSize() const
+{
+   return impl->sampleSize;
+}
+
+int SharedDevice::setSampleSize(int value)
+{
+   return value == impl->sampleSize ? 0 : -1;
+}
+
+long SharedDevice::sampleRate() const
+{
+   return impl->sampleRate;
+}
+
+int SharedDevice::setSampleRate(long value)
+{
+   // sample rate is given by writer
+   return value == impl->sampleRate ? 0 : -1;
+}
+
+int SharedDevice::sampleType() const
+{
+   return impl->sampleType;
+}
+
+int SharedDevice::setSampleType(int value)
+{
+   return value == RadioDevice::Float ? 0 : -1;
+}
+
+long SharedDevice::centerFreq() const
+{
+   return impl->centerFreq;
+}
+
+int SharedDevice::setCenterFreq(long value)
+{
+   impl->centerFreq = value;
+
+   return 0;
+}
+
+int SharedDevice::tunerAgc() const
+{
+   return impl->tunerAgc;
+}
+
+int SharedDevice::setTunerAgc(int value)
+{
+   impl->tunerAgc = value;
+
+   return 0;
+}
+
+int SharedDevice::mixerAgc() const
+{
+   return impl->mixerAgc;
+}
+
+int SharedDevice::setMixerAgc(int value)
+{
+   impl->mixerAgc = value;
+
+   return 0;
+}
+
+int SharedDevice::gainMode() const
+{
+   return impl->gainMode;
+}
+
+int SharedDevice::setGainMode(int value)
+{
+   impl->gainMode = value;
+
+   return 0;
+}
+
+int SharedDevice::gainValue() const
+{
+   return impl->gainValue;
+}
+
+int SharedDevice::setGainValue(int value)
+{
+   impl->gainValue = value;
+
+   return 0;
+}
+
+int SharedDevice::decimation() const
+{
+   return impl->decimation;
+}
+
+int SharedDevice::setDecimation(int value)
+{
+   impl->decimation = value;
+
+   return 0;
+}
+
+long long SharedDevice::samplesReceived()
+{
+   return impl->samplesReceived;
+}
+
+long long SharedDevice::samplesDropped()
+{
+   return impl->samplesDropped;
+}
+
+long SharedDevice::samplesStreamed()
+{
+   return impl->samplesStreamed;
+}
+
+std::map<int, std::string> SharedDevice::supportedSampleRates() const
+{
+   return impl->supportedSampleRates();
+}
+
+std::map<int, std::string> SharedDevice::supportedGainValues() const
+{
+   return impl->supportedGainValues();
+}
+
+std::map<int, std::string> SharedDevice::supportedGainModes() const
+{
+   return impl->supportedGainModes();
+}
+
+int SharedDevice::read(SignalBuffer &buffer)
+{
+   return impl->read(buffer);
+}
+
+int SharedDevice::write(SignalBuffer &buffer)
+{
+   return -1;
+}
+
+unsigned int SharedDevice::channelCount() const
+{
+   return impl->channels;
+}
+
+void SharedDevice::setTransferSize(unsigned int samples)
+{
+   impl->transferSize = samples;
+}
+
+}
\ No newline at end of file
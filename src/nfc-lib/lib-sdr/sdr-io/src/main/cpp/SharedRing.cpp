@@ -0,0 +1,432 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+#include <new>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <rt/Logger.h>
+
+#include <sdr/SignalBuffer.h>
+#include <sdr/SharedRing.h>
+
+namespace sdr {
+
+struct SharedRing::Impl
+{
+   rt::Logger log {"SharedRing"};
+
+   std::string name;
+
+   // mapped segment
+   void *segment = nullptr;
+   size_t segmentSize = 0;
+   bool writer = false;
+
+#ifdef _WIN32
+   HANDLE mapping = nullptr;
+#endif
+
+   SharedRingHeader *header = nullptr;
+   float *data = nullptr;
+
+   // writer copy of ring parameters
+   unsigned long long head = 0;
+   unsigned int capacity = 0;
+   unsigned int channels = 0;
+
+   explicit Impl(std::string name) : name(std::move(name))
+   {
+   }
+
+   ~Impl()
+   {
+      close();
+   }
+
+   bool create(unsigned int ringChannels, unsigned int sampleRate, unsigned int ringCapacity, long long startTime)
+   {
+      close();
+
+      if (!ringChannels || !ringCapacity)
+      {
+         log.warn("invalid ring size for [{}]", {name});
+         return false;
+      }
+
+      // power of two capacity, slot is obtained with a mask
+      unsigned int size = 1;
+
+      while (size < ringCapacity && size < 0x80000000)
+         size <<= 1;
+
+      unsigned int headerSize = (sizeof(SharedRingHeader) + 63) & ~63;
+
+      if (!map(headerSize + size_t(size) * ringChannels * sizeof(float), true))
+         return false;
+
+      header = new(segment) SharedRingHeader();
+      header->version = SharedRingHeader::Version;
+      header->headerSize = headerSize;
+      header->channels = ringChannels;
+      header->sampleRate = sampleRate;
+      header->capacity = size;
+      header->startTime = startTime;
+      header->writerId = processId();
+      header->head.store(0, std::memory_order_relaxed);
+      header->block.store(0, std::memory_order_relaxed);
+      header->state.store(1, std::memory_order_relaxed);
+
+      // readers only see a complete header
+      std::atomic_thread_fence(std::memory_order_release);
+
+      header->magic = SharedRingHeader::Magic;
+
+      data = reinterpret_cast<float *>(static_cast<char *>(segment) + headerSize);
+      head = 0;
+      capacity = size;
+      channels = ringChannels;
+      writer = true;
+
+      log.info("created ring [{}] with {} samples of {} channels at {} samples per second", {name, capacity, channels, sampleRate});
+
+      return true;
+   }
+
+   bool attach()
+   {
+      close();
+
+      if (!map(0, false))
+         return false;
+
+      header = static_cast<SharedRingHeader *>(segment);
+
+      if (segmentSize < sizeof(SharedRingHeader) || header->magic != SharedRingHeader::Magic || header->version != SharedRingHeader::Version)
+      {
+         log.warn("ring [{}] has invalid header", {name});
+         close();
+         return false;
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if (segmentSize < header->headerSize + size_t(header->capacity) * header->channels * sizeof(float))
+      {
+         log.warn("ring [{}] is truncated", {name});
+         close();
+         return false;
+      }
+
+      data = reinterpret_cast<float *>(static_cast<char *>(segment) + header->headerSize);
+      capacity = header->capacity;
+      channels = header->channels;
+
+      log.info("attached ring [{}] with {} samples of {} channels at {} samples per second", {name, capacity, channels, header->sampleRate});
+
+      return true;
+   }
+
+   void close()
+   {
+      if (!segment)
+         return;
+
+      // wake readers waiting for samples
+      if (writer)
+         header->state.store(0, std::memory_order_release);
+
+      unmap();
+
+      header = nullptr;
+      data = nullptr;
+      capacity = 0;
+      channels = 0;
+      writer = false;
+   }
+
+   float *reserve(unsigned int &samples)
+   {
+      if (!writer)
+      {
+         samples = 0;
+         return nullptr;
+      }
+
+      unsigned int offset = head & (capacity - 1);
+
+      samples = std::min(samples, capacity - offset);
+
+      // announce block before overwriting its samples
+      if (samples > header->block.load(std::memory_order_relaxed))
+         header->block.store(samples, std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      return data + size_t(offset) * channels;
+   }
+
+   void commit(unsigned int samples)
+   {
+      if (!writer)
+         return;
+
+      head += samples;
+
+      header->head.store(head, std::memory_order_release);
+   }
+
+   unsigned int write(const float *values, unsigned int samples)
+   {
+      unsigned int written = 0;
+
+      while (written < samples)
+      {
+         unsigned int length = samples - written;
+
+         float *target = reserve(length);
+
+         if (!target)
+            break;
+
+         std::memcpy(target, values + size_t(written) * channels, size_t(length) * channels * sizeof(float));
+
+         commit(length);
+
+         written += length;
+      }
+
+      return written;
+   }
+
+#ifdef _WIN32
+   static uint32_t processId()
+   {
+      return GetCurrentProcessId();
+   }
+
+   bool isWriterAlive() const
+   {
+      HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, header->writerId);
+
+      // process may exist but not be accessible, only a missing one is known to be gone
+      if (!process)
+         return GetLastError() != ERROR_INVALID_PARAMETER;
+
+      bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+
+      CloseHandle(process);
+
+      return running;
+   }
+
+   bool map(size_t size, bool create)
+   {
+      std::string path = "Local\\" + name;
+
+      if (create)
+         mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, DWORD(uint64_t(size) >> 32), DWORD(size), path.c_str());
+      else
+         mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, path.c_str());
+
+      if (!mapping)
+      {
+         log.warn("unable to open mapping [{}]: {}", {path, (unsigned long) GetLastError()});
+         return false;
+      }
+
+      if (!(segment = MapViewOfFile(mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size)))
+      {
+         log.warn("unable to map [{}]: {}", {path, (unsigned long) GetLastError()});
+         CloseHandle(mapping);
+         mapping = nullptr;
+         return false;
+      }
+
+      MEMORY_BASIC_INFORMATION info;
+
+      segmentSize = create ? size : (VirtualQuery(segment, &info, sizeof(info)) ? info.RegionSize : 0);
+
+      return true;
+   }
+
+   void unmap()
+   {
+      UnmapViewOfFile(segment);
+      CloseHandle(mapping);
+
+      mapping = nullptr;
+      segment = nullptr;
+      segmentSize = 0;
+   }
+#else
+   static uint32_t processId()
+   {
+      return getpid();
+   }
+
+   bool isWriterAlive() const
+   {
+      // signal 0 only checks process existence, EPERM means it runs under another user
+      return kill(pid_t(header->writerId), 0) == 0 || errno == EPERM;
+   }
+
+   bool map(size_t size, bool create)
+   {
+      std::string path = "/" + name;
+
+      // remove stale segment left by a writer that did not close
+      if (create)
+         shm_unlink(path.c_str());
+
+      int fd = create ? shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644) : shm_open(path.c_str(), O_RDONLY, 0);
+
+      if (fd < 0)
+      {
+         log.warn("unable to open segment [{}]: {}", {path, std::string(strerror(errno))});
+         return false;
+      }
+
+      struct stat info {};
+
+      if (create ? ftruncate(fd, off_t(size)) : fstat(fd, &info))
+      {
+         log.warn("unable to size segment [{}]: {}", {path, std::string(strerror(errno))});
+         ::close(fd);
+         return false;
+      }
+
+      if (!create)
+         size = info.st_size;
+
+      segment = mmap(nullptr, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+
+      ::close(fd);
+
+      if (segment == MAP_FAILED)
+      {
+         log.warn("unable to map segment [{}]: {}", {path, std::string(strerror(errno))});
+         segment = nullptr;
+         return false;
+      }
+
+      segmentSize = size;
+
+      return true;
+   }
+
+   void unmap()
+   {
+      munmap(segment, segmentSize);
+
+      // readers keep their mappings, name is free for next writer
+      if (writer)
+         shm_unlink(("/" + name).c_str());
+
+      segment = nullptr;
+      segmentSize = 0;
+   }
+#endif
+};
+
+SharedRing::SharedRing(const std::string &name) : impl(std::make_shared<Impl>(name))
+{
+}
+
+bool SharedRing::create(unsigned int channels, unsigned int sampleRate, unsigned int capacity, long long startTime)
+{
+   return impl->create(channels, sampleRate, capacity, startTime);
+}
+
+bool SharedRing::attach()
+{
+   return impl->attach();
+}
+
+void SharedRing::close()
+{
+   impl->close();
+}
+
+bool SharedRing::isOpen() const
+{
+   return impl->segment;
+}
+
+bool SharedRing::isWriterAlive() const
+{
+   return impl->header && (impl->writer || impl->isWriterAlive());
+}
+
+const std::string &SharedRing::name() const
+{
+   return impl->name;
+}
+
+const SharedRingHeader *SharedRing::header() const
+{
+   return impl->header;
+}
+
+const float *SharedRing::data() const
+{
+   return impl->data;
+}
+
+float *SharedRing::reserve(unsigned int &samples)
+{
+   return impl->reserve(samples);
+}
+
+void SharedRing::commit(unsigned int samples)
+{
+   impl->commit(samples);
+}
+
+unsigned int SharedRing::write(const float *values, unsigned int samples)
+{
+   return impl->write(values, samples);
+}
+
+unsigned int SharedRing::write(const SignalBuffer &buffer)
+{
+   // ring holds float values only, packed 16 bit IQ would be copied as raw bits
+   if (!impl->writer || buffer.sampleType() == SignalDevice::Integer || buffer.stride() != impl->channels)
+      return 0;
+
+   return impl->write(buffer.begin(), buffer.available() / impl->channels);
+}
+
+}
\ No newline at end of file
@@ -22,16 +22,31 @@
 
 */
 
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <sdr/SignalBuffer.h>
 
 namespace sdr {
 
+// alpha max plus beta min coefficients with lowest peak error
+#define ENVELOPE_ALPHA 0.960433870f
+#define ENVELOPE_BETA 0.397824735f
+
 struct SignalBuffer::Impl
 {
    long samplerate;
    long decimation;
+   int sampletype;
+   long long sampleoffset = -1;
+   long long timestamp = 0;
 
-   explicit Impl(long samplerate, long decimation) : samplerate(samplerate), decimation(decimation)
+   explicit Impl(long samplerate, long decimation, int sampletype = SignalDevice::Float) : samplerate(samplerate), decimation(decimation), sampletype(sampletype)
    {
    }
 };
@@ -48,10 +63,22 @@ SignalBuffer::SignalBuffer(float *data, unsigned int length, unsigned int stride
 {
 }
 
+SignalBuffer::SignalBuffer(float *data, unsigned int length, unsigned int stride, unsigned int samplerate, unsigned int decimation, int type, void *context, std::function<void(float *)> release) : Buffer<float>(data, length, type, stride, context, std::move(release)), impl(std::make_shared<Impl>(samplerate, decimation))
+{
+}
+
+SignalBuffer::SignalBuffer(short *data, unsigned int samples, unsigned int samplerate, void *context, std::function<void(float *)> release) : Buffer<float>(reinterpret_cast<float *>(data), samples, 0, 1, context, std::move(release)), impl(std::make_shared<Impl>(samplerate, 0, SignalDevice::Integer))
+{
+}
+
 SignalBuffer::SignalBuffer(const SignalBuffer &other) : Buffer(other), impl(other.impl)
 {
 }
 
+SignalBuffer::SignalBuffer(const rt::Buffer<float> &view, std::shared_ptr<Impl> impl) : Buffer(view), impl(std::move(impl))
+{
+}
+
 SignalBuffer &SignalBuffer::operator=(const SignalBuffer &other)
 {
    if (this == &other)
@@ -74,4 +101,318 @@ unsigned int SignalBuffer::sampleRate() const
    return impl->samplerate;
 }
 
+int SignalBuffer::sampleType() const
+{
+   return impl->sampletype;
+}
+
+bool SignalBuffer::isComplex() const
+{
+   return impl->sampletype == SignalDevice::Integer || stride() == 2;
+}
+
+long long SignalBuffer::sampleOffset() const
+{
+   return impl->sampleoffset;
+}
+
+void SignalBuffer::setSampleOffset(long long offset)
+{
+   impl->sampleoffset = offset;
+}
+
+long long SignalBuffer::timestamp() const
+{
+   return impl->timestamp;
+}
+
+void SignalBuffer::setTimestamp(long long timestamp)
+{
+   impl->timestamp = timestamp;
+}
+
+SignalBuffer SignalBuffer::slice(unsigned int offset, unsigned int length) const
+{
+   auto view = std::make_shared<Impl>(*impl);
+
+   // slice starts at its own stream position
+   if (view->sampleoffset >= 0)
+      view->sampleoffset += position() / (stride() ? stride() : 1) + offset;
+
+   return {Buffer::slice(offset * stride(), length * stride()), view};
+}
+
+/*
+ * Exact magnitude, float products in double precision to keep same result as scalar code
+ */
+static unsigned int envelopeExact(const float *data, float *output, unsigned int count)
+{
+   unsigned int i = 0;
+
+#if defined(__SSE2__)
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128 a = _mm_loadu_ps(data + i * 2 + 0);
+      __m128 b = _mm_loadu_ps(data + i * 2 + 4);
+
+      __m128d a0 = _mm_cvtps_pd(a);
+      __m128d a1 = _mm_cvtps_pd(_mm_movehl_ps(a, a));
+      __m128d b0 = _mm_cvtps_pd(b);
+      __m128d b1 = _mm_cvtps_pd(_mm_movehl_ps(b, b));
+
+      a0 = _mm_mul_pd(a0, a0);
+      a1 = _mm_mul_pd(a1, a1);
+      b0 = _mm_mul_pd(b0, b0);
+      b1 = _mm_mul_pd(b1, b1);
+
+      // add I and Q lanes of each sample
+      __m128d sa = _mm_add_pd(_mm_unpacklo_pd(a0, a1), _mm_unpackhi_pd(a0, a1));
+      __m128d sb = _mm_add_pd(_mm_unpacklo_pd(b0, b1), _mm_unpackhi_pd(b0, b1));
+
+      _mm_storeu_ps(output + i, _mm_sqrt_ps(_mm_movelh_ps(_mm_cvtpd_ps(sa), _mm_cvtpd_ps(sb))));
+   }
+#endif
+
+   for (; i < count; i++)
+   {
+      auto si = double(data[i * 2 + 0]);
+      auto sq = double(data[i * 2 + 1]);
+
+      output[i] = sqrtf(si * si + sq * sq);
+   }
+
+   return count;
+}
+
+/*
+ * Exact magnitude of 16 bit pairs, normalized to float range
+ */
+static unsigned int envelopeExact(const short *data, float *output, unsigned int count)
+{
+   unsigned int i = 0;
+   float scale = 1.0f / 32768;
+
+#if defined(__SSE2__)
+   __m128 k = _mm_set1_ps(scale);
+   __m128 wrap = _mm_set1_ps(4294967296.0f);
+
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i *) (data + i * 2));
+
+      // I * I + Q * Q for four pairs at once
+      __m128i p = _mm_madd_epi16(v, v);
+
+      // only -32768 pairs overflow signed range, convert as unsigned
+      __m128 f = _mm_cvtepi32_ps(p);
+      f = _mm_add_ps(f, _mm_and_ps(_mm_cmplt_ps(f, _mm_setzero_ps()), wrap));
+
+      _mm_storeu_ps(output + i, _mm_mul_ps(_mm_sqrt_ps(f), k));
+   }
+#endif
+
+   for (; i < count; i++)
+   {
+      int si = data[i * 2 + 0];
+      int sq = data[i * 2 + 1];
+
+      output[i] = sqrtf(float(unsigned(si * si) + unsigned(sq * sq))) * scale;
+   }
+
+   return count;
+}
+
+/*
+ * Alpha max plus beta min approximation, no square root, largest error 4%
+ */
+static unsigned int envelopeAlphaMaxBetaMin(const float *data, float *output, unsigned int count)
+{
+   unsigned int i = 0;
+
+#if defined(__SSE2__)
+   __m128 alpha = _mm_set1_ps(ENVELOPE_ALPHA);
+   __m128 beta = _mm_set1_ps(ENVELOPE_BETA);
+   __m128 sign = _mm_set1_ps(-0.0f);
+
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128 a = _mm_loadu_ps(data + i * 2 + 0);
+      __m128 b = _mm_loadu_ps(data + i * 2 + 4);
+
+      // split I and Q lanes and take absolute values
+      __m128 si = _mm_andnot_ps(sign, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      __m128 sq = _mm_andnot_ps(sign, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+      _mm_storeu_ps(output + i, _mm_add_ps(_mm_mul_ps(alpha, _mm_max_ps(si, sq)), _mm_mul_ps(beta, _mm_min_ps(si, sq))));
+   }
+#endif
+
+   for (; i < count; i++)
+   {
+      float si = std::fabs(data[i * 2 + 0]);
+      float sq = std::fabs(data[i * 2 + 1]);
+
+      output[i] = ENVELOPE_ALPHA * std::max(si, sq) + ENVELOPE_BETA * std::min(si, sq);
+   }
+
+   return count;
+}
+
+/*
+ * Alpha max plus beta min approximation of 16 bit pairs, normalized to float range
+ */
+static unsigned int envelopeAlphaMaxBetaMin(const short *data, float *output, unsigned int count)
+{
+   unsigned int i = 0;
+   float scale = 1.0f / 32768;
+
+#if defined(__SSE2__)
+   __m128 alpha = _mm_set1_ps(ENVELOPE_ALPHA * scale);
+   __m128 beta = _mm_set1_ps(ENVELOPE_BETA * scale);
+   __m128 sign = _mm_set1_ps(-0.0f);
+
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i *) (data + i * 2));
+
+      // sign extend I (low half) and Q (high half) of each pair
+      __m128 si = _mm_andnot_ps(sign, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(v, 16), 16)));
+      __m128 sq = _mm_andnot_ps(sign, _mm_cvtepi32_ps(_mm_srai_epi32(v, 16)));
+
+      _mm_storeu_ps(output + i, _mm_add_ps(_mm_mul_ps(alpha, _mm_max_ps(si, sq)), _mm_mul_ps(beta, _mm_min_ps(si, sq))));
+   }
+#endif
+
+   for (; i < count; i++)
+   {
+      auto si = float(std::abs(data[i * 2 + 0]));
+      auto sq = float(std::abs(data[i * 2 + 1]));
+
+      output[i] = (ENVELOPE_ALPHA * scale) * std::max(si, sq) + (ENVELOPE_BETA * scale) * std::min(si, sq);
+   }
+
+   return count;
+}
+
+/*
+ * Squared magnitude, signal power without square root
+ */
+static unsigned int envelopeSquared(const float *data, float *output, unsigned int count)
+{
+   unsigned int i = 0;
+
+#if defined(__SSE2__)
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128 a = _mm_loadu_ps(data + i * 2 + 0);
+      __m128 b = _mm_loadu_ps(data + i * 2 + 4);
+
+      __m128 si = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 sq = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+      _mm_storeu_ps(output + i, _mm_add_ps(_mm_mul_ps(si, si), _mm_mul_ps(sq, sq)));
+   }
+#endif
+
+   for (; i < count; i++)
+   {
+      float si = data[i * 2 + 0];
+      float sq = data[i * 2 + 1];
+
+      output[i] = si * si + sq * sq;
+   }
+
+   return count;
+}
+
+/*
+ * Squared magnitude of 16 bit pairs, normalized to float range
+ */
+static unsigned int envelopeSquared(const short *data, float *output, unsigned int count)
+{
+   unsigned int i = 0;
+   float scale = 1.0f / (32768.0f * 32768.0f);
+
+#if defined(__SSE2__)
+   __m128 k = _mm_set1_ps(scale);
+   __m128 wrap = _mm_set1_ps(4294967296.0f);
+
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i *) (data + i * 2));
+
+      __m128 f = _mm_cvtepi32_ps(_mm_madd_epi16(v, v));
+      f = _mm_add_ps(f, _mm_and_ps(_mm_cmplt_ps(f, _mm_setzero_ps()), wrap));
+
+      _mm_storeu_ps(output + i, _mm_mul_ps(f, k));
+   }
+#endif
+
+   for (; i < count; i++)
+   {
+      int si = data[i * 2 + 0];
+      int sq = data[i * 2 + 1];
+
+      output[i] = float(unsigned(si * si) + unsigned(sq * sq)) * scale;
+   }
+
+   return count;
+}
+
+/*
+ * Computes envelope of available samples into output using selected kernel, real valued samples are copied as is
+ * (or squared). Returns number of values
+ */
+unsigned int SignalBuffer::magnitude(float *output, int kernel) const
+{
+   // packed 16 bit I/Q pairs
+   if (impl->sampletype == SignalDevice::Integer)
+   {
+      auto data = reinterpret_cast<const short *>(this->data() + position());
+
+      switch (kernel)
+      {
+         case AlphaMaxBetaMin:
+            return envelopeAlphaMaxBetaMin(data, output, available());
+
+         case Squared:
+            return envelopeSquared(data, output, available());
+
+         default:
+            return envelopeExact(data, output, available());
+      }
+   }
+
+   auto data = this->data() + position();
+
+   // float I/Q pairs
+   if (stride() == 2)
+   {
+      switch (kernel)
+      {
+         case AlphaMaxBetaMin:
+            return envelopeAlphaMaxBetaMin(data, output, available() / 2);
+
+         case Squared:
+            return envelopeSquared(data, output, available() / 2);
+
+         default:
+            return envelopeExact(data, output, available() / 2);
+      }
+   }
+
+   // real samples are already an envelope
+   if (kernel == Squared)
+   {
+      for (unsigned int i = 0; i < available(); i++)
+         output[i] = data[i] * data[i];
+   }
+   else
+   {
+      std::copy(data, data + available(), output);
+   }
+
+   return available();
+}
+
 }
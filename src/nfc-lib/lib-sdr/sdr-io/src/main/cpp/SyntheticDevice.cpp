@@ -0,0 +1,1105 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include <rt/Logger.h>
+
+#include <sdr/SignalBuffer.h>
+#include <sdr/SyntheticDevice.h>
+
+// carrier frequency, all symbol timings are expressed in carrier periods (1/fc)
+#define SYNTHETIC_FC 13.56E6
+
+// IQ samples for each streamed buffer
+#define STREAM_BUFFER_SIZE 65536
+
+// idle carrier after last frame so decoders can complete it, in microseconds
+#define TRAILING_IDLE 1000
+
+namespace sdr {
+
+enum SyntheticTech
+{
+   TechNfcA = 0,
+   TechNfcB = 1,
+   TechNfcF = 2,
+   TechNfcV = 3
+};
+
+struct SyntheticFrame
+{
+   double delay; // idle carrier before frame, in microseconds
+   int tech; // frame technology
+   int rate; // bit rate in kbps
+   bool listen; // listen frame (load modulation) or poll frame (carrier modulation)
+   int bits; // short frame bits, 0 for full bytes
+   float depth; // poll modulation depth, negative for tech default
+   std::vector<unsigned char> data;
+};
+
+struct SyntheticDevice::Impl
+{
+   rt::Logger log {"SyntheticDevice"};
+
+   std::string deviceName;
+   std::string deviceVersion {"1.0"};
+   long centerFreq = 13.56E6;
+   long sampleRate = 10E6;
+   int sampleSize = 32;
+   int sampleType = RadioDevice::Float;
+   int gainMode = 0;
+   int gainValue = 0;
+   int tunerAgc = 0;
+   int mixerAgc = 0;
+   int decimation = 0;
+
+   // script frames and signal parameters
+   std::vector<SyntheticFrame> script;
+   float carrierLevel = 0.5f;
+   float noiseLevel = 0.002f;
+   float loadLevel = 0.05f;
+   float pollDepth[4] = {0.95f, 0.12f, 0.15f, 0.95f};
+   int repeatCount = 1;
+
+   // generator status
+   bool generatorOpen = false;
+   bool generatorEnd = false;
+   unsigned int scriptIndex = 0;
+   int scriptPass = 0;
+   long long idleSamples = 0;
+   std::vector<float> frameEnvelope;
+   unsigned int frameOffset = 0;
+   double frameClock = 0;
+   double sampleRatio = 0;
+   long framesGenerated = 0;
+
+   // stream index of next sample
+   long long sampleIndex = 0;
+
+   // fixed seed so runs are reproducible
+   std::mt19937 random {0x4e464331};
+   std::normal_distribution<float> gaussian {0.0f, 1.0f};
+
+   // streaming thread
+   std::thread streamThread;
+   std::atomic<bool> streamActive {false};
+   RadioDevice::StreamHandler streamCallback;
+   float streamSpeed = 0;
+   long long samplesReceived = 0;
+   long samplesStreamed = 0;
+
+   explicit Impl(std::string name) : deviceName(std::move(name))
+   {
+      log.debug("created SyntheticDevice for name [{}]", {this->deviceName});
+   }
+
+   ~Impl()
+   {
+      log.debug("destroy SyntheticDevice");
+
+      close();
+   }
+
+   bool open(SignalDevice::OpenMode mode)
+   {
+      if (deviceName.find("synthetic://") != 0)
+      {
+         log.warn("invalid device name [{}]", {deviceName});
+         return false;
+      }
+
+      if (mode != SignalDevice::Read)
+      {
+         log.warn("synthetic device only supports read mode");
+         return false;
+      }
+
+      close();
+
+      if (!loadScript(deviceName.substr(12)))
+         return false;
+
+      // initialize generator
+      scriptIndex = 0;
+      scriptPass = 0;
+      idleSamples = 0;
+      frameEnvelope.clear();
+      frameOffset = 0;
+      framesGenerated = 0;
+      sampleIndex = 0;
+      generatorEnd = false;
+      generatorOpen = true;
+
+      log.info("generating {} frames from [{}], {} passes", {(int) script.size(), deviceName, repeatCount});
+
+      return true;
+   }
+
+   void close()
+   {
+      stop();
+
+      generatorOpen = false;
+   }
+
+   int start(RadioDevice::StreamHandler handler)
+   {
+      if (!generatorOpen)
+         return -1;
+
+      stop();
+
+      log.info("start streaming for device {}", {deviceName});
+
+      samplesReceived = 0;
+      samplesStreamed = 0;
+      streamCallback = std::move(handler);
+      streamActive = true;
+
+      streamThread = std::thread([this] { streamLoop(); });
+
+      return 0;
+   }
+
+   int stop()
+   {
+      if (streamThread.joinable())
+      {
+         log.info("stop streaming for device {}", {deviceName});
+
+         streamActive = false;
+         streamThread.join();
+         streamCallback = nullptr;
+
+         return 0;
+      }
+
+      return -1;
+   }
+
+   /*
+    * Stream generated buffers, paced to sample rate if stream speed is set
+    */
+   void streamLoop()
+   {
+      auto streamStart = std::chrono::steady_clock::now();
+      long long streamFirst = sampleIndex;
+
+      while (streamActive)
+      {
+         SignalBuffer buffer(STREAM_BUFFER_SIZE * 2, 2, sampleRate);
+
+         if (!read(buffer))
+            break;
+
+         buffer.setTimestamp(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+         samplesReceived += buffer.elements();
+         samplesStreamed += buffer.elements();
+
+         if (streamCallback)
+            streamCallback(buffer);
+
+         if (streamSpeed > 0)
+            std::this_thread::sleep_until(streamStart + std::chrono::microseconds((long long) (1E6 * double(sampleIndex - streamFirst) / (sampleRate * streamSpeed))));
+      }
+
+      streamActive = false;
+   }
+
+   bool isOpen() const
+   {
+      return generatorOpen;
+   }
+
+   bool isEof() const
+   {
+      return generatorEnd && !idleSamples && frameOffset >= frameEnvelope.size();
+   }
+
+   bool isReady() const
+   {
+      return generatorOpen && !isEof();
+   }
+
+   bool isStreaming() const
+   {
+      return streamActive;
+   }
+
+   int read(SignalBuffer &buffer)
+   {
+      if (!generatorOpen)
+         return 0;
+
+      unsigned int count = buffer.available() / 2;
+
+      buffer.setSampleOffset(sampleIndex);
+
+      unsigned int generated = generate(buffer.pull(count * 2), count);
+
+      sampleIndex += generated;
+
+      // only generated samples are valid
+      buffer.rewind();
+      buffer.pull(generated * 2);
+      buffer.flip();
+
+      return buffer.limit();
+   }
+
+   int write(SignalBuffer &buffer)
+   {
+      return -1;
+   }
+
+   /*
+    * Generate IQ samples, carrier phase is constant so magnitude follows frame envelope
+    */
+   unsigned int generate(float *data, unsigned int count)
+   {
+      // constant carrier phase
+      const float phaseI = std::cos(0.3f);
+      const float phaseQ = std::sin(0.3f);
+
+      float noise = noiseLevel * carrierLevel;
+
+      unsigned int generated = 0;
+
+      while (generated < count)
+      {
+         float value;
+
+         if (idleSamples > 0)
+         {
+            value = carrierLevel;
+            idleSamples--;
+         }
+         else if (frameOffset < frameEnvelope.size())
+         {
+            value = frameEnvelope[frameOffset++];
+         }
+         else if (!nextFrame())
+         {
+            break;
+         }
+         else
+         {
+            continue;
+         }
+
+         data[generated * 2 + 0] = value * phaseI + noise * gaussian(random);
+         data[generated * 2 + 1] = value * phaseQ + noise * gaussian(random);
+
+         generated++;
+      }
+
+      return generated;
+   }
+
+   /*
+    * Build envelope for next script frame
+    */
+   bool nextFrame()
+   {
+      if (generatorEnd)
+         return false;
+
+      if (scriptIndex == script.size())
+      {
+         scriptIndex = 0;
+
+         // end of script, keep carrier until last frame is decoded
+         if (++scriptPass == repeatCount)
+         {
+            idleSamples = std::llround(TRAILING_IDLE * 1E-6 * sampleRate);
+            frameEnvelope.clear();
+            frameOffset = 0;
+            generatorEnd = true;
+
+            return true;
+         }
+      }
+
+      const SyntheticFrame &frame = script[scriptIndex++];
+
+      idleSamples = std::llround(frame.delay * 1E-6 * sampleRate);
+
+      frameEnvelope.clear();
+      frameOffset = 0;
+      frameClock = 0;
+      sampleRatio = double(sampleRate) / SYNTHETIC_FC;
+
+      float depth = frame.depth < 0 ? pollDepth[frame.tech] : frame.depth;
+
+      switch (frame.tech)
+      {
+         case TechNfcA:
+            frame.listen ? listenNfcA(frame) : pollNfcA(frame, depth);
+            break;
+
+         case TechNfcB:
+            frame.listen ? listenNfcB(frame) : pollNfcB(frame, depth);
+            break;
+
+         case TechNfcF:
+            manchesterNfcF(frame, depth, frame.listen);
+            break;
+
+         case TechNfcV:
+            frame.listen ? listenNfcV(frame) : pollNfcV(frame, depth);
+            break;
+      }
+
+      log.debug("frame {} at sample {}, {} samples", {framesGenerated, sampleIndex + idleSamples, (int) frameEnvelope.size()});
+
+      framesGenerated++;
+
+      return true;
+   }
+
+   /*
+    * Constant envelope level during given carrier periods
+    */
+   inline void level(double periods, float value)
+   {
+      auto first = std::llround(frameClock * sampleRatio);
+      auto last = std::llround((frameClock + periods) * sampleRatio);
+
+      frameEnvelope.insert(frameEnvelope.end(), last - first, value);
+
+      frameClock += periods;
+   }
+
+   /*
+    * Load modulated subcarrier, phase is referenced to frame start so BPSK phase changes are kept
+    */
+   inline void subcarrier(double periods, double subcarrierPeriods, int phase)
+   {
+      auto first = std::llround(frameClock * sampleRatio);
+      auto last = std::llround((frameClock + periods) * sampleRatio);
+
+      for (long long n = first; n < last; n++)
+      {
+         int half = int(std::floor((double(n) + 0.5) / sampleRatio * 2 / subcarrierPeriods)) + phase;
+
+         frameEnvelope.push_back(carrierLevel * (1 + ((half & 1) ? -loadLevel : loadLevel)));
+      }
+
+      frameClock += periods;
+   }
+
+   /*
+    * NFC-A poll, modified miller code
+    */
+   void pollNfcA(const SyntheticFrame &frame, float depth)
+   {
+      double bit = 128 >> rateIndex(frame.rate);
+
+      // pause t1, 2.36 us at 106 kbps, higher rates use 3/8 of bit as seen on real PCD captures (0.9 us at 424 kbps)
+      double pause = rateIndex(frame.rate) ? bit * 3 / 8 : bit / 4;
+
+      // whole samples so all pauses have same width whatever their position in frame
+      pause = std::max(1.0, std::round(pause * sampleRatio)) / sampleRatio;
+
+      float high = carrierLevel;
+      float low = carrierLevel * (1 - depth);
+
+      // sequence X, pause after half bit
+      auto sequenceX = [&] {
+         level(bit / 2, high);
+         level(pause, low);
+         level(bit / 2 - pause, high);
+      };
+
+      // sequence Y, no modulation
+      auto sequenceY = [&] {
+         level(bit, high);
+      };
+
+      // sequence Z, pause at bit start
+      auto sequenceZ = [&] {
+         level(pause, low);
+         level(bit - pause, high);
+      };
+
+      int previous = 0;
+
+      // start of frame
+      sequenceZ();
+
+      for (int value: frameBits(frame, true))
+      {
+         if (value)
+            sequenceX();
+         else if (!previous)
+            sequenceZ();
+         else
+            sequenceY();
+
+         previous = value;
+      }
+
+      // end of frame, logic 0 followed by sequence Y
+      previous ? sequenceY() : sequenceZ();
+      sequenceY();
+   }
+
+   /*
+    * NFC-A listen, manchester code with fc/16 subcarrier
+    */
+   void listenNfcA(const SyntheticFrame &frame)
+   {
+      // start of frame, sequence D
+      subcarrier(64, 16, 0);
+      level(64, carrierLevel);
+
+      for (int value: frameBits(frame, true))
+      {
+         if (value)
+         {
+            subcarrier(64, 16, 0);
+            level(64, carrierLevel);
+         }
+         else
+         {
+            level(64, carrierLevel);
+            subcarrier(64, 16, 0);
+         }
+      }
+
+      // end of frame, sequence F
+      level(128, carrierLevel);
+   }
+
+   /*
+    * NFC-B poll, NRZ-L code with start / stop bits
+    */
+   void pollNfcB(const SyntheticFrame &frame, float depth)
+   {
+      double etu = 128 >> rateIndex(frame.rate);
+
+      float high = carrierLevel;
+      float low = carrierLevel * (1 - depth);
+
+      // start of frame
+      level(10 * etu, low);
+      level(2 * etu, high);
+
+      for (unsigned char value: frame.data)
+      {
+         level(etu, low);
+
+         for (int i = 0; i < 8; i++)
+            level(etu, (value >> i) & 1 ? high : low);
+
+         level(etu, high);
+      }
+
+      // end of frame
+      level(10 * etu, low);
+   }
+
+   /*
+    * NFC-B listen, BPSK modulated fc/16 subcarrier, logic 1 keeps phase of TR1 reference
+    */
+   void listenNfcB(const SyntheticFrame &frame)
+   {
+      double etu = 128 >> rateIndex(frame.rate);
+
+      // TR1 phase reference, decoder needs at least 10 etu of stable phase
+      subcarrier(2048, 16, 0);
+
+      // start of frame
+      subcarrier(10 * etu, 16, 1);
+      subcarrier(2 * etu, 16, 0);
+
+      for (unsigned char value: frame.data)
+      {
+         subcarrier(etu, 16, 1);
+
+         for (int i = 0; i < 8; i++)
+            subcarrier(etu, 16, (value >> i) & 1 ? 0 : 1);
+
+         subcarrier(etu, 16, 0);
+      }
+
+      // end of frame
+      subcarrier(10 * etu, 16, 1);
+   }
+
+   /*
+    * NFC-F manchester code, preamble and SYNC code followed by frame bytes MSB first, listen frames have inverted polarity
+    */
+   void manchesterNfcF(const SyntheticFrame &frame, float depth, bool inverted)
+   {
+      double half = 32 >> (rateIndex(frame.rate) - 1);
+
+      float high = carrierLevel;
+      float low = carrierLevel * (1 - depth);
+
+      auto bit = [&](int value) {
+         level(half, value ^ inverted ? low : high);
+         level(half, value ^ inverted ? high : low);
+      };
+
+      // preamble
+      for (int i = 0; i < 48; i++)
+         bit(0);
+
+      // SYNC code
+      for (int i = 15; i >= 0; i--)
+         bit((0xB24D >> i) & 1);
+
+      for (unsigned char value: frame.data)
+      {
+         for (int i = 7; i >= 0; i--)
+            bit((value >> i) & 1);
+      }
+   }
+
+   /*
+    * NFC-V poll, 1 of 4 (26 kbps) or 1 of 256 (1.65 kbps) pulse position code
+    */
+   void pollNfcV(const SyntheticFrame &frame, float depth)
+   {
+      bool code256 = frame.rate < 26;
+
+      float high = carrierLevel;
+      float low = carrierLevel * (1 - depth);
+
+      // start of frame
+      level(128, low);
+      level(code256 ? 768 : 512, high);
+      level(128, low);
+
+      if (!code256)
+         level(256, high);
+
+      for (unsigned char value: frame.data)
+      {
+         if (code256)
+         {
+            level(256 * value + 128, high);
+            level(128, low);
+            level(256 * (255 - value), high);
+         }
+         else
+         {
+            for (int i = 0; i < 8; i += 2)
+            {
+               int pair = (value >> i) & 3;
+
+               level(256 * pair + 128, high);
+               level(128, low);
+               level(256 * (3 - pair), high);
+            }
+         }
+      }
+
+      // end of frame
+      level(256, high);
+      level(128, low);
+      level(128, high);
+   }
+
+   /*
+    * NFC-V listen, manchester code with single fc/32 subcarrier (26 kbps high rate, 6 kbps low rate)
+    */
+   void listenNfcV(const SyntheticFrame &frame)
+   {
+      double unit = frame.rate < 26 ? 1024 : 256;
+
+      auto logic0 = [&] {
+         subcarrier(unit, 32, 0);
+         level(unit, carrierLevel);
+      };
+
+      auto logic1 = [&] {
+         level(unit, carrierLevel);
+         subcarrier(unit, 32, 0);
+      };
+
+      // start of frame
+      level(3 * unit, carrierLevel);
+      subcarrier(3 * unit, 32, 0);
+      logic1();
+
+      for (unsigned char value: frame.data)
+      {
+         for (int i = 0; i < 8; i++)
+            (value >> i) & 1 ? logic1() : logic0();
+      }
+
+      // end of frame
+      logic0();
+      subcarrier(3 * unit, 32, 0);
+      level(3 * unit, carrierLevel);
+   }
+
+   /*
+    * Frame bits LSB first, with odd parity after each byte if requested
+    */
+   static std::vector<int> frameBits(const SyntheticFrame &frame, bool parity)
+   {
+      std::vector<int> bits;
+
+      if (frame.bits)
+      {
+         for (int i = 0; i < frame.bits; i++)
+            bits.push_back((frame.data[0] >> i) & 1);
+
+         return bits;
+      }
+
+      for (unsigned char value: frame.data)
+      {
+         int ones = 0;
+
+         for (int i = 0; i < 8; i++)
+         {
+            bits.push_back((value >> i) & 1);
+            ones += (value >> i) & 1;
+         }
+
+         if (parity)
+            bits.push_back(!(ones & 1));
+      }
+
+      return bits;
+   }
+
+   static int rateIndex(int rate)
+   {
+      return rate >= 848 ? 3 : rate >= 424 ? 2 : rate >= 212 ? 1 : 0;
+   }
+
+   /*
+    * Append tech CRC to frame data
+    */
+   static void appendCrc(SyntheticFrame &frame)
+   {
+      // NFC-F, CRC-CCITT sent MSB first
+      if (frame.tech == TechNfcF)
+      {
+         unsigned short crc = 0;
+
+         for (unsigned char value: frame.data)
+         {
+            crc ^= value << 8;
+
+            for (int i = 0; i < 8; i++)
+               crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+         }
+
+         frame.data.push_back(crc >> 8);
+         frame.data.push_back(crc & 0xff);
+
+         return;
+      }
+
+      // NFC-A / B / V, ISO/IEC 13239 reflected CRC sent LSB first
+      unsigned short crc = frame.tech == TechNfcA ? 0x6363 : 0xFFFF;
+
+      for (unsigned char value: frame.data)
+      {
+         crc ^= value;
+
+         for (int i = 0; i < 8; i++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : (crc >> 1);
+      }
+
+      if (frame.tech != TechNfcA)
+         crc = ~crc;
+
+      frame.data.push_back(crc & 0xff);
+      frame.data.push_back(crc >> 8);
+   }
+
+   static int techIndex(const std::string &name)
+   {
+      if (name == "nfca")
+         return TechNfcA;
+
+      if (name == "nfcb")
+         return TechNfcB;
+
+      if (name == "nfcf")
+         return TechNfcF;
+
+      if (name == "nfcv")
+         return TechNfcV;
+
+      return -1;
+   }
+
+   /*
+    * Parse frame script
+    */
+   bool loadScript(const std::string &file)
+   {
+      std::ifstream input(file);
+
+      if (!input.is_open())
+      {
+         log.warn("unable to open script [{}]", {file});
+         return false;
+      }
+
+      script.clear();
+
+      std::string line;
+      int number = 0;
+
+      while (std::getline(input, line))
+      {
+         number++;
+
+         // remove comments
+         line = line.substr(0, line.find('#'));
+
+         std::istringstream tokens(line);
+         std::string first;
+
+         if (!(tokens >> first))
+            continue;
+
+         if (first == "carrier")
+            tokens >> carrierLevel;
+
+         else if (first == "noise")
+            tokens >> noiseLevel;
+
+         else if (first == "load")
+            tokens >> loadLevel;
+
+         else if (first == "repeat")
+            tokens >> repeatCount;
+
+         else if (first == "depth")
+         {
+            std::string tech;
+            float value;
+
+            if (tokens >> tech >> value && techIndex(tech) >= 0)
+               pollDepth[techIndex(tech)] = value;
+            else
+               log.warn("invalid depth directive at line {}", {number});
+         }
+
+         else
+         {
+            SyntheticFrame frame {std::strtod(first.c_str(), nullptr), 0, 0, false, 0, -1};
+
+            std::string tech, type, token;
+            bool crc = false;
+
+            if (!(tokens >> tech >> frame.rate >> type) || techIndex(tech) < 0 || (type != "poll" && type != "listen"))
+            {
+               log.warn("invalid frame at line {}", {number});
+               continue;
+            }
+
+            frame.tech = techIndex(tech);
+            frame.listen = type == "listen";
+
+            while (tokens >> token)
+            {
+               if (token == "crc")
+                  crc = true;
+
+               else if (token.rfind("bits=", 0) == 0)
+                  frame.bits = std::stoi(token.substr(5));
+
+               else if (token.rfind("depth=", 0) == 0)
+                  frame.depth = std::stof(token.substr(6));
+
+               else
+                  frame.data.push_back(std::stoi(token, nullptr, 16));
+            }
+
+            if (frame.data.empty())
+            {
+               log.warn("empty frame at line {}", {number});
+               continue;
+            }
+
+            if (crc)
+               appendCrc(frame);
+
+            script.push_back(frame);
+         }
+      }
+
+      if (script.empty())
+      {
+         log.warn("no frames found in script [{}]", {file});
+         return false;
+      }
+
+      return true;
+   }
+
+   std::map<int, std::string> supportedSampleRates() const
+   {
+      std::map<int, std::string> result;
+
+      result[10000000] = "10000000";
+      result[20000000] = "20000000";
+
+      return result;
+   }
+
+   std::map<int, std::string> supportedGainModes() const
+   {
+      return {{0, "Fixed"}};
+   }
+
+   std::map<int, std::string> supportedGainValues() const
+   {
+      return {{0, "0 db"}};
+   }
+};
+
+SyntheticDevice::SyntheticDevice(const std::string &name) : impl(std::make_shared<Impl>(name))
+{
+}
+
+const std::string &SyntheticDevice::name()
+{
+   return impl->deviceName;
+}
+
+const std::string &SyntheticDevice::version()
+{
+   return impl->deviceVersion;
+}
+
+bool SyntheticDevice::open(SignalDevice::OpenMode mode)
+{
+   return impl->open(mode);
+}
+
+void SyntheticDevice::close()
+{
+   impl->close();
+}
+
+int SyntheticDevice::start(StreamHandler handler)
+{
+   return impl->start(handler);
+}
+
+int SyntheticDevice::stop()
+{
+   return impl->stop();
+}
+
+bool SyntheticDevice::isOpen() const
+{
+   return impl->isOpen();
+}
+
+bool SyntheticDevice::isEof() const
+{
+   return impl->isEof();
+}
+
+bool SyntheticDevice::isReady() const
+{
+   return impl->isReady();
+}
+
+bool SyntheticDevice::isStreaming() const
+{
+   return impl->isStreaming();
+}
+
+int SyntheticDevice::sampleSize() const
+{
+   return impl->sampleSize;
+}
+
+int SyntheticDevice::setSampleSize(int value)
+{
+   return value == impl->sampleSize ? 0 : -1;
+}
+
+long SyntheticDevice::sampleRate() const
+{
+   return impl->sampleRate;
+}
+
+int SyntheticDevice::setSampleRate(long value)
+{
+   impl->sampleRate = value;
+
+   return 0;
+}
+
+int SyntheticDevice::sampleType() const
+{
+   return impl->sampleType;
+}
+
+int SyntheticDevice::setSampleType(int value)
+{
+   return value == RadioDevice::Float ? 0 : -1;
+}
+
+long SyntheticDevice::centerFreq() const
+{
+   return impl->centerFreq;
+}
+
+int SyntheticDevice::setCenterFreq(long value)
+{
+   impl->centerFreq = value;
+
+   return 0;
+}
+
+int SyntheticDevice::tunerAgc() const
+{
+   return impl->tunerAgc;
+}
+
+int SyntheticDevice::setTunerAgc(int value)
+{
+   impl->tunerAgc = value;
+
+   return 0;
+}
+
+int SyntheticDevice::mixerAgc() const
+{
+   return impl->mixerAgc;
+}
+
+int SyntheticDevice::setMixerAgc(int value)
+{
+   impl->mixerAgc = value;
+
+   return 0;
+}
+
+int SyntheticDevice::gainMode() const
+{
+   return impl->gainMode;
+}
+
+int SyntheticDevice::setGainMode(int value)
+{
+   impl->gainMode = value;
+
+   return 0;
+}
+
+int SyntheticDevice::gainValue() const
+{
+   return impl->gainValue;
+}
+
+int SyntheticDevice::setGainValue(int value)
+{
+   impl->gainValue = value;
+
+   return 0;
+}
+
+int SyntheticDevice::decimation() const
+{
+   return impl->decimation;
+}
+
+int SyntheticDevice::setDecimation(int value)
+{
+   impl->decimation = value;
+
+   return 0;
+}
+
+long long SyntheticDevice::samplesReceived()
+{
+   return impl->samplesReceived;
+}
+
+long long SyntheticDevice::samplesDropped()
+{
+   return 0;
+}
+
+long SyntheticDevice::samplesStreamed()
+{
+   return impl->samplesStreamed;
+}
+
+std::map<int, std::string> SyntheticDevice::supportedSampleRates() const
+{
+   return impl->supportedSampleRates();
+}
+
+std::map<int, std::string> SyntheticDevice::supportedGainValues() const
+{
+   return impl->supportedGainValues();
+}
+
+std::map<int, std::string> SyntheticDevice::supportedGainModes() const
+{
+   return impl->supportedGainModes();
+}
+
+int SyntheticDevice::read(SignalBuffer &buffer)
+{
+   return impl->read(buffer);
+}
+
+int SyntheticDevice::write(SignalBuffer &buffer)
+{
+   return impl->write(buffer);
+}
+
+void SyntheticDevice::setStreamSpeed(float speed)
+{
+   impl->streamSpeed = speed;
+}
+
+long SyntheticDevice::framesGenerated() const
+{
+   return impl->framesGenerated;
+}
+
+}
\ No newline at end of file
@@ -110,9 +110,9 @@ class AirspyDevice : public RadioDevice
 
       int setDecimation(int value) override;
 
-      long samplesReceived() override;
+      long long samplesReceived() override;
 
-      long samplesDropped() override;
+      long long samplesDropped() override;
 
       long samplesStreamed() override;
 
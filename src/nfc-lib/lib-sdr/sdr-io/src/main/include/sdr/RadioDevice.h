@@ -68,9 +68,9 @@ class RadioDevice : public SignalDevice
 
       virtual int setDecimation(int value) = 0;
 
-      virtual long samplesReceived() = 0;
+      virtual long long samplesReceived() = 0;
 
-      virtual long samplesDropped() = 0;
+      virtual long long samplesDropped() = 0;
 
       virtual long samplesStreamed() = 0;
 
@@ -95,9 +95,9 @@ class RealtekDevice : public RadioDevice
 
       int setGainValue(int value) override;
 
-      long samplesReceived() override;
+      long long samplesReceived() override;
 
-      long samplesDropped() override;
+      long long samplesDropped() override;
 
       long samplesStreamed() override;
 
@@ -56,9 +56,9 @@ class RecordDevice : public SignalDevice
 
       bool isStreaming() const override;
 
-      int sampleCount() const;
+      long long sampleCount() const;
 
-      int sampleOffset() const;
+      long long sampleOffset() const;
 
       int sampleSize() const override;
 
@@ -80,6 +80,9 @@ class RecordDevice : public SignalDevice
 
       int write(SignalBuffer &buffer) override;
 
+      // move read position to given sample index (per channel)
+      bool seek(long long sample);
+
    private:
 
       std::shared_ptr<Impl> impl;
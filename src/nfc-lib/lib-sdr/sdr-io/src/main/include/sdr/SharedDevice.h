@@ -0,0 +1,137 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#ifndef SDR_SHAREDDEVICE_H
+#define SDR_SHAREDDEVICE_H
+
+#include <functional>
+
+#include <sdr/RadioDevice.h>
+
+namespace sdr {
+
+/*
+ * Samples published by an external acquisition process in a shared memory ring, given by device name "shm://<ring>"
+ *
+ * Device is a reader of the ring described by SharedRingHeader, it never blocks the writer and several readers may
+ * tap the same ring. Streamed buffers are read only views of ring memory, valid only during stream handler call and
+ * copied when retained. Sample offsets are stream indexes of the writer so samples lost by overruns are seen as gaps.
+ */
+class SharedDevice : public RadioDevice
+{
+      struct Impl;
+
+   public:
+
+      explicit SharedDevice(const std::string &name);
+
+   public:
+
+      const std::string &name() override;
+
+      const std::string &version() override;
+
+      bool open(OpenMode mode) override;
+
+      void close() override;
+
+      int start(StreamHandler handler) override;
+
+      int stop() override;
+
+      bool isOpen() const override;
+
+      bool isEof() const override;
+
+      bool isReady() const override;
+
+      bool isStreaming() const override;
+
+      int sampleSize() const override;
+
+      int setSampleSize(int value) override;
+
+      long sampleRate() const override;
+
+      int setSampleRate(long value) override;
+
+      int sampleType() const override;
+
+      int setSampleType(int value) override;
+
+      long centerFreq() const override;
+
+      int setCenterFreq(long value) override;
+
+      int tunerAgc() const override;
+
+      int setTunerAgc(int value) override;
+
+      int mixerAgc() const override;
+
+      int setMixerAgc(int value) override;
+
+      int gainMode() const override;
+
+      int setGainMode(int value) override;
+
+      int gainValue() const override;
+
+      int setGainValue(int value) override;
+
+      int decimation() const override;
+
+      int setDecimation(int value) override;
+
+      long long samplesReceived() override;
+
+      long long samplesDropped() override;
+
+      long samplesStreamed() override;
+
+      std::map<int, std::string> supportedSampleRates() const override;
+
+      std::map<int, std::string> supportedGainValues() const override;
+
+      std::map<int, std::string> supportedGainModes() const override;
+
+      int read(SignalBuffer &buffer) override;
+
+      int write(SignalBuffer &buffer) override;
+
+      // interleaved values per sample published by writer, 2 for IQ
+      unsigned int channelCount() const;
+
+      // maximum samples per channel on each transfer (default 65536)
+      void setTransferSize(unsigned int samples);
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+#ifndef SDR_SHAREDRING_H
+#define SDR_SHAREDRING_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+namespace sdr {
+
+class SignalBuffer;
+
+/*
+ * Layout of shared sample ring, segment starts with this header followed by sample data at offset headerSize
+ *
+ * Sample data is a ring of capacity samples, each one with channels interleaved float values (I/Q for channels = 2).
+ * Sample with stream index n is stored at slot n % capacity. There is a single writer and any number of readers, the
+ * writer never waits for readers: it copies samples and then publishes the new head with release order, readers load
+ * head with acquire order and keep their own read index. A reader has been overrun when samples it is going to read,
+ * or has just read, may have been overwritten: head + block > index + capacity. A writer that exits without closing
+ * leaves state set, readers detect it by checking if process writerId is still running.
+ */
+struct SharedRingHeader
+{
+   static constexpr uint32_t Magic = 0x474e5253; // "SRNG"
+   static constexpr uint32_t Version = 2;
+
+   uint32_t magic; // set last by writer, readers must check before using any other field
+   uint32_t version; // layout version
+   uint32_t headerSize; // offset of sample data from segment start, multiple of 64
+   uint32_t channels; // float values per sample
+   uint32_t sampleRate; // samples per second
+   uint32_t capacity; // ring size in samples
+   int64_t startTime; // host time of sample 0 in microseconds since epoch, 0 if unknown
+   uint32_t writerId; // process id of writer
+
+   alignas(64) std::atomic<uint64_t> head; // stream index of next sample to be written
+   std::atomic<uint32_t> block; // largest block written at once, samples that may be in progress beyond head
+   std::atomic<uint32_t> state; // 1 while writer is streaming, 0 after it is closed
+
+   static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared ring requires lock free 64 bit atomics");
+};
+
+/*
+ * Sample ring in a named shared memory segment, used by external acquisition processes to feed decoders
+ *
+ * The writer creates the segment and publishes samples, readers attach to it by name. On POSIX systems segment is
+ * "/<name>" from shm_open, on windows a named file mapping "Local\<name>".
+ */
+class SharedRing
+{
+      struct Impl;
+
+   public:
+
+      explicit SharedRing(const std::string &name);
+
+      // create segment for writing, capacity is rounded up to a power of two
+      bool create(unsigned int channels, unsigned int sampleRate, unsigned int capacity, long long startTime = 0);
+
+      // map existing segment for reading
+      bool attach();
+
+      // unmap segment, writer marks stream as closed and removes segment name
+      void close();
+
+      bool isOpen() const;
+
+      // reader: false if writer process has exited, even if it did not close the ring
+      bool isWriterAlive() const;
+
+      const std::string &name() const;
+
+      const SharedRingHeader *header() const;
+
+      // sample data of slot 0
+      const float *data() const;
+
+      // writer: contiguous space for up to samples, adjusted to space left before ring end, must be followed by commit
+      float *reserve(unsigned int &samples);
+
+      // writer: publish samples previously stored in reserved space
+      void commit(unsigned int samples);
+
+      // writer: copy and publish interleaved samples, returns number of samples written
+      unsigned int write(const float *values, unsigned int samples);
+
+      // writer: copy and publish remaining float samples from buffer, channels must match, packed 16 bit buffers are rejected
+      unsigned int write(const SignalBuffer &buffer);
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -27,12 +27,22 @@
 
 #include <rt/Buffer.h>
 
+#include <sdr/SignalDevice.h>
+
 namespace sdr {
 
 class SignalBuffer : public rt::Buffer<float>
 {
       struct Impl;
 
+   public:
+
+      // envelope kernels for IQ samples, squared kernel returns signal power for level gating, not a linear envelope
+      enum EnvelopeKernel
+      {
+         Exact = 0, AlphaMaxBetaMin = 1, Squared = 2
+      };
+
    public:
 
       SignalBuffer();
@@ -41,6 +51,12 @@ class SignalBuffer : public rt::Buffer<float>
 
       SignalBuffer(float *data, unsigned int length, unsigned int stride = 1, unsigned int samplerate = 0, unsigned int decimation = 0, int type = 0, void *context = nullptr);
 
+      // borrowed samples, no copy until buffer is retained
+      SignalBuffer(float *data, unsigned int length, unsigned int stride, unsigned int samplerate, unsigned int decimation, int type, void *context, std::function<void(float *)> release);
+
+      // borrowed 16 bit IQ samples, each element packs one I/Q pair in a single float slot (stride 1)
+      SignalBuffer(short *data, unsigned int samples, unsigned int samplerate, void *context, std::function<void(float *)> release);
+
       SignalBuffer(const SignalBuffer &other);
 
       SignalBuffer &operator=(const SignalBuffer &other);
@@ -49,8 +65,29 @@ class SignalBuffer : public rt::Buffer<float>
 
       unsigned int sampleRate() const;
 
+      int sampleType() const;
+
+      bool isComplex() const;
+
+      // stream index of first sample, -1 if unknown
+      long long sampleOffset() const;
+
+      void setSampleOffset(long long offset);
+
+      // host capture time in microseconds since epoch, 0 if unknown
+      long long timestamp() const;
+
+      void setTimestamp(long long timestamp);
+
+      unsigned int magnitude(float *output, int kernel = Exact) const;
+
+      // view of samples [offset, offset + length) from current position, shares sample memory without copy
+      SignalBuffer slice(unsigned int offset, unsigned int length) const;
+
    private:
 
+      SignalBuffer(const rt::Buffer<float> &view, std::shared_ptr<Impl> impl);
+
       std::shared_ptr<Impl> impl;
 };
 
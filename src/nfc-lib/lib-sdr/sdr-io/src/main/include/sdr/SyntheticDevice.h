@@ -0,0 +1,149 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+
+#ifndef SDR_SYNTHETICDEVICE_H
+#define SDR_SYNTHETICDEVICE_H
+
+#include <vector>
+#include <functional>
+
+#include <sdr/RadioDevice.h>
+
+namespace sdr {
+
+/*
+ * Synthetic NFC signal generator, IQ stream is built from a script of frames given by device name "synthetic://<script>"
+ *
+ * Script directives, one per line:
+ *
+ *    carrier <level>          carrier amplitude (default 0.5)
+ *    noise <level>            gaussian noise deviation relative to carrier (default 0.002)
+ *    load <level>             listen load modulation relative to carrier (default 0.05)
+ *    depth <tech> <value>     poll modulation depth for nfca, nfcb, nfcf or nfcv
+ *    repeat <count>           number of script passes, 0 repeats forever (default 1)
+ *
+ * Frames, one per line:
+ *
+ *    <delay us> <tech> <rate> <poll|listen> <hex bytes...> [crc] [bits=<n>] [depth=<value>]
+ *
+ * delay is idle carrier time since previous frame end, rate is in kbps (NFC-V poll rate 26 selects 1 of 4 code and 1 selects
+ * 1 of 256 code), crc appends tech CRC and bits=<n> sends a short frame with n bits of the first byte (NFC-A only).
+ */
+class SyntheticDevice : public RadioDevice
+{
+      struct Impl;
+
+   public:
+
+      explicit SyntheticDevice(const std::string &name);
+
+   public:
+
+      const std::string &name() override;
+
+      const std::string &version() override;
+
+      bool open(OpenMode mode) override;
+
+      void close() override;
+
+      int start(StreamHandler handler) override;
+
+      int stop() override;
+
+      bool isOpen() const override;
+
+      bool isEof() const override;
+
+      bool isReady() const override;
+
+      bool isStreaming() const override;
+
+      int sampleSize() const override;
+
+      int setSampleSize(int value) override;
+
+      long sampleRate() const override;
+
+      int setSampleRate(long value) override;
+
+      int sampleType() const override;
+
+      int setSampleType(int value) override;
+
+      long centerFreq() const override;
+
+      int setCenterFreq(long value) override;
+
+      int tunerAgc() const override;
+
+      int setTunerAgc(int value) override;
+
+      int mixerAgc() const override;
+
+      int setMixerAgc(int value) override;
+
+      int gainMode() const override;
+
+      int setGainMode(int value) override;
+
+      int gainValue() const override;
+
+      int setGainValue(int value) override;
+
+      int decimation() const override;
+
+      int setDecimation(int value) override;
+
+      long long samplesReceived() override;
+
+      long long samplesDropped() override;
+
+      long samplesStreamed() override;
+
+      std::map<int, std::string> supportedSampleRates() const override;
+
+      std::map<int, std::string> supportedGainValues() const override;
+
+      std::map<int, std::string> supportedGainModes() const override;
+
+      int read(SignalBuffer &buffer) override;
+
+      int write(SignalBuffer &buffer) override;
+
+      // stream speed relative to sample rate, 0 streams as fast as consumers accept buffers
+      void setStreamSpeed(float speed);
+
+      // number of script frames generated
+      long framesGenerated() const;
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,160 @@
+/*
+
+  Copyright (c) 2021 Jose Vicente Campos Martinez - <josevcm@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <chrono>
+#include <vector>
+
+#include <sdr/SignalBuffer.h>
+#include <sdr/RecordDevice.h>
+
+/*
+ * Envelope kernel benchmark and accuracy check
+ *
+ * usage: sdr-io-envelope [recording]
+ *
+ * Real valued samples from recording (or a generated AM test signal) are turned into IQ with a rotating phase, then
+ * each kernel is timed over float and packed 16 bit buffers and compared against a double precision envelope. Exits
+ * with non-zero status if any kernel exceeds its error bound.
+ */
+
+struct Kernel
+{
+   const char *name;
+   int kernel;
+   double maximumError;
+};
+
+static const Kernel kernels[] = {
+      {"exact",           sdr::SignalBuffer::Exact,           1E-4},
+      {"alphaMaxBetaMin", sdr::SignalBuffer::AlphaMaxBetaMin, 0.045},
+      {"squared",         sdr::SignalBuffer::Squared,         1E-4},
+};
+
+static const int ROUNDS = 20;
+
+static bool loadRecording(const char *file, std::vector<float> &signal)
+{
+   sdr::RecordDevice device(file);
+
+   if (!device.open(sdr::SignalDevice::Read))
+      return false;
+
+   while (!device.isEof())
+   {
+      sdr::SignalBuffer buffer(65536 * device.channelCount(), device.channelCount(), device.sampleRate());
+
+      if (device.read(buffer) <= 0)
+         break;
+
+      // first channel only
+      for (unsigned int i = 0; i < buffer.limit(); i += buffer.stride())
+         signal.push_back(buffer[i]);
+   }
+
+   return !signal.empty();
+}
+
+static void generateSignal(std::vector<float> &signal)
+{
+   signal.resize(1 << 22);
+
+   // 13.56 MHz carrier envelope with 10% ASK subcarrier and slow fading
+   for (unsigned int i = 0; i < signal.size(); i++)
+      signal[i] = float(0.5 + 0.3 * std::sin(i * 1E-5)) * (1 - 0.1f * ((i / 16) & 1));
+}
+
+int main(int argc, char *argv[])
+{
+   std::vector<float> signal;
+
+   if (argc > 1 && !loadRecording(argv[1], signal))
+   {
+      fprintf(stderr, "unable to read recording %s\n", argv[1]);
+      return 2;
+   }
+
+   if (signal.empty())
+      generateSignal(signal);
+
+   unsigned int length = signal.size();
+
+   std::vector<float> floats(length * 2);
+   std::vector<short> shorts(length * 2);
+   std::vector<float> output(length);
+
+   // rotating phase so both I and Q carry the envelope
+   for (unsigned int i = 0; i < length; i++)
+   {
+      double phase = i * 1E-3;
+
+      floats[i * 2 + 0] = float(signal[i] * std::cos(phase));
+      floats[i * 2 + 1] = float(signal[i] * std::sin(phase));
+
+      shorts[i * 2 + 0] = (short) std::lrint(floats[i * 2 + 0] * 32767);
+      shorts[i * 2 + 1] = (short) std::lrint(floats[i * 2 + 1] * 32767);
+   }
+
+   bool passed = true;
+
+   printf("%u samples, %d rounds\n", length, ROUNDS);
+
+   for (int format = 0; format < 2; format++)
+   {
+      sdr::SignalBuffer buffer = format ? sdr::SignalBuffer(shorts.data(), length, 10000000, nullptr, nullptr) : sdr::SignalBuffer(floats.data(), length * 2, 2, 10000000, 0, 0, nullptr, nullptr);
+
+      for (const auto &entry: kernels)
+      {
+         auto start = std::chrono::steady_clock::now();
+
+         for (int r = 0; r < ROUNDS; r++)
+            buffer.magnitude(output.data(), entry.kernel);
+
+         double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+         // relative error against double precision envelope of same input
+         double maximum = 0;
+
+         for (unsigned int i = 0; i < length; i++)
+         {
+            double si = format ? shorts[i * 2 + 0] / 32768.0 : floats[i * 2 + 0];
+            double sq = format ? shorts[i * 2 + 1] / 32768.0 : floats[i * 2 + 1];
+            double reference = entry.kernel == sdr::SignalBuffer::Squared ? si * si + sq * sq : std::sqrt(si * si + sq * sq);
+
+            if (reference > 1E-2)
+               maximum = std::max(maximum, std::fabs(output[i] - reference) / reference);
+         }
+
+         bool valid = maximum <= entry.maximumError;
+
+         printf("%-5s %-16s %6.3f ns/sample, max error %.5f %s\n", format ? "int16" : "float", entry.name, elapsed / ROUNDS / length, maximum, valid ? "" : "FAILED");
+
+         passed = passed && valid;
+      }
+   }
+
+   return passed ? 0 : 1;
+}
\ No newline at end of file